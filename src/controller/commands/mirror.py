@@ -17,10 +17,16 @@ class SppMirror(object):
             'status': None,
             'exit': None,
             'component': ['start', 'stop'],
-            'port': ['add', 'del']}
+            'port': ['add', 'del'],
+            'filter': ['add', 'del'],
+            'snaplen': None}
 
     WORKER_TYPES = ['mirror']
 
+    FILTER_TYPES = ['mac', 'vlan', 'ether_type', 'ip', 'l4_port', 'bpf']
+
+    COPY_MODES = ['shallow', 'deep']
+
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         self.spp_ctl_cli = spp_ctl_cli
         self.sec_id = sec_id
@@ -70,6 +76,12 @@ class SppMirror(object):
         elif cmd == 'port':
             self._run_port(params)
 
+        elif cmd == 'filter':
+            self._run_filter(params)
+
+        elif cmd == 'snaplen':
+            self._run_snaplen(params)
+
         elif cmd == 'exit':
             self._run_exit()
 
@@ -89,6 +101,12 @@ class SppMirror(object):
             - core:1, "mr1" (type: mirror)
               - rx: ring:0
               - tx: [vhost:0, vhost:1]
+              - copy_mode: deep
+              - snaplen: 128
+              - filter: [vlan 100, l4_port 80]
+              - tx_stats:
+                - vhost:0: sent 1024, dropped 0
+                - vhost:1: sent 960, dropped 64
             - core:2, "mr2" (type: mirror)
               - rx:
               - tx:
@@ -123,6 +141,23 @@ class SppMirror(object):
 
                     print(msg % ('tx', ', '.join(tx_ports)))
 
+                    if 'copy_mode' in worker.keys():
+                        print('    - copy_mode: %s' % worker['copy_mode'])
+
+                    if worker.get('snaplen', 0) > 0:
+                        print('    - snaplen: %d' % worker['snaplen'])
+
+                    if len(worker.get('filter', [])) > 0:
+                        filters = ['%s %s' % (ft['type'], ft['value'])
+                                   for ft in worker['filter']]
+                        print('    - filter: [%s]' % ', '.join(filters))
+
+                    if len(worker.get('tx_stats', [])) > 0:
+                        print('    - tx_stats:')
+                        for st in worker['tx_stats']:
+                            print('      - %s: sent %d, dropped %d' % (
+                                  st['port'], st['sent'], st['dropped']))
+
             else:
                 # TODO(yasufum) should change 'unuse' to 'unused'
                 print("  - core:%d '' (type: unuse)" % worker['core'])
@@ -154,6 +189,12 @@ class SppMirror(object):
 
                     elif sub_tokens[0] == 'port':
                         completions = self._compl_port(sub_tokens)
+
+                    elif sub_tokens[0] == 'filter':
+                        completions = self._compl_filter(sub_tokens)
+
+                    elif sub_tokens[0] == 'snaplen':
+                        completions = self._compl_snaplen(sub_tokens)
             return completions
         except Exception as e:
             print(e)
@@ -217,6 +258,8 @@ class SppMirror(object):
         if params[0] == 'start':
             req_params = {'name': params[1], 'core': int(params[2]),
                           'type': params[3]}
+            if len(params) > 4:
+                req_params['copy_mode'] = params[4]
             res = self.spp_ctl_cli.post('mirrors/%d/components' % self.sec_id,
                                         req_params)
             if res is not None:
@@ -276,6 +319,41 @@ class SppMirror(object):
             else:
                 print('Error: unknown response.')
 
+    def _run_filter(self, params):
+        if len(params) != 4 or params[0] not in ['add', 'del']:
+            print('Error: Invalid filter command.')
+            return None
+
+        req_params = {'action': params[0], 'type': params[2],
+                      'value': params[3]}
+        res = self.spp_ctl_cli.put('mirrors/%d/components/%s/filters'
+                                   % (self.sec_id, params[1]), req_params)
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to %s filter" % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_snaplen(self, params):
+        if len(params) != 2 or not params[1].isdigit():
+            print('Error: Invalid snaplen command.')
+            return None
+
+        req_params = {'snaplen': int(params[1])}
+        res = self.spp_ctl_cli.put('mirrors/%d/components/%s'
+                                   % (self.sec_id, params[0]), req_params)
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to set snaplen of '%s'" % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
     def _run_exit(self):
         """Run `exit` command."""
 
@@ -290,7 +368,7 @@ class SppMirror(object):
                 print('Error: unknown response.')
 
     def _compl_component(self, sub_tokens):
-        if len(sub_tokens) < 6:
+        if len(sub_tokens) < 7:
             subsub_cmds = ['start', 'stop']
             res = []
             if len(sub_tokens) == 2:
@@ -317,6 +395,11 @@ class SppMirror(object):
                     for wk_type in self.WORKER_TYPES:
                         if wk_type.startswith(sub_tokens[4]):
                             res.append(wk_type)
+            elif len(sub_tokens) == 6:
+                if sub_tokens[1] == 'start':
+                    for mode in self.COPY_MODES:
+                        if mode.startswith(sub_tokens[5]):
+                            res.append(mode)
             return res
 
     def _compl_port(self, sub_tokens):
@@ -342,3 +425,38 @@ class SppMirror(object):
                         if kw.startswith(sub_tokens[4]):
                             res.append(kw)
             return res
+
+    def _compl_filter(self, sub_tokens):
+        if len(sub_tokens) < 6:
+            subsub_cmds = ['add', 'del']
+            res = []
+            if len(sub_tokens) == 2:
+                for kw in subsub_cmds:
+                    if kw.startswith(sub_tokens[1]):
+                        res.append(kw)
+            elif len(sub_tokens) == 3:
+                if sub_tokens[1] in subsub_cmds:
+                    for kw in self.worker_names:
+                        if kw.startswith(sub_tokens[2]):
+                            res.append(kw)
+            elif len(sub_tokens) == 4:
+                if sub_tokens[1] in subsub_cmds:
+                    for kw in self.FILTER_TYPES:
+                        if kw.startswith(sub_tokens[3]):
+                            res.append(kw)
+            elif len(sub_tokens) == 5:
+                if sub_tokens[1] in subsub_cmds:
+                    if 'VALUE'.startswith(sub_tokens[4]):
+                        res.append('VALUE')
+            return res
+
+    def _compl_snaplen(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in self.worker_names:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        elif len(sub_tokens) == 3:
+            if 'LEN'.startswith(sub_tokens[2]):
+                res.append('LEN')
+        return res
@@ -13,7 +13,13 @@ class SppPcap(object):
     """
 
     # All of commands and sub-commands used for validation and completion.
-    PCAP_CMDS = { 'status': None, 'start': None, 'stop': None, 'exit': None}
+    PCAP_CMDS = { 'status': None, 'start': None, 'stop': None,
+            'dump': None, 'port': None, 'snaplen': None, 'codec': None,
+            'exit': None}
+
+    PORT_ACTIONS = ['add', 'del']
+
+    CODEC_TYPES = ['none', 'lz4', 'zstd']
 
     WORKER_TYPES = ['receive', 'write']
 
@@ -95,6 +101,70 @@ class SppPcap(object):
                 else:
                     print('Error: unknown response.')
 
+        elif cmd == 'dump':
+            req_params = {'action': 'dump'}
+            res = self.spp_ctl_cli.put('pcaps/%d/capture'
+                                       % (self.sec_id), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Dump flight recorder.")
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+        elif cmd == 'port':
+            if len(params) != 2 or params[0] not in self.PORT_ACTIONS:
+                print('Invalid syntax "{}".'.format(cmdline))
+                return
+            req_params = {'action': params[0], 'port': params[1]}
+            res = self.spp_ctl_cli.put('pcaps/%d/ports'
+                                       % (self.sec_id), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("{} capture port {}.".format(
+                        'Add' if params[0] == 'add' else 'Delete',
+                        params[1]))
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+        elif cmd == 'snaplen':
+            if len(params) != 1 or not params[0].isdigit():
+                print('Invalid syntax "{}".'.format(cmdline))
+                return
+            req_params = {'snaplen': int(params[0])}
+            res = self.spp_ctl_cli.put('pcaps/%d/snaplen'
+                                       % (self.sec_id), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Set snaplen {}.".format(params[0]))
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+        elif cmd == 'codec':
+            if (len(params) != 1 or
+                    params[0].split(':')[0] not in self.CODEC_TYPES):
+                print('Invalid syntax "{}".'.format(cmdline))
+                return
+            req_params = {'codec': params[0]}
+            res = self.spp_ctl_cli.put('pcaps/%d/codec'
+                                       % (self.sec_id), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Set codec {}.".format(params[0]))
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
         elif cmd == 'exit':
             res = self.spp_ctl_cli.delete('pcaps/%d' % (self.sec_id))
             if res is not None:
@@ -117,6 +187,8 @@ class SppPcap(object):
           spp > pcap 1; status
             - client-id: 3
             - satus: running
+            - snaplen: 65535
+            - codec: lz4:0
             - core:2, receive
               - rx: phy:0
             - core:3, write
@@ -132,6 +204,10 @@ class SppPcap(object):
         # client id and status
         print('  - client-id: {}'.format(json_obj['client-id']))
         print('  - status: {}'.format(json_obj['status']))
+        if 'snaplen' in json_obj.keys():
+            print('  - snaplen: {}'.format(json_obj['snaplen']))
+        if 'codec' in json_obj.keys():
+            print('  - codec: {}'.format(json_obj['codec']))
 
         # Core
         for worker in json_obj['core']:
@@ -140,11 +216,38 @@ class SppPcap(object):
                         core_id=worker['core'], role=worker['role']))
 
                 if worker['role'] == 'receive':
-                    pt = worker['rx_port'][0]['port']
+                    pt = ', '.join([p['port'] for p in worker['rx_port']])
                     msg = '    - {direction}: {res_id}'
                     print(msg.format(direction='rx', res_id=pt))
+                    if 'filter' in worker.keys():
+                        ft = worker['filter']
+                        print(('    - filter: \'{}\', pass {}, '
+                               'drop {}').format(
+                                   ft['expression'], ft['pass'],
+                                   ft['drop']))
                 else:
                     print('    - filename: {}'.format(worker['filename']))
+                    if 'write_stats' in worker.keys():
+                        ws = worker['write_stats']
+                        print(('    - write: {} blocks, latency avg {} '
+                               'max {} us, queue depth {} max {}, '
+                               'stalls {}').format(
+                                   ws['writes'], ws['latency_avg_us'],
+                                   ws['latency_max_us'], ws['queue_depth'],
+                                   ws['queue_depth_max'], ws['stalls']))
+                    if 'compress_stats' in worker.keys():
+                        cs = worker['compress_stats']
+                        print(('    - compress: {}, {} -> {} bytes '
+                               '({}%), {} bytes/kcycle').format(
+                                   cs['codec'], cs['in_bytes'],
+                                   cs['out_bytes'], cs['ratio_percent'],
+                                   cs['bytes_per_kcycle']))
+                    if 'recorder' in worker.keys():
+                        rc = worker['recorder']
+                        print(('    - recorder: {} packets, {}/{} bytes, '
+                               '{} dumps').format(
+                                   rc['packets'], rc['used'], rc['size'],
+                                   rc['dumps']))
 
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_pcap commands.
@@ -177,6 +280,23 @@ class SppPcap(object):
                         if len(sub_tokens) < 2:
                             if 'stop'.startswith(sub_tokens[1]):
                                 completions = ['stop']
+
+                    elif sub_tokens[0] == 'dump':
+                        if len(sub_tokens) < 2:
+                            if 'dump'.startswith(sub_tokens[1]):
+                                completions = ['dump']
+
+                    elif sub_tokens[0] == 'port':
+                        if len(sub_tokens) == 2:
+                            for act in self.PORT_ACTIONS:
+                                if act.startswith(sub_tokens[1]):
+                                    completions.append(act)
+
+                    elif sub_tokens[0] == 'codec':
+                        if len(sub_tokens) == 2:
+                            for codec in self.CODEC_TYPES:
+                                if codec.startswith(sub_tokens[1]):
+                                    completions.append(codec)
             return completions
         except Exception as e:
             print(e)
@@ -16,12 +16,31 @@ class SppVf(object):
     VF_CMDS = {
             'status': None,
             'exit': None,
-            'component': ['start', 'stop'],
+            'component': ['start', 'stop', 'move'],
             'port': ['add', 'del'],
             'classifier_table': ['add', 'del']}
 
     WORKER_TYPES = ['forward', 'merge', 'classifier_mac']
 
+    # Port abilities other than VLAN and its arguments.
+    PORT_ABILITIES = {
+            'add_qinq': ['id', 'pcp'],
+            'del_qinq': [],
+            'set_src_mac': ['mac'],
+            'set_dst_mac': ['mac'],
+            'dec_ttl': [],
+            'set_dscp': ['dscp'],
+            'police_srtcm': ['cir', 'cbs', 'ebs'],
+            'police_trtcm': ['cir', 'pir', 'cbs', 'pbs'],
+            'police_tb': ['unit', 'rate', 'burst'],
+            'sample': ['ring', 'mode', 'rate', 'snaplen']}
+
+    # Parameters of abilities given as string
+    ABILITY_STR_PARAMS = ['mac', 'unit', 'ring', 'mode']
+
+    # Counters of abilities shown in status
+    ABILITY_COUNTERS = ['conform', 'exceed', 'violate', 'sampled', 'dropped']
+
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         self.spp_ctl_cli = spp_ctl_cli
         self.sec_id = sec_id
@@ -138,6 +157,16 @@ class SppVf(object):
                         else:
                             msg = '    - %s: %s'
                             print(msg % (pt_dir, attr['port']))
+                        for ab in attr.get('ability', []):
+                            if ab['operation'] in self.PORT_ABILITIES:
+                                args = ['%s: %s' % (k, ab[k]) for k in
+                                        self.PORT_ABILITIES[
+                                            ab['operation']]]
+                                args += ['%s: %s' % (k, ab[k]) for k in
+                                         self.ABILITY_COUNTERS if k in ab]
+                                print('      - %s' % ', '.join(
+                                      ['operation: %s' % ab['operation']]
+                                      + args))
 
             else:
                 # TODO(yasufum) should change 'unuse' to 'unused'
@@ -158,7 +187,7 @@ class SppVf(object):
 
                 # VF_CMDS = {
                 #         'status': None,
-                #         'component': ['start', 'stop'],
+                #         'component': ['start', 'stop', 'move'],
                 #         'port': ['add', 'del'],
                 #         'classifier_table': ['add', 'del']}
 
@@ -278,9 +307,47 @@ class SppVf(object):
                 else:
                     print('Error: unknown response.')
 
+        elif params[0] == 'move':
+            req_params = {'core': int(params[2])}
+            res = self.spp_ctl_cli.put('vfs/%d/components/%s' % (
+                                       self.sec_id, params[1]), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to move component '%s' to core:%d"
+                          % (params[1], req_params['core']))
+
+                    # update workers and core IDs
+                    for wk in self.workers:
+                        if wk['name'] == params[1]:
+                            if req_params['core'] in self.unused_core_ids:
+                                self.unused_core_ids.remove(
+                                        req_params['core'])
+                            wk['core_id'] = req_params['core']
+                            break
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
     def _run_port(self, params):
         req_params = None
-        if len(params) == 4:
+        if len(params) > 4 and params[4] in self.PORT_ABILITIES.keys():
+            arg_names = self.PORT_ABILITIES[params[4]]
+            if params[0] != 'add' or len(params) != 5 + len(arg_names):
+                print('Error: Invalid syntax.')
+                return None
+
+            ability = {'operation': params[4]}
+            for name, val in zip(arg_names, params[5:]):
+                if name in self.ABILITY_STR_PARAMS:
+                    ability[name] = val
+                else:
+                    ability[name] = int(val)
+            req_params = {'action': 'attach', 'port': params[1],
+                          'dir': params[2], 'ability': ability}
+
+        elif len(params) == 4:
             if params[0] == 'add':
                 action = 'attach'
             elif params[0] == 'del':
@@ -371,7 +438,7 @@ class SppVf(object):
 
     def _compl_component(self, sub_tokens):
         if len(sub_tokens) < 6:
-            subsub_cmds = ['start', 'stop']
+            subsub_cmds = ['start', 'stop', 'move']
             res = []
             if len(sub_tokens) == 2:
                 for kw in subsub_cmds:
@@ -379,16 +446,16 @@ class SppVf(object):
                         res.append(kw)
             elif len(sub_tokens) == 3:
                 # 'start' takes any of names and no need
-                #  check, required only for 'stop'.
+                #  check, required only for 'stop' and 'move'.
                 if sub_tokens[1] == 'start':
                     if 'NAME'.startswith(sub_tokens[2]):
                         res.append('NAME')
-                if sub_tokens[1] == 'stop':
+                if sub_tokens[1] in ['stop', 'move']:
                     for kw in self.worker_names:
                         if kw.startswith(sub_tokens[2]):
                             res.append(kw)
             elif len(sub_tokens) == 4:
-                if sub_tokens[1] == 'start':
+                if sub_tokens[1] in ['start', 'move']:
                     for cid in [str(i) for i in self.unused_core_ids]:
                         if cid.startswith(sub_tokens[3]):
                             res.append(cid)
@@ -423,17 +490,47 @@ class SppVf(object):
                             res.append(kw)
             elif len(sub_tokens) == 6:
                 if sub_tokens[1] == 'add':
-                    for kw in ['add_vlantag', 'del_vlantag']:
+                    for kw in ['add_vlantag', 'del_vlantag'] + \
+                            sorted(self.PORT_ABILITIES.keys()):
                         if kw.startswith(sub_tokens[5]):
                             res.append(kw)
             elif len(sub_tokens) == 7:
-                if sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vlantag':
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vlantag', 'add_qinq']:
                     if 'VID'.startswith(sub_tokens[6]):
                         res.append('VID')
+                elif sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['set_src_mac', 'set_dst_mac']:
+                    if 'MAC_ADDR'.startswith(sub_tokens[6]):
+                        res.append('MAC_ADDR')
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'set_dscp':
+                    if 'DSCP'.startswith(sub_tokens[6]):
+                        res.append('DSCP')
             elif len(sub_tokens) == 8:
-                if sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vlantag':
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vlantag', 'add_qinq']:
                     if 'PCP'.startswith(sub_tokens[7]):
                         res.append('PCP')
+
+            # Parameters of abilities limiting rate or sampling
+            abilities = ['police_srtcm', 'police_trtcm', 'police_tb',
+                         'sample']
+            if len(sub_tokens) > 6 and sub_tokens[1] == 'add' and \
+                    sub_tokens[5] in abilities:
+                arg_names = self.PORT_ABILITIES[sub_tokens[5]]
+                if len(sub_tokens) - 7 < len(arg_names):
+                    name = arg_names[len(sub_tokens) - 7]
+                    if name == 'unit':
+                        candidates = ['pps', 'bps']
+                    elif name == 'mode':
+                        candidates = ['every', 'random']
+                    elif name == 'ring':
+                        candidates = ['ring:']
+                    else:
+                        candidates = [name.upper()]
+                    for kw in candidates:
+                        if kw.startswith(sub_tokens[-1]):
+                            res.append(kw)
             return res
 
     def _compl_cls_table(self, sub_tokens):
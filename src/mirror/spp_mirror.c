@@ -8,6 +8,12 @@
 
 #include <rte_common.h>
 #include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#ifdef RTE_LIBRTE_BPF
+#include <rte_errno.h>
+#include <rte_bpf.h>
+#endif /* RTE_LIBRTE_BPF */
 
 #include "shared/common.h"
 #include "shared/secondary/utils.h"
@@ -27,6 +33,9 @@
 #define MEMPOOL_CACHE_SIZE 256
 #define RTE_TEST_RX_DESC_DEFAULT 1024
 #define RTE_TEST_TX_DESC_DEFAULT 1024
+#define SPP_ETHER_TYPE_QINQ 0x88a8
+#define MIRROR_SNAP_BUF_MIN 64
+#define MIRROR_TX_BUF_SIZE (MAX_PKT_BURST * 4)
 
 /* A set of port info of rx and tx */
 struct mirror_rxtx {
@@ -34,6 +43,36 @@ struct mirror_rxtx {
 	struct spp_port_info tx; /* tx port */
 };
 
+/*
+ * Buffer of copies waiting for transmission to a mirror port. Copies are
+ * dropped instead of being queued if it is full, so that slow mirror port
+ * does not hold back the original path.
+ */
+struct mirror_tx_buffer {
+	uint16_t num_pkt;		/* number of buffered copies */
+	struct rte_mbuf *pkts[MIRROR_TX_BUF_SIZE];
+};
+
+/* Mirror filter with eBPF program loaded for it */
+struct mirror_filter {
+	struct spp_mirror_filter spec; /* filter given by command */
+#ifdef RTE_LIBRTE_BPF
+	struct rte_bpf *bpf;           /* loaded eBPF program */
+	struct rte_bpf_jit jit;        /* JIT compiled eBPF program */
+#endif /* RTE_LIBRTE_BPF */
+};
+
+/* Fields of packet referred by mirror filters */
+struct mirror_pkt_fields {
+	const struct ether_hdr *eth; /* Ethernet header */
+	int vid;                     /* VLAN ID of outermost tag, or -1 */
+	uint16_t ether_type;         /* EtherType inside tags (big endian) */
+	int family;                  /* AF_INET or AF_INET6, or 0 */
+	const uint8_t *src_ip;       /* source IP address */
+	const uint8_t *dst_ip;       /* destination IP address */
+	const uint16_t *l4_ports;    /* TCP/UDP/SCTP ports, or NULL */
+};
+
 /* Information on the path used for mirror. */
 struct mirror_path {
 	char name[SPP_NAME_STR_LEN];	/* component name	   */
@@ -43,6 +82,15 @@ struct mirror_path {
 	int num_tx;			/* number of mirror ports  */
 	struct mirror_rxtx ports[RTE_MAX_ETHPORTS];
 					/* port used for mirror	   */
+	int num_filter;			/* number of filters	   */
+	struct mirror_filter filter[SPP_MIRROR_FILTER_MAX];
+					/* filters of mirrored packets */
+	enum spp_mirror_copy_mode copy_mode;
+					/* copy mode of packets	   */
+	uint32_t snaplen;		/* length of mirrored packets */
+	struct rte_mempool *pool;	/* pool of mbufs for copies */
+	struct mirror_tx_buffer txbuf[SPP_MIRROR_DEST_MAX];
+					/* buffers of mirror ports */
 };
 
 /* Information for mirror. */
@@ -51,6 +99,8 @@ struct mirror_info {
 	volatile int upd_index; /* index to update area    */
 	struct mirror_path path[SPP_INFO_AREA_MAX];
 				/* Information of data path */
+	struct spp_mirror_tx_stats tx_stats[RTE_MAX_ETHPORTS];
+				/* Counters of tx ports    */
 };
 
 /*  */
@@ -84,9 +134,6 @@ static struct cancel_backup_info g_backup_info;
 /* mirror info */
 static struct mirror_info g_mirror_info[RTE_MAX_LCORE];
 
-/* mirror mbuf pool */
-static struct rte_mempool *g_mirror_pool;
-
 /* Print help message */
 static void
 usage(const char *progname)
@@ -230,41 +277,61 @@ parse_app_args(int argc, char *argv[])
 	return SPP_RET_OK;
 }
 
-/* mirror mbuf pool create */
-static int
-mirror_pool_create(int id)
+/* Get number of mbufs of mirror pool */
+static unsigned int
+mirror_pool_nb_mbufs(void)
 {
-	unsigned int nb_mbufs;
-	char pool_name[SPP_MIRROR_POOL_NAME_MAX];
-
-	nb_mbufs = RTE_MAX(
+	return RTE_MAX(
 	    (uint16_t)(nb_rxd + nb_txd + MAX_PKT_BURST + MEMPOOL_CACHE_SIZE),
 									8192U);
-	sprintf(pool_name, "%s_%d", SPP_MIRROR_POOL_NAME, id);
-	g_mirror_pool = rte_mempool_lookup(pool_name);
-	if (g_mirror_pool == NULL) {
-#ifdef SPP_MIRROR_SHALLOWCOPY
-		g_mirror_pool = rte_pktmbuf_pool_create(pool_name,
-						nb_mbufs,
-						MEMPOOL_CACHE_SIZE,
-						0,
-						RTE_PKTMBUF_HEADROOM,
-						rte_socket_id());
-#else
-		g_mirror_pool = rte_pktmbuf_pool_create(pool_name,
-						nb_mbufs,
-						MEMPOOL_CACHE_SIZE,
-						0,
-						RTE_MBUF_DEFAULT_BUF_SIZE,
-						rte_socket_id());
-#endif /* SPP_MIRROR_SHALLOWCOPY */
-	}
-	if (g_mirror_pool == NULL) {
-		RTE_LOG(ERR, MIRROR, "Cannot init mbuf pool\n");
-		return SPP_RET_NG;
-	}
+}
 
-	return SPP_RET_OK;
+/* Get mbuf pool of given kind, or create it at first. */
+static struct rte_mempool *
+mirror_pool_get(const char *kind, uint16_t data_room_size)
+{
+	char pool_name[SPP_MIRROR_POOL_NAME_MAX];
+	struct rte_mempool *pool = NULL;
+
+	snprintf(pool_name, sizeof(pool_name), "%s_%d_%s",
+			SPP_MIRROR_POOL_NAME, g_startup_param.client_id, kind);
+	pool = rte_mempool_lookup(pool_name);
+	if (pool != NULL)
+		return pool;
+
+	pool = rte_pktmbuf_pool_create(pool_name, mirror_pool_nb_mbufs(),
+			MEMPOOL_CACHE_SIZE, 0, data_room_size,
+			rte_socket_id());
+	if (pool == NULL)
+		RTE_LOG(ERR, MIRROR, "Cannot init mbuf pool. (pool = %s)\n",
+				pool_name);
+	return pool;
+}
+
+/**
+ * Select mbuf pool for copy mode and snaplen of component. Pools are
+ * created when they are used by any of components at first.
+ *
+ * Shallow copy uses mbufs without data room as indirect ones. Deep copy
+ * of truncated packets uses mbufs of data room for snaplen rounded up to
+ * power of 2 for sharing pools among components of similar snaplen.
+ */
+static struct rte_mempool *
+mirror_pool_select(enum spp_mirror_copy_mode copy_mode, uint32_t snaplen)
+{
+	uint32_t size = 0;
+	char kind[SPP_MIN_STR_LEN];
+
+	if (copy_mode == SPP_MIRROR_COPY_SHALLOW)
+		return mirror_pool_get("shallow", RTE_PKTMBUF_HEADROOM);
+
+	if (snaplen == 0)
+		return mirror_pool_get("deep", RTE_MBUF_DEFAULT_BUF_SIZE);
+
+	size = rte_align32pow2(RTE_MAX(snaplen,
+			(uint32_t)MIRROR_SNAP_BUF_MIN));
+	sprintf(kind, "s%u", size);
+	return mirror_pool_get(kind, RTE_PKTMBUF_HEADROOM + size);
 }
 
 /* Clear info */
@@ -279,6 +346,86 @@ mirror_proc_init(void)
 	}
 }
 
+/* Release eBPF programs of filters of mirror path. */
+static void
+mirror_filter_release(struct mirror_path *path)
+{
+#ifdef RTE_LIBRTE_BPF
+	int cnt;
+
+	for (cnt = 0; cnt < path->num_filter; cnt++) {
+		if (path->filter[cnt].bpf != NULL)
+			rte_bpf_destroy(path->filter[cnt].bpf);
+		path->filter[cnt].bpf = NULL;
+	}
+#endif /* RTE_LIBRTE_BPF */
+	path->num_filter = 0;
+}
+
+/**
+ * Setup mirror filter from the one given by command. eBPF program is
+ * loaded from `.text` section of ELF file and called with a pointer to
+ * mbuf as its argument, and packet is matched if it returns non-zero.
+ */
+static int
+mirror_filter_setup(struct mirror_filter *filter,
+		const struct spp_mirror_filter *spec)
+{
+#ifdef RTE_LIBRTE_BPF
+	struct rte_bpf_prm prm;
+#endif /* RTE_LIBRTE_BPF */
+
+	memcpy(&filter->spec, spec, sizeof(struct spp_mirror_filter));
+	if (spec->type != SPP_MIRROR_FILTER_BPF)
+		return SPP_RET_OK;
+
+#ifdef RTE_LIBRTE_BPF
+	memset(&prm, 0x00, sizeof(prm));
+	prm.prog_arg.type = RTE_BPF_ARG_PTR_MBUF;
+	prm.prog_arg.size = sizeof(struct rte_mbuf);
+	prm.prog_arg.buf_size = RTE_MBUF_DEFAULT_BUF_SIZE;
+
+	filter->bpf = rte_bpf_elf_load(&prm, spec->data.bpf_file, ".text");
+	if (unlikely(filter->bpf == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Cannot load BPF file. "
+				"(file = %s, errno = %d)\n",
+				spec->data.bpf_file, rte_errno);
+		return SPP_RET_NG;
+	}
+
+	/* Interpreter is used if JIT is not available. */
+	memset(&filter->jit, 0x00, sizeof(filter->jit));
+	rte_bpf_get_jit(filter->bpf, &filter->jit);
+	return SPP_RET_OK;
+#else
+	RTE_LOG(ERR, MIRROR, "BPF is not supported. (file = %s)\n",
+			spec->data.bpf_file);
+	return SPP_RET_NG;
+#endif /* RTE_LIBRTE_BPF */
+}
+
+/*
+ * Clear counters of tx port if it is newly added to the component.
+ * Counters of ports in the path referred by lcore are kept because
+ * they are still updated.
+ */
+static void
+mirror_tx_stats_init(struct mirror_info *info, int port_id)
+{
+	int cnt;
+	const struct mirror_path *ref = &info->path[info->ref_index];
+
+	if (unlikely(port_id < 0))
+		return;
+
+	for (cnt = 0; cnt < ref->num_tx; cnt++) {
+		if (ref->ports[cnt].tx.dpdk_port == port_id)
+			return;
+	}
+	memset(&info->tx_stats[port_id], 0x00,
+			sizeof(struct spp_mirror_tx_stats));
+}
+
 /* Update mirror info */
 int
 spp_mirror_update(struct spp_component_info *component)
@@ -297,14 +444,16 @@ spp_mirror_update(struct spp_component_info *component)
 		return SPP_RET_NG;
 	}
 
-	/* Component allows only tewo transmit port. */
-	if (unlikely(num_tx > 2)) {
+	/* Component allows original and limited number of mirror ports. */
+	if (unlikely(num_tx > SPP_MIRROR_DEST_MAX + 1)) {
 		RTE_LOG(ERR, MIRROR,
 			"Component[%d] Setting error. (type = %d, tx = %d)\n",
 			component->component_id, component->type, num_tx);
 		return SPP_RET_NG;
 	}
 
+	/* Area for update is not referred since previous update. */
+	mirror_filter_release(path);
 	memset(path, 0x00, sizeof(struct mirror_path));
 
 	RTE_LOG(INFO, MIRROR,
@@ -323,9 +472,30 @@ spp_mirror_update(struct spp_component_info *component)
 				sizeof(struct spp_port_info));
 
 	/* Transmit port is set according with larger num_rx / num_tx. */
-	for (cnt = 0; cnt < num_tx; cnt++)
+	for (cnt = 0; cnt < num_tx; cnt++) {
 		memcpy(&path->ports[cnt].tx, component->tx_ports[cnt],
 				sizeof(struct spp_port_info));
+		mirror_tx_stats_init(info, path->ports[cnt].tx.dpdk_port);
+	}
+
+	path->copy_mode = component->copy_mode;
+	path->snaplen = component->snaplen;
+	path->pool = mirror_pool_select(path->copy_mode, path->snaplen);
+	if (unlikely(path->pool == NULL))
+		return SPP_RET_NG;
+
+	for (cnt = 0; cnt < component->num_filter; cnt++) {
+		if (mirror_filter_setup(&path->filter[cnt],
+				&component->filter[cnt]) != SPP_RET_OK) {
+			RTE_LOG(ERR, MIRROR,
+				"Component[%d] Cannot setup filter. "
+				"(type = %d)\n", component->component_id,
+				component->filter[cnt].type);
+			mirror_filter_release(path);
+			return SPP_RET_NG;
+		}
+		path->num_filter++;
+	}
 
 	info->upd_index = info->ref_index;
 	while (likely(info->ref_index == info->upd_index))
@@ -341,129 +511,574 @@ spp_mirror_update(struct spp_component_info *component)
 	return SPP_RET_OK;
 }
 
+/*
+ * Release copies remained in buffers of mirror ports of the path, and
+ * count them as dropped.
+ */
+static void
+mirror_tx_buffer_release(struct mirror_info *info, struct mirror_path *path)
+{
+	int cnt;
+	int buf;
+	int port_id;
+	struct mirror_tx_buffer *txbuf = NULL;
+
+	for (cnt = 1; cnt < path->num_tx; cnt++) {
+		txbuf = &path->txbuf[cnt - 1];
+		if (likely(txbuf->num_pkt == 0))
+			continue;
+
+		for (buf = 0; buf < txbuf->num_pkt; buf++)
+			rte_pktmbuf_free(txbuf->pkts[buf]);
+
+		port_id = path->ports[cnt].tx.dpdk_port;
+		if (port_id >= 0)
+			info->tx_stats[port_id].dropped += txbuf->num_pkt;
+		txbuf->num_pkt = 0;
+	}
+}
+
+/*
+ * Release copies buffered for components which are not processed on the
+ * lcore anymore because they are stopped or moved to another lcore. All
+ * of components in `old` are released if `new` is NULL. It is called by
+ * the lcore owning the buffers before it switches to `new`.
+ */
+static void
+mirror_release_components(const struct core_info *old,
+		const struct core_info *new)
+{
+	int cnt;
+	int idx;
+	struct mirror_info *info = NULL;
+
+	for (cnt = 0; cnt < old->num; cnt++) {
+		for (idx = 0; new != NULL && idx < new->num; idx++) {
+			if (new->id[idx] == old->id[cnt])
+				break;
+		}
+		if (new != NULL && idx < new->num)
+			continue;
+
+		info = &g_mirror_info[old->id[cnt]];
+		mirror_tx_buffer_release(info, &info->path[info->ref_index]);
+	}
+}
+
 /* Change index of mirror info */
 static inline void
 change_mirror_index(int id)
 {
 	struct mirror_info *info = &g_mirror_info[id];
 	if (info->ref_index == info->upd_index) {
-	/* Change reference index of port ability. */
-		spp_port_ability_change_index(PORT_ABILITY_CHG_INDEX_REF, 0, 0);
+		/* Copies for previous path are not sent anymore. */
+		mirror_tx_buffer_release(info, &info->path[info->ref_index]);
 		info->ref_index = (info->upd_index+1)%SPP_INFO_AREA_MAX;
 	}
 }
 
+/*
+ * Make shallow copies of packets truncated to snaplen, and return the
+ * number of copies. Each copy is attached to the first segment of the
+ * packet and only its length is limited.
+ */
+static int
+mirror_attach_packets(const struct mirror_path *path,
+		struct rte_mbuf **pkts, struct rte_mbuf **copies, int nb_pkts)
+{
+	int cnt;
+	struct rte_mbuf *copy = NULL;
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(path->pool, copies,
+			nb_pkts) != 0)) {
+		RTE_LOG(DEBUG, MIRROR, "copy mbuf alloc NG!\n");
+		return 0;
+	}
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		copy = copies[cnt];
+		rte_pktmbuf_attach(copy, pkts[cnt]);
+		if (copy->data_len > path->snaplen)
+			copy->data_len = path->snaplen;
+		copy->pkt_len = copy->data_len;
+	}
+	return nb_pkts;
+}
+
+/*
+ * Make shallow copies of packets, and return the number of copies.
+ * Packets failed to be cloned are not mirrored.
+ */
+static int
+mirror_clone_packets(const struct mirror_path *path,
+		struct rte_mbuf **pkts, struct rte_mbuf **copies, int nb_pkts)
+{
+	int cnt;
+	int nb_copy = 0;
+
+	if (path->snaplen != 0)
+		return mirror_attach_packets(path, pkts, copies, nb_pkts);
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		copies[nb_copy] = rte_pktmbuf_clone(pkts[cnt], path->pool);
+		if (likely(copies[nb_copy] != NULL))
+			nb_copy++;
+	}
+	return nb_copy;
+}
+
+/* Copy data of a segment. */
+static inline void
+mirror_copy_segment(struct rte_mbuf *copy, const struct rte_mbuf *org)
+{
+	copy->data_off = org->data_off;
+	copy->data_len = org->data_len;
+	rte_memcpy(rte_pktmbuf_mtod(copy, char *),
+			rte_pktmbuf_mtod(org, char *), org->data_len);
+}
+
+/* Copy metadata of a packet to the first segment of its copy. */
+static inline void
+mirror_copy_metadata(struct rte_mbuf *copy, const struct rte_mbuf *org)
+{
+	copy->port = org->port;
+	copy->vlan_tci = org->vlan_tci;
+	copy->tx_offload = org->tx_offload;
+	copy->hash = org->hash;
+	copy->pkt_len = org->pkt_len;
+	copy->nb_segs = org->nb_segs;
+	copy->ol_flags = org->ol_flags;
+	copy->packet_type = org->packet_type;
+}
+
+/*
+ * Copy second and later segments of a packet. Mbufs for them are
+ * allocated one by one because multi-segment packets are rare.
+ */
+static int
+mirror_copy_chain(struct rte_mempool *pool, struct rte_mbuf *copy,
+		const struct rte_mbuf *org)
+{
+	struct rte_mbuf *seg = NULL;
+
+	for (org = org->next; org != NULL; org = org->next) {
+		seg = rte_pktmbuf_alloc(pool);
+		if (unlikely(seg == NULL))
+			return SPP_RET_NG;
+
+		mirror_copy_segment(seg, org);
+		copy->next = seg;
+		copy = seg;
+	}
+	return SPP_RET_OK;
+}
+
+/*
+ * Make deep copies of packets truncated to snaplen, and return the number
+ * of copies. First snaplen bytes of segments are gathered into an mbuf
+ * from the pool for snaplen.
+ */
+static int
+mirror_truncate_packets(const struct mirror_path *path,
+		struct rte_mbuf **pkts, struct rte_mbuf **copies, int nb_pkts)
+{
+	int cnt;
+	uint32_t len = 0;
+	uint32_t off = 0;
+	uint32_t seg_len = 0;
+	char *data = NULL;
+	const struct rte_mbuf *seg = NULL;
+	struct rte_mbuf *copy = NULL;
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(path->pool, copies,
+			nb_pkts) != 0)) {
+		RTE_LOG(DEBUG, MIRROR, "copy mbuf alloc NG!\n");
+		return 0;
+	}
+
+	for (cnt = 0; cnt < nb_pkts && cnt < 2; cnt++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt], void *));
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (cnt + 2 < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt + 2], void *));
+
+		copy = copies[cnt];
+		mirror_copy_metadata(copy, pkts[cnt]);
+		len = RTE_MIN(pkts[cnt]->pkt_len, path->snaplen);
+		copy->pkt_len = len;
+		copy->data_len = len;
+		copy->nb_segs = 1;
+
+		data = rte_pktmbuf_mtod(copy, char *);
+		for (seg = pkts[cnt], off = 0; seg != NULL && off < len;
+				seg = seg->next) {
+			seg_len = RTE_MIN((uint32_t)seg->data_len, len - off);
+			rte_memcpy(data + off, rte_pktmbuf_mtod(seg, char *),
+					seg_len);
+			off += seg_len;
+		}
+	}
+	return nb_pkts;
+}
+
+/*
+ * Make deep copies of packets, and return the number of copies.
+ *
+ * Mbufs of the first segments are allocated for whole burst at once,
+ * and data of the packet two ahead is prefetched while copying. Single
+ * segment packets are copied with a memcpy and fixed number of stores.
+ */
+static int
+mirror_copy_packets(const struct mirror_path *path,
+		struct rte_mbuf **pkts, struct rte_mbuf **copies, int nb_pkts)
+{
+	int cnt;
+	int nb_copy = 0;
+	struct rte_mbuf *org = NULL;
+	struct rte_mbuf *copy = NULL;
+
+	if (path->snaplen != 0)
+		return mirror_truncate_packets(path, pkts, copies, nb_pkts);
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(path->pool, copies,
+			nb_pkts) != 0)) {
+		RTE_LOG(DEBUG, MIRROR, "copy mbuf alloc NG!\n");
+		return 0;
+	}
+
+	for (cnt = 0; cnt < nb_pkts && cnt < 2; cnt++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt], void *));
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (cnt + 2 < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt + 2], void *));
+
+		org = pkts[cnt];
+		copy = copies[cnt];
+		mirror_copy_metadata(copy, org);
+		mirror_copy_segment(copy, org);
+		if (unlikely(org->next != NULL) &&
+				unlikely(mirror_copy_chain(path->pool, copy,
+						org) != SPP_RET_OK)) {
+			RTE_LOG(DEBUG, MIRROR, "copy mbuf alloc NG!\n");
+			rte_pktmbuf_free(copy);
+			continue;
+		}
+
+		copies[nb_copy++] = copy;
+	}
+	return nb_copy;
+}
+
+/* Get fields of packet referred by mirror filters. */
+static void
+mirror_parse_packet(struct rte_mbuf *pkt, struct mirror_pkt_fields *fields)
+{
+	const char *data = rte_pktmbuf_mtod(pkt, const char *);
+	uint32_t len = rte_pktmbuf_data_len(pkt);
+	uint32_t off = sizeof(struct ether_hdr);
+	const struct vlan_hdr *vlan = NULL;
+	const struct ipv4_hdr *ipv4 = NULL;
+	const struct ipv6_hdr *ipv6 = NULL;
+	uint8_t proto = 0;
+
+	memset(fields, 0x00, sizeof(struct mirror_pkt_fields));
+	fields->vid = -1;
+	if (unlikely(len < off))
+		return;
+
+	fields->eth = (const struct ether_hdr *)data;
+	fields->ether_type = fields->eth->ether_type;
+	if (pkt->ol_flags & PKT_RX_VLAN_STRIPPED)
+		fields->vid = pkt->vlan_tci & ETH_VLAN_ID_MAX;
+
+	while ((fields->ether_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN) ||
+			fields->ether_type ==
+			rte_cpu_to_be_16(SPP_ETHER_TYPE_QINQ)) &&
+			len >= off + sizeof(struct vlan_hdr)) {
+		vlan = (const struct vlan_hdr *)(data + off);
+		if (fields->vid < 0)
+			fields->vid = rte_be_to_cpu_16(vlan->vlan_tci) &
+					ETH_VLAN_ID_MAX;
+		fields->ether_type = vlan->eth_proto;
+		off += sizeof(struct vlan_hdr);
+	}
+
+	if (fields->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4) &&
+			len >= off + sizeof(struct ipv4_hdr)) {
+		ipv4 = (const struct ipv4_hdr *)(data + off);
+		fields->family = AF_INET;
+		fields->src_ip = (const uint8_t *)&ipv4->src_addr;
+		fields->dst_ip = (const uint8_t *)&ipv4->dst_addr;
+
+		/* Only the first fragment has L4 header. */
+		if (ipv4->fragment_offset &
+				rte_cpu_to_be_16(IPV4_HDR_OFFSET_MASK))
+			return;
+		proto = ipv4->next_proto_id;
+		off += (ipv4->version_ihl & IPV4_HDR_IHL_MASK) *
+				IPV4_IHL_MULTIPLIER;
+	} else if (fields->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6) &&
+			len >= off + sizeof(struct ipv6_hdr)) {
+		ipv6 = (const struct ipv6_hdr *)(data + off);
+		fields->family = AF_INET6;
+		fields->src_ip = ipv6->src_addr;
+		fields->dst_ip = ipv6->dst_addr;
+		proto = ipv6->proto;
+		off += sizeof(struct ipv6_hdr);
+	} else {
+		return;
+	}
+
+	/* Extension headers of IPv6 are not parsed. */
+	if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP ||
+			proto == IPPROTO_SCTP) &&
+			len >= off + sizeof(uint16_t) * 2)
+		fields->l4_ports = (const uint16_t *)(data + off);
+}
+
+/* Check if IP address is in the prefix. */
+static inline int
+mirror_match_prefix(const uint8_t *addr, const struct spp_ip_prefix_info *ip)
+{
+	int bytes = ip->prefix_len / 8;
+	int bits = ip->prefix_len % 8;
+
+	if (memcmp(addr, ip->addr, bytes) != 0)
+		return 0;
+	return bits == 0 ||
+		(addr[bytes] & (0xff << (8 - bits))) == ip->addr[bytes];
+}
+
+/* Check if packet matches the mirror filter. */
+static inline int
+mirror_match_filter(const struct mirror_filter *filter,
+		struct rte_mbuf *pkt __attribute__ ((unused)),
+		const struct mirror_pkt_fields *fields)
+{
+	const struct spp_mirror_filter *spec = &filter->spec;
+	uint16_t l4_port = 0;
+
+	switch (spec->type) {
+	case SPP_MIRROR_FILTER_MAC:
+		return fields->eth != NULL &&
+			(is_same_ether_addr(&fields->eth->d_addr,
+				(const struct ether_addr *)&spec->data.mac) ||
+			is_same_ether_addr(&fields->eth->s_addr,
+				(const struct ether_addr *)&spec->data.mac));
+	case SPP_MIRROR_FILTER_VLAN:
+		return fields->vid == spec->data.vid;
+	case SPP_MIRROR_FILTER_ETHER_TYPE:
+		return fields->eth != NULL && fields->ether_type ==
+			rte_cpu_to_be_16(spec->data.ether_type);
+	case SPP_MIRROR_FILTER_IP:
+		return fields->family == spec->data.ip.family &&
+			(mirror_match_prefix(fields->src_ip, &spec->data.ip) ||
+			mirror_match_prefix(fields->dst_ip, &spec->data.ip));
+	case SPP_MIRROR_FILTER_L4_PORT:
+		l4_port = rte_cpu_to_be_16(spec->data.l4_port);
+		return fields->l4_ports != NULL &&
+			(fields->l4_ports[0] == l4_port ||
+			fields->l4_ports[1] == l4_port);
+#ifdef RTE_LIBRTE_BPF
+	case SPP_MIRROR_FILTER_BPF:
+		if (filter->jit.func != NULL)
+			return filter->jit.func(pkt) != 0;
+		return rte_bpf_exec(filter->bpf, pkt) != 0;
+#endif /* RTE_LIBRTE_BPF */
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Select packets matching any of filters of mirror path, and return the
+ * number of selected packets.
+ */
+static int
+mirror_select_packets(const struct mirror_path *path,
+		struct rte_mbuf **pkts, struct rte_mbuf **selected,
+		int nb_pkts)
+{
+	int cnt;
+	int idx;
+	int nb_sel = 0;
+	struct mirror_pkt_fields fields;
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		mirror_parse_packet(pkts[cnt], &fields);
+		for (idx = 0; idx < path->num_filter; idx++) {
+			if (mirror_match_filter(&path->filter[idx],
+					pkts[cnt], &fields)) {
+				selected[nb_sel++] = pkts[cnt];
+				break;
+			}
+		}
+	}
+	return nb_sel;
+}
+
+/*
+ * Make copies of packets into the buffer of a mirror port. Packets which
+ * the buffer has no room for are not copied, and counted as dropped.
+ * Abilities of the port are applied to deep copies here, because they can
+ * be sent more than once, and copies failed in any of them are dropped.
+ */
+static void
+mirror_buffer_copies(const struct mirror_path *path,
+		const struct spp_port_info *tx,
+		struct mirror_tx_buffer *txbuf,
+		struct spp_mirror_tx_stats *stats,
+		struct rte_mbuf **pkts, int nb_pkts)
+{
+	int buf;
+	int nb_room = MIRROR_TX_BUF_SIZE - txbuf->num_pkt;
+	int nb_copy = 0;
+	int nb_ok = 0;
+	struct rte_mbuf **copies = &txbuf->pkts[txbuf->num_pkt];
+
+	if (unlikely(nb_pkts > nb_room)) {
+		stats->dropped += nb_pkts - nb_room;
+		nb_pkts = nb_room;
+	}
+	if (unlikely(nb_pkts == 0))
+		return;
+
+	if (path->copy_mode == SPP_MIRROR_COPY_SHALLOW) {
+		nb_copy = mirror_clone_packets(path, pkts, copies, nb_pkts);
+		stats->dropped += nb_pkts - nb_copy;
+		txbuf->num_pkt += nb_copy;
+		return;
+	}
+
+	nb_copy = mirror_copy_packets(path, pkts, copies, nb_pkts);
+	nb_ok = spp_eth_tx_prepare(tx->dpdk_port, copies, nb_copy);
+	for (buf = nb_ok; buf < nb_copy; buf++)
+		rte_pktmbuf_free(copies[buf]);
+	stats->dropped += nb_pkts - nb_ok;
+	txbuf->num_pkt += nb_ok;
+}
+
+/*
+ * Send copies in the buffer of a mirror port. Deep copies are already
+ * applied abilities of the port, and ones which the device cannot send
+ * are kept in the buffer for the next try. Shallow copies are applied
+ * abilities and sent here, and dropped if failed, because they share data
+ * with originals which are already sent and can be modified by the
+ * receiver.
+ */
+static void
+mirror_flush_copies(const struct mirror_path *path,
+		const struct spp_port_info *tx,
+		struct mirror_tx_buffer *txbuf,
+		struct spp_mirror_tx_stats *stats)
+{
+	int buf;
+	uint16_t nb_tx = 0;
+
+	if (txbuf->num_pkt == 0)
+		return;
+
+	if (path->copy_mode == SPP_MIRROR_COPY_SHALLOW)
+		nb_tx = spp_eth_tx_burst(tx->dpdk_port, 0, txbuf->pkts,
+				txbuf->num_pkt);
+	else
+		nb_tx = rte_eth_tx_burst(tx->dpdk_port, 0, txbuf->pkts,
+				txbuf->num_pkt);
+	stats->sent += nb_tx;
+	if (unlikely(nb_tx < txbuf->num_pkt) &&
+			path->copy_mode == SPP_MIRROR_COPY_SHALLOW) {
+		for (buf = nb_tx; buf < txbuf->num_pkt; buf++)
+			rte_pktmbuf_free(txbuf->pkts[buf]);
+		stats->dropped += txbuf->num_pkt - nb_tx;
+		txbuf->num_pkt = 0;
+		return;
+	}
+	if (unlikely(nb_tx < txbuf->num_pkt))
+		memmove(txbuf->pkts, &txbuf->pkts[nb_tx],
+				sizeof(struct rte_mbuf *) *
+				(txbuf->num_pkt - nb_tx));
+	txbuf->num_pkt -= nb_tx;
+}
+
 /**
  * Mirroring packets as mirror_proc
  *
  * Behavior of forwarding is defined as core_info->type which is given
  * as an argument of void and typecasted to spp_config_info.
+ *
+ * Original packets are sent before copies, and copies are sent via
+ * bounded buffers to give priority to the original path. Copies are made
+ * before sending originals because data of originals might be modified
+ * by the receiver after sent.
  */
 static int
 mirror_proc(int id)
 {
-	int cnt, buf;
+	int buf;
+	int cnt;
 	int nb_rx = 0;
+	int nb_sel = 0;
 	int nb_tx = 0;
-	int nb_tx1 = 0;
-	int nb_tx2 = 0;
 	struct mirror_info *info = &g_mirror_info[id];
 	struct mirror_path *path = NULL;
 	struct spp_port_info *rx = NULL;
 	struct spp_port_info *tx = NULL;
+	struct spp_mirror_tx_stats *stats = NULL;
 	struct rte_mbuf *bufs[MAX_PKT_BURST];
-	struct rte_mbuf *copybufs[MAX_PKT_BURST];
-	struct rte_mbuf *org_mbuf = NULL;
+	struct rte_mbuf *selbufs[MAX_PKT_BURST];
+	struct rte_mbuf **sel = bufs;
 
 	change_mirror_index(id);
 	path = &info->path[info->ref_index];
 
 	/* Practice condition check */
-	if (!(path->num_tx == 2 && path->num_rx == 1))
+	if (!(path->num_tx >= 2 && path->num_rx == 1))
 		return SPP_RET_OK;
 
 	rx = &path->ports[0].rx;
 	/* Receive packets */
 	nb_rx = spp_eth_rx_burst(rx->dpdk_port, 0, bufs, MAX_PKT_BURST);
-	if (unlikely(nb_rx == 0))
-		return SPP_RET_OK;
 
-	/* mirror */
-	tx = &path->ports[1].tx;
-	if (tx->dpdk_port >= 0) {
-		nb_tx2 = 0;
-		for (cnt = 0; cnt < nb_rx; cnt++) {
-			org_mbuf = bufs[cnt];
-			rte_prefetch0(rte_pktmbuf_mtod(org_mbuf, void *));
-#ifdef SPP_MIRROR_SHALLOWCOPY
-			/* Shallow Copy */
-			copybufs[cnt] = rte_pktmbuf_clone(org_mbuf,
-							g_mirror_pool);
-#else
-			struct rte_mbuf *mirror_mbuf = NULL;
-			struct rte_mbuf **mirror_mbufs = &mirror_mbuf;
-			struct rte_mbuf *copy_mbuf = NULL;
-			/* Deep Copy */
-			do {
-				copy_mbuf = rte_pktmbuf_alloc(g_mirror_pool);
-				if (unlikely(copy_mbuf == NULL)) {
-					rte_pktmbuf_free(mirror_mbuf);
-					mirror_mbuf = NULL;
-					RTE_LOG(INFO, MIRROR,
-						"copy mbuf alloc NG!\n");
-					break;
-				}
-
-				copy_mbuf->data_off = org_mbuf->data_off;
-				copy_mbuf->data_len = org_mbuf->data_len;
-				copy_mbuf->port = org_mbuf->port;
-				copy_mbuf->vlan_tci = org_mbuf->vlan_tci;
-				copy_mbuf->tx_offload = org_mbuf->tx_offload;
-				copy_mbuf->hash = org_mbuf->hash;
-
-				copy_mbuf->next = NULL;
-				copy_mbuf->pkt_len = org_mbuf->pkt_len;
-				copy_mbuf->nb_segs = org_mbuf->nb_segs;
-				copy_mbuf->ol_flags = org_mbuf->ol_flags;
-				copy_mbuf->packet_type = org_mbuf->packet_type;
-
-				rte_memcpy(rte_pktmbuf_mtod(copy_mbuf, char *),
-					rte_pktmbuf_mtod(org_mbuf, char *),
-					org_mbuf->data_len);
-
-				*mirror_mbufs = copy_mbuf;
-				mirror_mbufs = &copy_mbuf->next;
-			} while ((org_mbuf = org_mbuf->next) != NULL);
-			copybufs[cnt] = mirror_mbuf;
-
-#endif /* SPP_MIRROR_SHALLOWCOPY */
-		}
-		if (cnt != 0)
-			nb_tx2 = spp_eth_tx_burst(tx->dpdk_port, 0,
-							copybufs, cnt);
+	/* Only packets matching filters are mirrored if any. */
+	nb_sel = nb_rx;
+	if (nb_rx != 0 && path->num_filter > 0) {
+		nb_sel = mirror_select_packets(path, bufs, selbufs, nb_rx);
+		sel = selbufs;
+	}
+
+	/* mirror, copies are made for each of destinations */
+	for (cnt = 1; cnt < path->num_tx && nb_sel != 0; cnt++) {
+		tx = &path->ports[cnt].tx;
+		if (tx->dpdk_port < 0)
+			continue;
+		mirror_buffer_copies(path, tx, &path->txbuf[cnt - 1],
+				&info->tx_stats[tx->dpdk_port], sel, nb_sel);
 	}
 
 	/* orginal */
 	tx = &path->ports[0].tx;
-	if (tx->dpdk_port >= 0)
-		nb_tx1 = spp_eth_tx_burst(tx->dpdk_port, 0, bufs, nb_rx);
-	nb_tx = nb_tx1;
-
-	if (nb_tx1 != nb_tx2)
-		RTE_LOG(INFO, MIRROR,
-			"mirror paket drop nb_rx=%d nb_tx1=%d nb_tx2=%d\n",
-							nb_rx, nb_tx1, nb_tx2);
+	if (nb_rx != 0 && tx->dpdk_port >= 0) {
+		nb_tx = spp_eth_tx_burst(tx->dpdk_port, 0, bufs, nb_rx);
+		stats = &info->tx_stats[tx->dpdk_port];
+		stats->sent += nb_tx;
+		stats->dropped += nb_rx - nb_tx;
+	}
 
 	/* Discard remained packets to release mbuf */
-	if (nb_tx1 < nb_tx2)
-		nb_tx = nb_tx2;
 	if (unlikely(nb_tx < nb_rx)) {
 		for (buf = nb_tx; buf < nb_rx; buf++)
 			rte_pktmbuf_free(bufs[buf]);
 	}
-	if (unlikely(nb_tx2 < nb_rx)) {
-		for (buf = nb_tx2; buf < nb_rx; buf++)
-			rte_pktmbuf_free(copybufs[buf]);
+
+	/* Copies remained in buffers are also sent without new packets. */
+	for (cnt = 1; cnt < path->num_tx; cnt++) {
+		tx = &path->ports[cnt].tx;
+		if (tx->dpdk_port < 0)
+			continue;
+		mirror_flush_copies(path, tx, &path->txbuf[cnt - 1],
+				&info->tx_stats[tx->dpdk_port]);
 	}
 	return SPP_RET_OK;
 }
@@ -515,12 +1130,22 @@ spp_mirror_get_component_status(
 	return SPP_RET_OK;
 }
 
+/* Get counters of tx port of mirror component */
+void
+spp_mirror_get_tx_stats(int id, int port_id,
+		struct spp_mirror_tx_stats *stats)
+{
+	memcpy(stats, &g_mirror_info[id].tx_stats[port_id],
+			sizeof(struct spp_mirror_tx_stats));
+}
+
 /* Main process of slave core */
 static int
 slave_main(void *arg __attribute__ ((unused)))
 {
 	int ret = SPP_RET_OK;
 	int cnt = 0;
+	int next = 0;
 	unsigned int lcore_id = rte_lcore_id();
 	enum spp_core_status status = SPP_CORE_STOP;
 	struct core_mng_info *info = &g_core_info[lcore_id];
@@ -528,16 +1153,20 @@ slave_main(void *arg __attribute__ ((unused)))
 
 	RTE_LOG(INFO, MIRROR, "Core[%d] Start.\n", lcore_id);
 	set_core_status(lcore_id, SPP_CORE_IDLE);
+	spp_port_ability_register_lcore(lcore_id);
 
 	while ((status = spp_get_core_status(lcore_id)) !=
 			SPP_CORE_STOP_REQUEST) {
+		/* No port ability table is referred from here. */
+		spp_port_ability_quiescent(lcore_id);
 		if (status != SPP_CORE_FORWARD)
 			continue;
 
 		if (spp_check_core_update(lcore_id) == SPP_RET_OK) {
 			/* Setting with the flush command trigger. */
-			info->ref_index = (info->upd_index+1) %
-					SPP_INFO_AREA_MAX;
+			next = (info->upd_index+1) % SPP_INFO_AREA_MAX;
+			mirror_release_components(core, &info->core[next]);
+			info->ref_index = next;
 			core = get_core_info(lcore_id);
 		}
 
@@ -558,6 +1187,9 @@ slave_main(void *arg __attribute__ ((unused)))
 		}
 	}
 
+	/* Copies are not sent anymore after the lcore is stopped. */
+	mirror_release_components(core, NULL);
+	spp_port_ability_unregister_lcore(lcore_id);
 	set_core_status(lcore_id, SPP_CORE_STOP);
 	RTE_LOG(INFO, MIRROR, "Core[%d] End.\n", lcore_id);
 	return ret;
@@ -615,20 +1247,14 @@ main(int argc, char *argv[])
 			break;
 		}
 
-		/* create the mbuf pool */
-		ret = mirror_pool_create(g_startup_param.client_id);
-		if (ret == SPP_RET_NG) {
-			RTE_LOG(ERR, MIRROR,
-					"mirror mnuf pool create failed.\n");
-			return SPP_RET_NG;
-		}
-
 		int ret_mng = init_mng_data();
 		if (unlikely(ret_mng != 0))
 			break;
 
 		mirror_proc_init();
-		spp_port_ability_init();
+		int ret_ability_init = spp_port_ability_init();
+		if (unlikely(ret_ability_init != SPP_RET_OK))
+			break;
 
 		/* Setup connection for accepting commands from controller */
 		int ret_command_init = spp_command_proc_init(
@@ -659,13 +1285,8 @@ main(int argc, char *argv[])
 
 		/* Start forwarding */
 		set_all_core_status(SPP_CORE_FORWARD);
-#ifdef SPP_MIRROR_SHALLOWCOPY
-		RTE_LOG(INFO, MIRROR,
-			"My ID %d start handling messagei(ShallowCopy)\n", 0);
-#else
 		RTE_LOG(INFO, MIRROR,
-			"My ID %d start handling message(DeepCopy)\n", 0);
-#endif /* #ifdef SPP_MIRROR_SHALLOWCOPY */
+			"My ID %d start handling message\n", 0);
 		RTE_LOG(INFO, MIRROR, "[Press Ctrl-C to quit ...]\n");
 
 		/* Backup the management information after initialization */
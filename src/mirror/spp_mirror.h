@@ -12,15 +12,24 @@
  * Main function of spp_mirror.
  * This provides the function for initializing and starting the threads.
  *
- * There is two kinds of reproduction classification. I choose it by a
- * compilation switch.
+ * There is two kinds of reproduction classification. It is chosen for
+ * each of components.
  *  -DeepCopy
  *  -ShallowCopy
  *
+ * Packets received from a port are sent to the first tx port as
+ * original, and copies of them are sent to each of the rest of tx ports.
+ *
  * Attention
  *  I do not do the deletion of the VLAN tag, the addition.
  */
 
+/** Counters of packets for each of tx ports of mirror component */
+struct spp_mirror_tx_stats {
+	uint64_t sent;    /**< Packets sent to the port */
+	uint64_t dropped; /**< Packets not sent for failure of copy or tx */
+};
+
 /**
  * Update Mirror info
  *
@@ -51,4 +60,17 @@ int spp_mirror_get_component_status(
 		unsigned int lcore_id, int id,
 		struct spp_iterate_core_params *params);
 
+/**
+ * Get counters of packets sent to a tx port of mirror component.
+ *
+ * @param id
+ *  The unique component ID.
+ * @param port_id
+ *  The DPDK port ID of tx port.
+ * @param stats
+ *  The pointer to struct spp_mirror_tx_stats for output.
+ */
+void spp_mirror_get_tx_stats(int id, int port_id,
+		struct spp_mirror_tx_stats *stats);
+
 #endif /* __SPP_MIRROR_H__ */
@@ -0,0 +1,499 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_cycles.h>
+#include <rte_log.h>
+
+#include <lz4frame.h>
+#ifdef SPP_PCAP_ZSTD
+#include <zstd.h>
+#endif
+
+#include "spp_proc.h"
+#include "codec.h"
+
+#define RTE_LOGTYPE_SPP_PCAP_CODEC RTE_LOGTYPE_USER2
+
+/* Max compression level of LZ4, which is LZ4HC_CLEVEL_MAX of lz4hc.h */
+#define PCAP_CODEC_LZ4_LEVEL_MAX 12
+
+/* codec name string */
+const char *CODEC_TYPE_STRINGS[] = {
+	"none",
+	"lz4",
+	"zstd",
+	/* termination */ "",
+};
+
+/* file name extension of codec */
+const char *CODEC_EXTENSION_STRINGS[] = {
+	"",
+	".lz4",
+	".zst",
+	/* termination */ "",
+};
+
+/* lz4 preferences, of which compression level is given by codec */
+static const LZ4F_preferences_t g_kprefs = {
+	{
+		LZ4F_max256KB,
+		LZ4F_blockLinked,
+		LZ4F_noContentChecksum,
+		LZ4F_frame,
+		0,                   /* unknown content size */
+		{ 0, 0},             /* reserved, must be set to 0 */
+	},
+	0,                           /* compression level; 0 == default */
+	0,                           /* autoflush */
+	{ 0, 0, 0, 0},               /* reserved, must be set to 0 */
+};
+
+/* Parse integer parameter of codec string in the range */
+static int
+parse_codec_param(const char *str, int min, int max, int *value)
+{
+	char *endptr = NULL;
+	long val;
+
+	errno = 0;
+	val = strtol(str, &endptr, 10);
+	if (*str == '\0' || *endptr != '\0' || errno != 0 ||
+			val < min || val > max)
+		return SPP_RET_NG;
+
+	*value = (int)val;
+	return SPP_RET_OK;
+}
+
+/* Parse codec string */
+int
+spp_pcap_codec_parse(const char *str, struct spp_pcap_codec_conf *conf)
+{
+	char buf[SPP_PCAP_CODEC_STRLEN];
+	char *level, *workers;
+	int type;
+#ifdef SPP_PCAP_ZSTD
+	ZSTD_bounds bounds;
+#endif
+
+	if (strlen(str) >= sizeof(buf))
+		return SPP_RET_NG;
+	strcpy(buf, str);
+
+	level = strchr(buf, ':');
+	if (level != NULL)
+		*level++ = '\0';
+	workers = (level == NULL) ? NULL : strchr(level, ':');
+	if (workers != NULL)
+		*workers++ = '\0';
+
+	for (type = 0; CODEC_TYPE_STRINGS[type][0] != '\0'; type++) {
+		if (strcmp(buf, CODEC_TYPE_STRINGS[type]) == 0)
+			break;
+	}
+
+	conf->type = type;
+	conf->level = 0;
+	conf->workers = 0;
+	switch (type) {
+	case SPP_PCAP_CODEC_NONE:
+		if (level != NULL)
+			return SPP_RET_NG;
+		break;
+	case SPP_PCAP_CODEC_LZ4:
+		/* negative level is acceleration of fast mode */
+		if (workers != NULL || (level != NULL &&
+				parse_codec_param(level, INT_MIN + 1,
+						PCAP_CODEC_LZ4_LEVEL_MAX,
+						&conf->level) != SPP_RET_OK))
+			return SPP_RET_NG;
+		break;
+	case SPP_PCAP_CODEC_ZSTD:
+#ifdef SPP_PCAP_ZSTD
+		bounds = ZSTD_cParam_getBounds(ZSTD_c_compressionLevel);
+		if (level != NULL && parse_codec_param(level,
+				bounds.lowerBound, bounds.upperBound,
+				&conf->level) != SPP_RET_OK)
+			return SPP_RET_NG;
+
+		/* upper bound is 0 if libzstd is built without threads */
+		bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+		if (workers != NULL && (ZSTD_isError(bounds.error) ||
+				parse_codec_param(workers, 0,
+						bounds.upperBound,
+						&conf->workers) != SPP_RET_OK))
+			return SPP_RET_NG;
+		break;
+#else
+		RTE_LOG(ERR, SPP_PCAP_CODEC,
+				"zstd is not supported by this build.\n");
+		return SPP_RET_NG;
+#endif
+	default:
+		return SPP_RET_NG;
+	}
+
+	return SPP_RET_OK;
+}
+
+/* Format codec and parameters to string */
+void
+spp_pcap_codec_format(const struct spp_pcap_codec_conf *conf, char *str)
+{
+	switch (conf->type) {
+	case SPP_PCAP_CODEC_LZ4:
+		snprintf(str, SPP_PCAP_CODEC_STRLEN, "%s:%d",
+				CODEC_TYPE_STRINGS[conf->type], conf->level);
+		break;
+	case SPP_PCAP_CODEC_ZSTD:
+		snprintf(str, SPP_PCAP_CODEC_STRLEN, "%s:%d:%d",
+				CODEC_TYPE_STRINGS[conf->type], conf->level,
+				conf->workers);
+		break;
+	default:
+		snprintf(str, SPP_PCAP_CODEC_STRLEN, "%s",
+				CODEC_TYPE_STRINGS[SPP_PCAP_CODEC_NONE]);
+		break;
+	}
+}
+
+/* Get extension of file name for codec */
+const char *
+spp_pcap_codec_extension(enum spp_pcap_codec_type type)
+{
+	return CODEC_EXTENSION_STRINGS[type];
+}
+
+/**
+ * Write compressed data with the function of caller. Cycles spent in it
+ * are excluded from statistics of codec.
+ */
+static int
+write_codec_output(struct spp_pcap_codec *codec, void *buf, size_t len)
+{
+	uint64_t start = rte_rdtsc();
+	int ret;
+
+	ret = codec->write(codec->arg, buf, len);
+	codec->write_cycles += rte_rdtsc() - start;
+	codec->stats.out_bytes += len;
+	return ret == 0 ? SPP_RET_OK : SPP_RET_NG;
+}
+
+/* Start measuring cycles spent in codec */
+static inline uint64_t
+start_codec_cycles(struct spp_pcap_codec *codec)
+{
+	codec->write_cycles = 0;
+	return rte_rdtsc();
+}
+
+/* Add cycles spent in codec since start, except for writes */
+static inline void
+end_codec_cycles(struct spp_pcap_codec *codec, uint64_t start)
+{
+	codec->stats.cycles += rte_rdtsc() - start - codec->write_cycles;
+}
+
+/* Initialize compression stream */
+int
+spp_pcap_codec_init(struct spp_pcap_codec *codec,
+		const struct spp_pcap_codec_conf *conf, size_t max_len,
+		spp_pcap_codec_write_t write, void *arg)
+{
+	memset(codec, 0x00, sizeof(*codec));
+	codec->conf = *conf;
+	codec->write = write;
+	codec->arg = arg;
+
+	switch (conf->type) {
+	case SPP_PCAP_CODEC_LZ4:
+		codec->outbuf_size = LZ4F_compressBound(max_len, &g_kprefs);
+		break;
+#ifdef SPP_PCAP_ZSTD
+	case SPP_PCAP_CODEC_ZSTD:
+		/* output is flushed whenever the buffer gets full */
+		codec->outbuf_size = ZSTD_CStreamOutSize();
+		break;
+#endif
+	default:
+		/* data is written without copy */
+		return SPP_RET_OK;
+	}
+
+	codec->outbuf = malloc(codec->outbuf_size);
+	if (codec->outbuf == NULL)
+		return SPP_RET_NG;
+	return SPP_RET_OK;
+}
+
+/* Write header of LZ4 frame with the context created */
+static int
+start_lz4_frame(struct spp_pcap_codec *codec)
+{
+	LZ4F_preferences_t prefs = g_kprefs;
+	size_t ret;
+
+	prefs.compressionLevel = codec->conf.level;
+	ret = LZ4F_compressBegin(codec->cctx, codec->outbuf,
+			codec->outbuf_size, &prefs);
+	if (LZ4F_isError(ret)) {
+		RTE_LOG(ERR, SPP_PCAP_CODEC, "Failed to start compression: "
+				"error %zd\n", ret);
+		return SPP_RET_NG;
+	}
+	codec->frame_started = 1;
+	return write_codec_output(codec, codec->outbuf, ret);
+}
+
+/* Begin LZ4 frame and write its header */
+static int
+begin_lz4_frame(struct spp_pcap_codec *codec)
+{
+	LZ4F_compressionContext_t ctx;
+	size_t ret;
+
+	ret = LZ4F_createCompressionContext(&ctx, LZ4F_VERSION);
+	if (LZ4F_isError(ret)) {
+		RTE_LOG(ERR, SPP_PCAP_CODEC, "LZ4F_createCompressionContext "
+				"error (%zd)\n", ret);
+		return SPP_RET_NG;
+	}
+	codec->cctx = ctx;
+	return start_lz4_frame(codec);
+}
+
+/* End LZ4 frame and write the rest of compressed data, if started */
+static int
+end_lz4_frame(struct spp_pcap_codec *codec)
+{
+	size_t compress_len;
+
+	if (!codec->frame_started)
+		return SPP_RET_OK;
+	codec->frame_started = 0;
+
+	compress_len = LZ4F_compressEnd(codec->cctx, codec->outbuf,
+			codec->outbuf_size, NULL);
+	if (LZ4F_isError(compress_len)) {
+		RTE_LOG(ERR, SPP_PCAP_CODEC, "Failed to end compression: "
+				"error %zd\n", compress_len);
+		return SPP_RET_NG;
+	}
+	return write_codec_output(codec, codec->outbuf, compress_len);
+}
+
+#ifdef SPP_PCAP_ZSTD
+/* Begin zstd frame, which has no output until data is given */
+static int
+begin_zstd_frame(struct spp_pcap_codec *codec)
+{
+	ZSTD_CCtx *ctx;
+	size_t ret;
+
+	ctx = ZSTD_createCCtx();
+	if (ctx == NULL) {
+		RTE_LOG(ERR, SPP_PCAP_CODEC, "ZSTD_createCCtx error\n");
+		return SPP_RET_NG;
+	}
+	codec->cctx = ctx;
+
+	ret = ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel,
+			codec->conf.level);
+	if (ZSTD_isError(ret)) {
+		RTE_LOG(ERR, SPP_PCAP_CODEC, "Failed to set zstd level: %s\n",
+				ZSTD_getErrorName(ret));
+		return SPP_RET_NG;
+	}
+	if (codec->conf.workers == 0)
+		return SPP_RET_OK;
+
+	ret = ZSTD_CCtx_setParameter(ctx, ZSTD_c_nbWorkers,
+			codec->conf.workers);
+	if (ZSTD_isError(ret))
+		RTE_LOG(WARNING, SPP_PCAP_CODEC, "Compressed without zstd "
+				"workers: %s\n", ZSTD_getErrorName(ret));
+	return SPP_RET_OK;
+}
+
+/* Give data to zstd and write output until all of input is consumed */
+static int
+stream_zstd_frame(struct spp_pcap_codec *codec, void *buf, size_t len,
+		ZSTD_EndDirective mode)
+{
+	ZSTD_inBuffer in = { buf, len, 0 };
+	ZSTD_outBuffer out;
+	size_t remain;
+
+	do {
+		out.dst = codec->outbuf;
+		out.size = codec->outbuf_size;
+		out.pos = 0;
+		remain = ZSTD_compressStream2(codec->cctx, &out, &in, mode);
+		if (ZSTD_isError(remain)) {
+			RTE_LOG(ERR, SPP_PCAP_CODEC, "Compression failed: "
+					"%s\n", ZSTD_getErrorName(remain));
+			return SPP_RET_NG;
+		}
+		if (out.pos > 0 && write_codec_output(codec, out.dst,
+				out.pos) != SPP_RET_OK)
+			return SPP_RET_NG;
+	} while (in.pos < in.size || (mode == ZSTD_e_end && remain != 0));
+
+	return SPP_RET_OK;
+}
+#endif
+
+/* Free context of current frame */
+static void
+free_codec_context(struct spp_pcap_codec *codec)
+{
+	if (codec->cctx == NULL)
+		return;
+
+	switch (codec->conf.type) {
+	case SPP_PCAP_CODEC_LZ4:
+		LZ4F_freeCompressionContext(codec->cctx);
+		break;
+#ifdef SPP_PCAP_ZSTD
+	case SPP_PCAP_CODEC_ZSTD:
+		ZSTD_freeCCtx(codec->cctx);
+		break;
+#endif
+	default:
+		break;
+	}
+	codec->cctx = NULL;
+	codec->frame_started = 0;
+}
+
+/* Begin a frame of compression */
+int
+spp_pcap_codec_begin(struct spp_pcap_codec *codec)
+{
+	uint64_t start = start_codec_cycles(codec);
+	int ret;
+
+	free_codec_context(codec);
+	switch (codec->conf.type) {
+	case SPP_PCAP_CODEC_LZ4:
+		ret = begin_lz4_frame(codec);
+		break;
+#ifdef SPP_PCAP_ZSTD
+	case SPP_PCAP_CODEC_ZSTD:
+		ret = begin_zstd_frame(codec);
+		break;
+#endif
+	default:
+		ret = SPP_RET_OK;
+		break;
+	}
+	end_codec_cycles(codec, start);
+	return ret;
+}
+
+/* Compress data and write it */
+int
+spp_pcap_codec_compress(struct spp_pcap_codec *codec, void *buf, size_t len)
+{
+	uint64_t start = start_codec_cycles(codec);
+	size_t compress_len;
+	int ret;
+
+	switch (codec->conf.type) {
+	case SPP_PCAP_CODEC_LZ4:
+		/* next frame is started when data is given after restart */
+		if (!codec->frame_started &&
+				start_lz4_frame(codec) != SPP_RET_OK) {
+			ret = SPP_RET_NG;
+			break;
+		}
+		compress_len = LZ4F_compressUpdate(codec->cctx, codec->outbuf,
+				codec->outbuf_size, buf, len, NULL);
+		if (LZ4F_isError(compress_len)) {
+			RTE_LOG(ERR, SPP_PCAP_CODEC, "Compression failed: "
+					"error %zd\n", compress_len);
+			ret = SPP_RET_NG;
+			break;
+		}
+		ret = write_codec_output(codec, codec->outbuf, compress_len);
+		break;
+#ifdef SPP_PCAP_ZSTD
+	case SPP_PCAP_CODEC_ZSTD:
+		ret = stream_zstd_frame(codec, buf, len, ZSTD_e_continue);
+		break;
+#endif
+	default:
+		ret = write_codec_output(codec, buf, len);
+		break;
+	}
+	codec->stats.in_bytes += len;
+	end_codec_cycles(codec, start);
+	return ret;
+}
+
+/* End the frame and write the rest of compressed data */
+int
+spp_pcap_codec_end(struct spp_pcap_codec *codec)
+{
+	uint64_t start = start_codec_cycles(codec);
+	int ret = SPP_RET_OK;
+
+	switch (codec->conf.type) {
+	case SPP_PCAP_CODEC_LZ4:
+		ret = end_lz4_frame(codec);
+		break;
+#ifdef SPP_PCAP_ZSTD
+	case SPP_PCAP_CODEC_ZSTD:
+		ret = stream_zstd_frame(codec, NULL, 0, ZSTD_e_end);
+		break;
+#endif
+	default:
+		break;
+	}
+	free_codec_context(codec);
+	end_codec_cycles(codec, start);
+	return ret;
+}
+
+/* End the frame, and the next one is begun with the same context */
+int
+spp_pcap_codec_restart(struct spp_pcap_codec *codec)
+{
+	uint64_t start = start_codec_cycles(codec);
+	int ret = SPP_RET_OK;
+
+	switch (codec->conf.type) {
+	case SPP_PCAP_CODEC_LZ4:
+		/* next frame is started when data is given */
+		ret = end_lz4_frame(codec);
+		break;
+#ifdef SPP_PCAP_ZSTD
+	case SPP_PCAP_CODEC_ZSTD:
+		/* next frame is started when data is given */
+		ret = stream_zstd_frame(codec, NULL, 0, ZSTD_e_end);
+		break;
+#endif
+	default:
+		break;
+	}
+	end_codec_cycles(codec, start);
+	return ret;
+}
+
+/* Free context and buffer of compression stream */
+void
+spp_pcap_codec_free(struct spp_pcap_codec *codec)
+{
+	free_codec_context(codec);
+	free(codec->outbuf);
+	codec->outbuf = NULL;
+	codec->outbuf_size = 0;
+}
@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _SPP_PCAP_CODEC_H_
+#define _SPP_PCAP_CODEC_H_
+
+/**
+ * @file
+ * SPP pcap compression codec
+ *
+ * Compress capture files with a codec selected for each capture session.
+ * Compressed data is given to a write function of caller.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Max length of codec string, such as 'zstd:19:4' */
+#define SPP_PCAP_CODEC_STRLEN 32
+
+/** Type of compression codec */
+enum spp_pcap_codec_type {
+	SPP_PCAP_CODEC_NONE, /**< Not compressed */
+	SPP_PCAP_CODEC_LZ4,  /**< LZ4 frame */
+	SPP_PCAP_CODEC_ZSTD, /**< Zstandard frame */
+};
+
+/** Codec and its parameters */
+struct spp_pcap_codec_conf {
+	enum spp_pcap_codec_type type; /**< Type of codec */
+	int level;   /**< Compression level, 0 for default of codec */
+	int workers; /**< Num of worker threads of zstd, 0 for none */
+};
+
+/** Statistics of compression */
+struct spp_pcap_codec_stats {
+	uint64_t in_bytes;  /**< Num of bytes given to codec */
+	uint64_t out_bytes; /**< Num of bytes output from codec */
+	uint64_t cycles;    /**< TSC cycles spent in codec */
+};
+
+/**
+ * Function to write compressed data.
+ *
+ * @retval 0 succeeded.
+ * @retval others failed.
+ */
+typedef int (*spp_pcap_codec_write_t)(void *arg, void *buf, size_t len);
+
+/** Compression stream of a writer thread */
+struct spp_pcap_codec {
+	struct spp_pcap_codec_conf conf; /**< Codec and parameters */
+	void *cctx;          /**< Context of current frame, or NULL */
+	int frame_started;   /**< Header of LZ4 frame is written */
+	void *outbuf;        /**< Buffer of compressed data */
+	size_t outbuf_size;  /**< Size of outbuf */
+	spp_pcap_codec_write_t write; /**< Function to write data */
+	void *arg;           /**< Argument for write */
+	uint64_t write_cycles; /**< Cycles spent in write in a call */
+	struct spp_pcap_codec_stats stats; /**< Statistics */
+};
+
+/**
+ * Parse codec string.
+ *
+ * It is 'none', 'lz4[:LEVEL]' or 'zstd[:LEVEL[:THREADS]]'. Negative
+ * level of LZ4 is fast mode and 3 or more is HC mode.
+ *
+ * @param str
+ *  Codec string.
+ * @param conf
+ *  The pointer to struct spp_pcap_codec_conf to store the result.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if invalid or not supported by the build.
+ */
+int spp_pcap_codec_parse(const char *str, struct spp_pcap_codec_conf *conf);
+
+/**
+ * Format codec and parameters to string which can be parsed again.
+ *
+ * @param conf
+ *  The pointer to struct spp_pcap_codec_conf.
+ * @param str
+ *  Buffer of at least SPP_PCAP_CODEC_STRLEN bytes.
+ */
+void spp_pcap_codec_format(const struct spp_pcap_codec_conf *conf,
+		char *str);
+
+/**
+ * Get extension of file name for codec, such as '.lz4'.
+ *
+ * @param type
+ *  Type of codec.
+ *
+ * @return
+ *  Extension including leading dot, or empty string if not compressed.
+ */
+const char *spp_pcap_codec_extension(enum spp_pcap_codec_type type);
+
+/**
+ * Initialize compression stream and clear statistics.
+ *
+ * @param codec
+ *  The pointer to struct spp_pcap_codec to be initialized.
+ * @param conf
+ *  Codec and parameters.
+ * @param max_len
+ *  Max length of data given at once to spp_pcap_codec_compress().
+ * @param write
+ *  Function to write compressed data.
+ * @param arg
+ *  Argument for write.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed to allocate buffer.
+ */
+int spp_pcap_codec_init(struct spp_pcap_codec *codec,
+		const struct spp_pcap_codec_conf *conf, size_t max_len,
+		spp_pcap_codec_write_t write, void *arg);
+
+/**
+ * Begin a frame of compression for a new file.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed.
+ */
+int spp_pcap_codec_begin(struct spp_pcap_codec *codec);
+
+/**
+ * Compress data and write it.
+ *
+ * @param codec
+ *  The pointer to struct spp_pcap_codec.
+ * @param buf
+ *  Data to be compressed.
+ * @param len
+ *  Length of data, not more than max_len given at initialization.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed.
+ */
+int spp_pcap_codec_compress(struct spp_pcap_codec *codec,
+		void *buf, size_t len);
+
+/**
+ * End the frame and write the rest of compressed data.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed.
+ */
+int spp_pcap_codec_end(struct spp_pcap_codec *codec);
+
+/**
+ * End the frame and begin the next one without recreating the context.
+ *
+ * Each frame can be decompressed without the preceding ones, so that a
+ * reader can seek to the beginning of a frame. Nothing of the next frame
+ * is written until data is given, so the position of output after this
+ * is the end of the frame and the beginning of the next one.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed.
+ */
+int spp_pcap_codec_restart(struct spp_pcap_codec *codec);
+
+/**
+ * Free context and buffer of compression stream.
+ */
+void spp_pcap_codec_free(struct spp_pcap_codec *codec);
+
+#endif /* _SPP_PCAP_CODEC_H_ */
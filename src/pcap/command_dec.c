@@ -4,6 +4,7 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include <rte_ether.h>
 #include <rte_log.h>
@@ -57,6 +58,93 @@ parse_parameter_value(char *string, int max, int *argc, char *argv[])
 	return SPP_RET_OK;
 }
 
+/* command action type string list, same as enum spp_command_action */
+static const char *COMMAND_ACTION_STRINGS[] = {
+	"",
+	"add",
+	"del",
+	/* termination */ "",
+};
+
+/* decoding procedure of port command, such as 'port add phy:1' */
+static int
+decode_command_port(struct spp_command_request *request, int argc,
+		char *argv[], struct spp_command_parse_error *error,
+		int maxargc __attribute__ ((unused)))
+{
+	struct spp_command_port *port = &request->commands[0].spec.port;
+	int cnt;
+
+	if (argc < 3)
+		return set_parse_error(error, NO_PARAM, "port");
+
+	port->action = SPP_CMD_ACTION_NONE;
+	for (cnt = 1; COMMAND_ACTION_STRINGS[cnt][0] != '\0'; cnt++) {
+		if (strcmp(argv[1], COMMAND_ACTION_STRINGS[cnt]) == 0)
+			port->action = cnt;
+	}
+	if (port->action == SPP_CMD_ACTION_NONE) {
+		RTE_LOG(ERR, SPP_COMMAND_DEC,
+				"Unknown port action. val=%s\n", argv[1]);
+		return set_string_value_parse_error(error, argv[1],
+				"action");
+	}
+
+	if (spp_convert_port_to_iface(argv[2], &port->port.iface_type,
+			&port->port.iface_no) != SPP_RET_OK) {
+		RTE_LOG(ERR, SPP_COMMAND_DEC, "Bad port. val=%s\n", argv[2]);
+		return set_string_value_parse_error(error, argv[2], "port");
+	}
+
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of snaplen command, such as 'snaplen 128' */
+static int
+decode_command_snaplen(struct spp_command_request *request, int argc,
+		char *argv[], struct spp_command_parse_error *error,
+		int maxargc __attribute__ ((unused)))
+{
+	struct spp_command_snaplen *snaplen =
+			&request->commands[0].spec.snaplen;
+	unsigned long len;
+	char *endptr = NULL;
+
+	if (argc < 2)
+		return set_parse_error(error, NO_PARAM, "snaplen");
+
+	len = strtoul(argv[1], &endptr, 10);
+	if (unlikely(argv[1] == endptr) || unlikely(*endptr != '\0') ||
+			len == 0 || len > UINT16_MAX) {
+		RTE_LOG(ERR, SPP_COMMAND_DEC,
+				"Bad snaplen. val=%s\n", argv[1]);
+		return set_string_value_parse_error(error, argv[1],
+				"snaplen");
+	}
+
+	snaplen->snaplen = len;
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of codec command, such as 'codec zstd:3' */
+static int
+decode_command_codec(struct spp_command_request *request, int argc,
+		char *argv[], struct spp_command_parse_error *error,
+		int maxargc __attribute__ ((unused)))
+{
+	if (argc < 2)
+		return set_parse_error(error, NO_PARAM, "codec");
+
+	if (spp_pcap_codec_parse(argv[1],
+			&request->commands[0].spec.codec) != SPP_RET_OK) {
+		RTE_LOG(ERR, SPP_COMMAND_DEC,
+				"Bad codec. val=%s\n", argv[1]);
+		return set_string_value_parse_error(error, argv[1],
+				"codec");
+	}
+	return SPP_RET_OK;
+}
+
 /* command list for parse */
 struct parse_command_list {
 	const char *name;       /* Command name */
@@ -77,6 +165,10 @@ static struct parse_command_list command_list_pcap[] = {
 	{ "exit",           1, 1, NULL, CMD_EXIT      },
 	{ "start",          1, 1, NULL, CMD_START     },
 	{ "stop",           1, 1, NULL, CMD_STOP      },
+	{ "port",           3, 3, decode_command_port, CMD_PORT },
+	{ "snaplen",        2, 2, decode_command_snaplen, CMD_SNAPLEN },
+	{ "codec",          2, 2, decode_command_codec, CMD_CODEC },
+	{ "dump",           1, 1, NULL, CMD_DUMP      },
 	{ "",               0, 0, NULL, 0 }  /* termination */
 };
 
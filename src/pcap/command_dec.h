@@ -13,6 +13,7 @@
  */
 
 #include "spp_proc.h"
+#include "codec.h"
 
 /** max number of command per request */
 #define SPP_CMD_MAX_COMMANDS 32
@@ -58,11 +59,55 @@ enum spp_command_type {
 	/** stop command */
 	CMD_STOP,
 
+	/** port command */
+	CMD_PORT,
+
+	/** snaplen command */
+	CMD_SNAPLEN,
+
+	/** codec command */
+	CMD_CODEC,
+
+	/** dump command */
+	CMD_DUMP,
+};
+
+/** Type of action of port command */
+enum spp_command_action {
+	SPP_CMD_ACTION_NONE, /**< none */
+	SPP_CMD_ACTION_ADD,  /**< add */
+	SPP_CMD_ACTION_DEL,  /**< del */
+};
+
+/** "port" command parameters */
+struct spp_command_port {
+	/** Action identifier (add or del) */
+	enum spp_command_action action;
+
+	/** Port type and number */
+	struct spp_port_index port;
+};
+
+/** "snaplen" command parameters */
+struct spp_command_snaplen {
+	/** Max length of captured packets */
+	uint32_t snaplen;
 };
 
 /** command parameters */
 struct spp_command {
 	enum spp_command_type type; /**< Command type */
+
+	union {
+		/** Structured data for port command  */
+		struct spp_command_port port;
+
+		/** Structured data for snaplen command  */
+		struct spp_command_snaplen snaplen;
+
+		/** Structured data for codec command  */
+		struct spp_pcap_codec_conf codec;
+	} spec;
 };
 
 /** request parameters */
@@ -4,6 +4,7 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include <rte_log.h>
 
@@ -137,6 +138,30 @@ append_json_uint_value(const char *name, char **output, unsigned int value)
 	return SPP_RET_OK;
 }
 
+/**
+ * Append JSON formatted tag and its 64-bit value to given `output` val, for
+ * counters which can be over the range of unsigned int.
+ */
+static int
+append_json_uint64_value(const char *name, char **output, uint64_t value)
+{
+	int len = strlen(*output);
+	/* extend the buffer */
+	*output = spp_strbuf_append(*output, "",
+			strlen(name) + CMD_TAG_APPEND_SIZE*2);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"JSON's numeric format failed to add. "
+				"(name = %s, uint64 = %"PRIu64")\n",
+				name, value);
+		return SPP_RET_NG;
+	}
+
+	sprintf(&(*output)[len], JSON_APPEND_VALUE("%"PRIu64),
+			JSON_APPEND_COMMA(len), name, value);
+	return SPP_RET_OK;
+}
+
 /**
  * Append JSON formatted tag and its value to given `output` val. For example,
  * `output` is `"client-id": 1`
@@ -264,6 +289,31 @@ execute_command(const struct spp_command *command)
 		RTE_LOG(INFO, SPP_COMMAND_PROC,
 				"Execute stop command.\n");
 		break;
+
+	case CMD_PORT:
+		RTE_LOG(INFO, SPP_COMMAND_PROC,
+				"Execute port command. (act = %d)\n",
+				command->spec.port.action);
+		ret = spp_pcap_update_port(command->spec.port.action,
+				&command->spec.port.port);
+		break;
+
+	case CMD_SNAPLEN:
+		RTE_LOG(INFO, SPP_COMMAND_PROC,
+				"Execute snaplen command. (snaplen = %u)\n",
+				command->spec.snaplen.snaplen);
+		ret = spp_pcap_set_snaplen(command->spec.snaplen.snaplen);
+		break;
+
+	case CMD_CODEC:
+		RTE_LOG(INFO, SPP_COMMAND_PROC, "Execute codec command.\n");
+		ret = spp_pcap_set_codec(&command->spec.codec);
+		break;
+
+	case CMD_DUMP:
+		RTE_LOG(INFO, SPP_COMMAND_PROC, "Execute dump command.\n");
+		ret = spp_pcap_request_dump();
+		break;
 	}
 
 	return ret;
@@ -406,6 +456,27 @@ append_capture_status_value(const char *name, char **output,
 			CAPTURE_STATUS_STRINGS[*capture_status]);
 }
 
+/* append snaplen of capture files for JSON format */
+static int
+append_snaplen_value(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	return append_json_uint_value(name, output, spp_pcap_get_snaplen());
+}
+
+/* append codec of capture files for JSON format */
+static int
+append_codec_value(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	struct spp_pcap_codec_conf conf;
+	char codec_str[SPP_PCAP_CODEC_STRLEN];
+
+	spp_pcap_get_codec(&conf);
+	spp_pcap_codec_format(&conf, codec_str);
+	return append_json_str_value(name, output, codec_str);
+}
+
 /* append a client id for JSON format */
 static int
 append_client_id_value(const char *name, char **output,
@@ -473,6 +544,168 @@ append_process_type_value(const char *name, char **output,
 	return append_json_str_value(name, output, "pcap");
 }
 
+/* append statistics of file writes of writer thread for JSON format */
+static int
+append_write_stats_block(char **output, unsigned int lcore_id)
+{
+	int ret = SPP_RET_NG;
+	char *tmp_buff;
+	struct spp_pcap_write_stats stats;
+	uint64_t latency_avg = 0;
+
+	if (spp_pcap_get_write_stats(lcore_id, &stats) != SPP_RET_OK)
+		return SPP_RET_OK;
+	if (stats.writes != 0)
+		latency_avg = stats.latency_total / stats.writes;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (lcore_id = %d)\n", lcore_id);
+		return ret;
+	}
+
+	ret = append_json_uint_value("writes", &tmp_buff, stats.writes);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint_value("latency_avg_us", &tmp_buff,
+				latency_avg);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint_value("latency_max_us", &tmp_buff,
+				stats.latency_max);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint_value("queue_depth", &tmp_buff,
+				stats.queue_depth);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint_value("queue_depth_max", &tmp_buff,
+				stats.queue_depth_max);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint_value("stalls", &tmp_buff,
+				stats.stalls);
+	if (ret == SPP_RET_OK)
+		ret = append_json_block_brackets("write_stats", output,
+				tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/**
+ * append statistics of compression of writer thread for JSON format. Ratio
+ * is size of output in percent of input, and speed is bytes of input
+ * compressed per 1000 cycles of TSC.
+ */
+static int
+append_codec_stats_block(char **output, unsigned int lcore_id)
+{
+	int ret = SPP_RET_NG;
+	char *tmp_buff;
+	char codec_str[SPP_PCAP_CODEC_STRLEN];
+	struct spp_pcap_codec_conf conf;
+	struct spp_pcap_codec_stats stats;
+	uint64_t ratio = 0;
+	uint64_t speed = 0;
+
+	if (spp_pcap_get_codec_stats(lcore_id, &conf, &stats) != SPP_RET_OK)
+		return SPP_RET_OK;
+	spp_pcap_codec_format(&conf, codec_str);
+	if (stats.in_bytes != 0)
+		ratio = stats.out_bytes * 100 / stats.in_bytes;
+	if (stats.cycles != 0)
+		speed = stats.in_bytes * 1000 / stats.cycles;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (lcore_id = %d)\n", lcore_id);
+		return ret;
+	}
+
+	ret = append_json_str_value("codec", &tmp_buff, codec_str);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint64_value("in_bytes", &tmp_buff,
+				stats.in_bytes);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint64_value("out_bytes", &tmp_buff,
+				stats.out_bytes);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint64_value("ratio_percent", &tmp_buff,
+				ratio);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint64_value("bytes_per_kcycle", &tmp_buff,
+				speed);
+	if (ret == SPP_RET_OK)
+		ret = append_json_block_brackets("compress_stats", output,
+				tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append statistics of flight recorder of writer thread for JSON format */
+static int
+append_recorder_stats_block(char **output, unsigned int lcore_id)
+{
+	int ret = SPP_RET_NG;
+	char *tmp_buff;
+	struct spp_pcap_recorder_stats stats;
+
+	if (spp_pcap_get_recorder_stats(lcore_id, &stats) != SPP_RET_OK)
+		return SPP_RET_OK;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (lcore_id = %d)\n", lcore_id);
+		return ret;
+	}
+
+	ret = append_json_uint64_value("size", &tmp_buff, stats.size);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint64_value("used", &tmp_buff, stats.used);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint64_value("packets", &tmp_buff,
+				stats.packets);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint64_value("dumps", &tmp_buff,
+				stats.dumps);
+	if (ret == SPP_RET_OK)
+		ret = append_json_block_brackets("recorder", output, tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append counters of capture filter of receive thread for JSON format */
+static int
+append_filter_stats_block(char **output, unsigned int lcore_id)
+{
+	int ret = SPP_RET_NG;
+	char *tmp_buff;
+	struct spp_pcap_filter_stats stats;
+
+	if (spp_pcap_get_filter_stats(lcore_id, &stats) != SPP_RET_OK)
+		return SPP_RET_OK;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (lcore_id = %d)\n", lcore_id);
+		return ret;
+	}
+
+	ret = append_json_str_value("expression", &tmp_buff,
+			stats.expression);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint_value("pass", &tmp_buff, stats.pass);
+	if (ret == SPP_RET_OK)
+		ret = append_json_uint_value("drop", &tmp_buff, stats.drop);
+	if (ret == SPP_RET_OK)
+		ret = append_json_block_brackets("filter", output, tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 static int
 append_pcap_core_element_value(
 		struct spp_iterate_core_params *params,
@@ -509,11 +742,21 @@ append_pcap_core_element_value(
 	if (unlikely(ret < SPP_RET_OK))
 		return ret;
 
-	if (num_rx != 0)
+	if (strcmp(type, "receive") == 0) {
 		ret = append_port_array("rx_port", &tmp_buff,
 				num_rx, rx_ports, SPP_PORT_RXTX_RX);
-	else
+		if (ret == SPP_RET_OK)
+			ret = append_filter_stats_block(&tmp_buff, lcore_id);
+	} else {
 		ret = append_json_str_value("filename", &tmp_buff, name);
+		if (ret == SPP_RET_OK)
+			ret = append_write_stats_block(&tmp_buff, lcore_id);
+		if (ret == SPP_RET_OK)
+			ret = append_codec_stats_block(&tmp_buff, lcore_id);
+		if (ret == SPP_RET_OK)
+			ret = append_recorder_stats_block(&tmp_buff,
+					lcore_id);
+	}
 	if (unlikely(ret < 0))
 		return ret;
 
@@ -625,6 +868,8 @@ struct command_response_list response_result_list[] = {
 struct command_response_list response_info_list[] = {
 	{ "client-id",        append_client_id_value },
 	{ "status",           append_capture_status_value },
+	{ "snaplen",          append_snaplen_value },
+	{ "codec",            append_codec_value },
 	{ "core",             append_core_value },
 	COMMAND_RESP_TAG_LIST_EMPTY
 };
@@ -6,11 +6,30 @@
 #include <arpa/inet.h>
 #include <getopt.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <aio.h>
 
+#include <rte_atomic.h>
 #include <rte_common.h>
 #include <rte_cycles.h>
-
-#include <lz4frame.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_version.h>
+
+#include <pcap/pcap.h>
+
+/*
+ * Capture filter compiled by libpcap is converted to eBPF and JIT-ed by
+ * librte_bpf if rte_bpf_convert() is available, or interpreted by libpcap.
+ * rte_bpf_convert() is provided since DPDK v21.11 built with libpcap, so
+ * the librte_bpf path is unreachable with DPDK v19.05 or earlier which
+ * this tree requires, and the filter is always evaluated by libpcap.
+ */
+#if RTE_VERSION >= RTE_VERSION_NUM(21, 11, 0, 0) && defined(RTE_PORT_PCAP)
+#define PCAP_USE_RTE_BPF
+#include <rte_bpf.h>
+#endif
 
 #include "shared/common.h"
 #include "spp_proc.h"
@@ -18,17 +37,19 @@
 #include "command_proc.h"
 #include "command_dec.h"
 #include "spp_port.h"
+#include "codec.h"
 
 /* Declare global variables */
 #define RTE_LOGTYPE_SPP_PCAP RTE_LOGTYPE_USER2
 
 /* Pcap file attributes */
 #define PCAP_FPATH_STRLEN 128
-#define PCAP_FNAME_STRLEN 64
-#define PCAP_FDATE_STRLEN 16
+#define PCAP_FNAME_STRLEN 128
+#define PCAP_FDATE_STRLEN 32
+#define PCAP_FILTER_STRLEN 256
 
-/* Used to identify pcap files */
-#define TCPDUMP_MAGIC 0xa1b2c3d4
+/* Used to identify pcap files of nanosecond resolution */
+#define TCPDUMP_MAGIC_NSEC 0xa1b23c4d
 
 /* Indicates major verions of libpcap file */
 #define PCAP_VERSION_MAJOR 2
@@ -37,12 +58,49 @@
 #define PCAP_SNAPLEN_MAX 65535
 
 #define PCAP_LINKTYPE 1  /* Link type 1 means LINKTYPE_ETHERNET */
+
+/* Block types and options of pcapng */
+#define PCAPNG_BLOCK_SHB 0x0a0d0d0a  /* Section Header Block */
+#define PCAPNG_BLOCK_IDB 0x00000001  /* Interface Description Block */
+#define PCAPNG_BLOCK_ISB 0x00000005  /* Interface Statistics Block */
+#define PCAPNG_BLOCK_EPB 0x00000006  /* Enhanced Packet Block */
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1a2b3c4d
+#define PCAPNG_VERSION_MAJOR 1
+#define PCAPNG_VERSION_MINOR 0
+#define PCAPNG_OPT_END 0
+#define PCAPNG_OPT_IF_NAME 2
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_OPT_ISB_IFRECV 4
+#define PCAPNG_OPT_ISB_OSDROP 7
+#define PCAPNG_TSRESOL_NSEC 9  /* Resolution of timestamp is 10^-9 */
+#define PCAPNG_BLOCK_BUF_SIZE 256  /* Buffer for blocks other than EPB */
+
 #define IN_CHUNK_SIZE (16*1024)
+/* Staging buffer is large enough for a record of PCAP_SNAPLEN_MAX */
+#define PCAP_STAGING_SIZE (IN_CHUNK_SIZE * 8)
 #define DEFAULT_OUTPUT_DIR "/tmp"
 #define DEFAULT_FILE_LIMIT 1073741824  /* 1GiB */
 #define PORT_STR_SIZE 16
+#define PCAP_CAP_PORT_MAX 8  /* Max num of capture ports */
 #define RING_SIZE 16384
 #define MAX_PCAP_BURST 256  /* Num of received packets at once */
+#define NIC_CLOCK_MEASURE_MS 100  /* Period for measuring clock of NIC */
+#define PCAP_IO_BLOCK_SIZE (1024*1024)  /* Size of block written at once */
+#define PCAP_IO_BLOCK_NUM 4  /* Num of blocks for writing asynchronously */
+#define PCAP_IO_ALIGN 4096  /* Alignment of block for O_DIRECT */
+#define PCAP_RECORDER_ALIGN 8  /* Alignment of records of flight recorder */
+#define PCAP_RECORDER_MIN (1024*1024)  /* Min memory of a flight recorder */
+#define PCAP_RETAIN_FILES_INIT 64  /* Initial num of files retained */
+#define PCAP_TRIGGER_INTERVAL_MS 1000  /* Period for checking triggers */
+#define PCAP_INDEX_MAGIC 0x58444950  /* "PIDX" */
+#define PCAP_INDEX_VERSION 1
+#define PCAP_INDEX_CHUNK_SIZE (4*1024*1024)  /* Min records in a chunk */
+#define PCAP_INDEX_F_IDB 0x1  /* Chunk has interface blocks of pcapng */
+
+/* Data is written via page cache if O_DIRECT is not available */
+#ifndef O_DIRECT
+#define O_DIRECT 0
+#endif
 
 /* Ensure snaplen not to be over the maximum size */
 #define TRANCATE_SNAPLEN(a, b) (((a) < (b))?(a):(b))
@@ -67,6 +125,19 @@ enum comp_file_generate_mode {
 	CLOSE_MODE   /* close mode which is used when capture is stopped */
 };
 
+/* format of capture file */
+enum pcap_file_format {
+	PCAP_FORMAT_PCAP,   /* pcap of nanosecond resolution */
+	PCAP_FORMAT_PCAPNG  /* pcapng */
+};
+
+/* capture file format string, same as the order of pcap_file_format */
+const char *PCAP_FILE_FORMAT_STRINGS[] = {
+	"pcap",
+	"pcapng",
+	/* termination */ "",
+};
+
 /* capture thread name string  */
 const char *CAPTURE_THREAD_TYPE_STRINGS[] = {
 	"unuse",
@@ -75,21 +146,6 @@ const char *CAPTURE_THREAD_TYPE_STRINGS[] = {
 	/* termination */ "",
 };
 
-/* lz4 preferences */
-static const LZ4F_preferences_t g_kprefs = {
-	{
-		LZ4F_max256KB,
-		LZ4F_blockLinked,
-		LZ4F_noContentChecksum,
-		LZ4F_frame,
-		0,                   /* unknown content size */
-		{ 0, 0},             /* reserved, must be set to 0 */
-	},
-	0,                           /* compression level; 0 == default */
-	0,                           /* autoflush */
-	{ 0, 0, 0, 0},               /* reserved, must be set to 0 */
-};
-
 /* pcap file header */
 struct __attribute__((__packed__)) pcap_header {
 	uint32_t magic_number;  /* magic number */
@@ -104,19 +160,219 @@ struct __attribute__((__packed__)) pcap_header {
 /* pcap packet header */
 struct pcap_packet_header {
 	uint32_t ts_sec;        /* time stamp seconds */
-	uint32_t ts_usec;       /* time stamp micro seconds */
+	uint32_t ts_nsec;       /* time stamp nano seconds */
 	uint32_t write_len;     /* write length */
 	uint32_t packet_len;    /* packet length */
 };
 
+/* pcapng section header block without options */
+struct __attribute__((__packed__)) pcapng_section_header {
+	uint32_t block_type;       /* PCAPNG_BLOCK_SHB */
+	uint32_t block_length;     /* total length of block */
+	uint32_t byte_order_magic; /* PCAPNG_BYTE_ORDER_MAGIC */
+	uint16_t version_major;    /* major version number */
+	uint16_t version_minor;    /* minor version number */
+	int64_t  section_length;   /* -1 means not specified */
+};
+
+/* pcapng interface description block without options */
+struct pcapng_interface_description {
+	uint32_t block_type;    /* PCAPNG_BLOCK_IDB */
+	uint32_t block_length;  /* total length of block */
+	uint16_t linktype;      /* data link type */
+	uint16_t reserved;      /* reserved, must be set to 0 */
+	uint32_t snaplen;       /* max length of captured packets */
+};
+
+/* pcapng enhanced packet block without packet data and options */
+struct pcapng_enhanced_packet {
+	uint32_t block_type;    /* PCAPNG_BLOCK_EPB */
+	uint32_t block_length;  /* total length of block */
+	uint32_t interface_id;  /* index of IDB in the section */
+	uint32_t ts_high;       /* upper 32 bits of timestamp */
+	uint32_t ts_low;        /* lower 32 bits of timestamp */
+	uint32_t captured_len;  /* write length */
+	uint32_t packet_len;    /* packet length */
+};
+
+/* pcapng interface statistics block without options */
+struct pcapng_interface_statistics {
+	uint32_t block_type;    /* PCAPNG_BLOCK_ISB */
+	uint32_t block_length;  /* total length of block */
+	uint32_t interface_id;  /* index of IDB in the section */
+	uint32_t ts_high;       /* upper 32 bits of timestamp */
+	uint32_t ts_low;        /* lower 32 bits of timestamp */
+};
+
+/**
+ * Header of index file written beside capture file with extension of
+ * '.idx', followed by entries of chunks of the capture file.
+ */
+struct __attribute__((__packed__)) pcap_index_header {
+	uint32_t magic;         /* PCAP_INDEX_MAGIC */
+	uint16_t version;       /* PCAP_INDEX_VERSION */
+	uint8_t format;         /* enum pcap_file_format */
+	uint8_t codec;          /* enum spp_pcap_codec_type */
+	uint32_t snaplen;       /* snaplen of the file */
+	uint32_t reserved;      /* reserved */
+};
+
+/**
+ * Entry of index for a chunk of capture file, which is a frame of codec
+ * of whole records. File header is in the frame before the first chunk.
+ */
+struct __attribute__((__packed__)) pcap_index_entry {
+	uint64_t offset;        /* offset of chunk in capture file */
+	uint64_t length;        /* length of chunk in capture file */
+	uint64_t first_ns;      /* the earliest timestamp in nsec */
+	uint64_t last_ns;       /* the latest timestamp in nsec */
+	uint32_t packets;       /* num of packets */
+	uint32_t flags;         /* PCAP_INDEX_F_* */
+};
+
+/* pcapng option header */
+struct pcapng_option_header {
+	uint16_t code;          /* option code */
+	uint16_t length;        /* length of value without padding */
+};
+
+/**
+ * Set of capture ports polled by receive thread. RX queues are numbered
+ * from first_item of the port, and the number is kept while the port is
+ * captured so that the queue is polled by the same receive thread even if
+ * other ports are deleted.
+ */
+struct pcap_port_set {
+	int num;                                   /* num of ports */
+	struct spp_port_info ports[PCAP_CAP_PORT_MAX]; /* capture ports */
+	uint32_t first_item[PCAP_CAP_PORT_MAX];    /* number of RX queue 0 */
+};
+
+/**
+ * Attributes of capture port referred by DPDK port ID which is given to
+ * mbuf as the tag of source port.
+ */
+struct pcap_port_attr {
+	char name[PORT_STR_SIZE];    /* port string, such as 'phy:0' */
+	uint64_t nic_clock_hz;       /* frequency of NIC clock, or 0 */
+	uint64_t base_tsc;           /* TSC when base_nic_clock is read */
+	uint64_t base_nic_clock;     /* clock of NIC read at base_tsc */
+	uint16_t nb_rx_queues;       /* num of RX queues polled */
+	uint64_t last_drops;         /* drops of NIC at the last check */
+	uint8_t drops_sampled;       /* last_drops is valid */
+	uint8_t drops_over;          /* drops were over threshold */
+	uint8_t link_up;             /* link was up at the last check */
+};
+
+/* Capture filter given as tcpdump style expression */
+struct pcap_filter {
+	char expression[PCAP_FILTER_STRLEN]; /* expression, or empty */
+	struct bpf_program prog;     /* classic BPF compiled by libpcap */
+#ifdef PCAP_USE_RTE_BPF
+	struct rte_bpf *bpf;         /* eBPF converted from prog, or NULL */
+	uint64_t (*jit)(void *);     /* JIT-ed function of bpf, or NULL */
+#endif
+};
+
 /* Option for pcap. */
 struct pcap_option {
 	struct timespec start_time; /* start time */
+	uint64_t start_tsc;          /* TSC at start time */
+	enum pcap_file_format format; /* format of capture file */
 	uint64_t fsize_limit;        /* file size limit */
 	char compress_file_path[PCAP_FPATH_STRLEN]; /* file path */
 	char compress_file_date[PCAP_FDATE_STRLEN]; /* file name date */
-	struct spp_port_info port_cap;  /* capture port */
-	struct rte_ring *cap_ring;      /* RTE ring structure */
+	uint32_t file_date_seq;      /* suffix of date named in a second */
+	struct pcap_port_set port_set[2]; /* capture ports, double buffer */
+	volatile int ref_index;      /* index of port_set to be referred */
+	struct pcap_port_attr port_attr[RTE_MAX_ETHPORTS]; /* attributes */
+	int rx_threads;              /* num of receive threads */
+	struct pcap_filter filter;   /* capture filter */
+	volatile uint32_t snaplen;   /* max length of captured packets */
+	struct spp_pcap_codec_conf codec; /* codec of next capture */
+	uint64_t recorder_size;      /* memory of flight recorder, or 0 */
+	uint64_t recorder_time;      /* seconds to be dumped, 0 for all */
+	uint64_t trigger_drops;      /* drops per second to trigger dump */
+	int trigger_linkdown;        /* trigger dump if link goes down */
+	uint64_t rotate_interval;    /* seconds to rotate files, or 0 */
+	uint64_t max_files;          /* files kept per writer, or 0 */
+	uint64_t dir_quota;          /* bytes of files in out dir, or 0 */
+	int index;                   /* write index of capture files */
+};
+
+/* Index of capture file being written */
+struct pcap_index {
+	FILE *fp;               /* index file, or NULL if not indexed */
+	struct pcap_index_entry entry; /* entry of current chunk */
+	uint64_t chunk_len;     /* bytes of records compressed in chunk */
+	uint64_t size;          /* bytes written to index file */
+};
+
+/* Capture file completed and retained in output dir */
+struct pcap_retained_file {
+	char path[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN]; /* file path */
+	uint64_t size;          /* size of file */
+};
+
+/**
+ * Capture files completed by writer thread, in a ring from the oldest
+ * one. They are deleted from the oldest if over `--max-files` or the
+ * share of `--dir-quota` of the writer.
+ */
+struct pcap_retention {
+	struct pcap_retained_file *files; /* ring of files, or NULL */
+	size_t cap;             /* num of entries of files */
+	size_t head;            /* index of the oldest file */
+	size_t num;             /* num of files retained */
+	uint64_t bytes;         /* total size of files retained */
+	uint64_t quota;         /* share of dir quota of writer, or 0 */
+};
+
+/**
+ * Header of a packet kept in flight recorder, followed by packet data.
+ * Record of rec_len 0 means the rest of buffer is not used.
+ */
+struct recorder_record {
+	uint64_t time_ns;       /* time of day in nsec */
+	uint32_t rec_len;       /* length of record including padding */
+	uint32_t caplen;        /* length of packet data kept */
+	uint32_t len;           /* length of packet */
+	uint16_t port;          /* DPDK port ID of source port */
+	uint16_t reserved;      /* reserved */
+};
+
+/**
+ * Flight recorder of writer thread, which keeps copies of the latest
+ * packets in a ring buffer on hugepages and evicts the oldest ones if
+ * no room. Data at the end of buffer is not used if it is not enough for
+ * the next record, and it is counted in used until evicted.
+ */
+struct pcap_recorder {
+	char *buf;              /* ring buffer, or NULL if not recording */
+	size_t size;            /* size of buffer */
+	size_t head;            /* offset of the oldest record */
+	size_t tail;            /* offset of the next record */
+	size_t used;            /* bytes used by records */
+	uint64_t packets;       /* num of packets kept */
+	uint64_t dumps;         /* num of dumps completed */
+	uint32_t dump_gen;      /* generation of the last dump request */
+};
+
+/**
+ * Output file written in large blocks asynchronously. Compressed data is
+ * filled in current block while previous blocks are in flight.
+ */
+struct pcap_output_file {
+	int fd;                      /* file descriptor, or -1 if closed */
+	int direct;                  /* opened with O_DIRECT or not */
+	off_t offset;                /* file offset of current block */
+	int cur;                     /* index of current block */
+	size_t fill;                 /* length of data in current block */
+	char *blocks[PCAP_IO_BLOCK_NUM];       /* aligned blocks */
+	struct aiocb cbs[PCAP_IO_BLOCK_NUM];   /* control blocks of aio */
+	int in_flight[PCAP_IO_BLOCK_NUM];      /* block is being written */
+	uint64_t submit_tsc[PCAP_IO_BLOCK_NUM]; /* TSC at submission */
+	struct spp_pcap_write_stats stats;     /* statistics of writes */
 };
 
 /**
@@ -127,19 +383,36 @@ struct pcap_mng_info {
 	volatile enum worker_thread_type type; /* thread type */
 	enum spp_capture_status status; /* thread status */
 	int thread_no;                 /* thread no */
+	int worker_no;                 /* index among threads of the type */
 	int file_no;                   /* file no */
-	char compress_file_name[PCAP_FNAME_STRLEN]; /* lz4 file name */
-	LZ4F_compressionContext_t ctx; /* lz4 file Ccontext */
-	FILE *compress_fp;             /* lzf file pointer */
-	size_t outbuf_capacity;        /* compress date buffer size */
-	void *outbuff;                 /* compress date buffer */
+	char compress_file_name[PCAP_FNAME_STRLEN]; /* capture file name */
+	struct spp_pcap_codec codec;   /* compression stream */
+	struct pcap_output_file output; /* capture file to be written */
+	void *inbuff;                  /* staging buffer of pcap records */
+	size_t inbuf_len;              /* length of staged records */
 	uint64_t file_size;            /* file write size */
+	uint32_t snaplen;              /* snaplen of the file being written */
+	int ref_index;                 /* index of port_set in use */
+	int if_id[RTE_MAX_ETHPORTS];   /* pcapng interface ID, or -1 */
+	uint32_t num_if;               /* num of pcapng interfaces */
+	struct rte_ring *rings[RTE_MAX_LCORE]; /* rings to or from workers */
+	int num_ring;                  /* num of rings */
+	uint64_t rx_cnt;               /* num of packets received */
+	uint64_t drop_cnt;             /* num of packets dropped */
+	uint64_t port_rx[RTE_MAX_ETHPORTS];   /* num of received per port */
+	uint64_t port_drop[RTE_MAX_ETHPORTS]; /* num of dropped per port */
+	uint64_t filter_pass;          /* num of packets matched filter */
+	uint64_t filter_drop;          /* num of packets not matched */
+	struct pcap_recorder recorder; /* flight recorder */
+	uint64_t rotate_tsc;           /* TSC to rotate file by interval */
+	struct pcap_retention retention; /* capture files retained */
+	struct pcap_index index;       /* index of capture file */
 };
 
 /* Pcap status info. */
 struct pcap_status_info {
 	int thread_cnt;		/* thread count */
-	int start_up_cnt;	/* thread start up count */
+	rte_atomic32_t start_up_cnt;	/* thread start up count */
 };
 
 /* Logical core ID for main thread */
@@ -172,6 +445,9 @@ struct pcap_status_info g_pcap_thread_info;
 /* pcap total write packet count */
 static long long g_total_write[RTE_MAX_LCORE];
 
+/* Generation of dump request of flight recorders */
+static volatile uint32_t g_dump_gen;
+
 /* Print help message */
 static void
 usage(const char *progname)
@@ -179,14 +455,41 @@ usage(const char *progname)
 	RTE_LOG(INFO, SPP_PCAP, "Usage: %s [EAL args] --"
 		" --client-id CLIENT_ID"
 		" -s IPADDR:PORT"
-		" -c CAP_PORT"
+		" -c CAP_PORT[,CAP_PORT...]"
 		" [--out-dir OUTPUT_DIR]"
-		" [--fsize MAX_FILE_SIZE]\n"
+		" [--fsize MAX_FILE_SIZE]"
+		" [--format FORMAT]"
+		" [--rx-threads NUM]"
+		" [--filter EXPRESSION]"
+		" [--snaplen SNAPLEN]"
+		" [--codec CODEC]"
+		" [--recorder SIZE_MIB]"
+		" [--recorder-time SEC]"
+		" [--dump-on-drops NUM]"
+		" [--dump-on-linkdown]"
+		" [--rotate-interval SEC]"
+		" [--max-files NUM]"
+		" [--dir-quota BYTES]"
+		" [--index]\n"
 		" --client-id CLIENT_ID: My client ID\n"
 		" -s IPADDR:PORT: IP addr and sec port for spp-ctl\n"
-		" -c: Captured port (e.g. 'phy:0' or 'ring:1')\n"
+		" -c: Captured ports (e.g. 'phy:0' or 'phy:0,ring:1')\n"
 		" --out-dir: Output dir (Default is /tmp)\n"
 		" --fsize: Maximum captured file size (Default is 1GiB)\n"
+		" --format: 'pcap' or 'pcapng' (Default is pcap)\n"
+		" --rx-threads: Num of receive threads (Default is 1)\n"
+		" --filter: Capture filter in syntax of tcpdump\n"
+		" --snaplen: Max length of captured packet (Default is 65535)\n"
+		" --codec: 'none', 'lz4[:LEVEL]' or 'zstd[:LEVEL[:THREADS]]'"
+		" (Default is lz4)\n"
+		" --recorder: Keep packets in memory and dump on request\n"
+		" --recorder-time: Max age of packets dumped from memory\n"
+		" --dump-on-drops: Dump if NIC drops NUM packets in a second\n"
+		" --dump-on-linkdown: Dump if link of captured port goes down\n"
+		" --rotate-interval: Rotate files at every SEC of wall clock\n"
+		" --max-files: Max num of files kept for each writer\n"
+		" --dir-quota: Max total size of files in output dir\n"
+		" --index: Write index for seeking beside capture file\n"
 		, progname);
 }
 
@@ -254,47 +557,123 @@ parse_fsize(const char *fsize_str, uint64_t *fsize)
 	return SPP_RET_OK;
 }
 
-/* Parse `-c` option for captured port and get the port type and ID */
+/* Parse `--format` option and get the format of capture file */
 static int
-parse_captured_port(const char *port_str, enum port_type *iface_type,
-			int *iface_no)
+parse_format(const char *format_str, enum pcap_file_format *format)
 {
-	enum port_type type = UNDEF;
-	const char *no_str = NULL;
+	int cnt;
+
+	for (cnt = 0; PCAP_FILE_FORMAT_STRINGS[cnt][0] != '\0'; cnt++) {
+		if (strcmp(format_str, PCAP_FILE_FORMAT_STRINGS[cnt]) == 0) {
+			*format = cnt;
+			RTE_LOG(DEBUG, SPP_PCAP, "Set format = %s\n",
+					format_str);
+			return SPP_RET_OK;
+		}
+	}
+	return SPP_RET_NG;
+}
+
+/* Parse `--snaplen` option and get max length of captured packets */
+static int
+parse_snaplen(const char *snaplen_str, uint32_t *snaplen)
+{
+	unsigned long len = 0;
 	char *endptr = NULL;
 
-	/* Find out which type of interface from resource UID */
-	if (strncmp(port_str, SPP_IFTYPE_NIC_STR ":",
-			strlen(SPP_IFTYPE_NIC_STR)+1) == 0) {
-		/* NIC */
-		type = PHY;
-		no_str = &port_str[strlen(SPP_IFTYPE_NIC_STR)+1];
-	} else if (strncmp(port_str, SPP_IFTYPE_RING_STR ":",
-			strlen(SPP_IFTYPE_RING_STR)+1) == 0) {
-		/* RING */
-		type = RING;
-		no_str = &port_str[strlen(SPP_IFTYPE_RING_STR)+1];
-	} else {
-		/* OTHER */
-		RTE_LOG(ERR, SPP_PCAP, "The interface that does not suppor. "
-					"(port = %s)\n", port_str);
+	len = strtoul(snaplen_str, &endptr, 10);
+	if (unlikely(snaplen_str == endptr) || unlikely(*endptr != '\0'))
+		return SPP_RET_NG;
+
+	if (len == 0 || len > PCAP_SNAPLEN_MAX)
+		return SPP_RET_NG;
+
+	*snaplen = len;
+	RTE_LOG(DEBUG, SPP_PCAP, "Set snaplen = %u\n", *snaplen);
+	return SPP_RET_OK;
+}
+
+/* Parse option of unsigned integer and get the value */
+static int
+parse_uint64_value(const char *value_str, uint64_t *value)
+{
+	uint64_t val = 0;
+	char *endptr = NULL;
+
+	val = strtoull(value_str, &endptr, 10);
+	if (unlikely(value_str == endptr) || unlikely(*endptr != '\0'))
+		return SPP_RET_NG;
+
+	*value = val;
+	return SPP_RET_OK;
+}
+
+/* Parse `--rx-threads` option and get the num of receive threads */
+static int
+parse_rx_threads(const char *threads_str, int *rx_threads)
+{
+	int num = 0;
+	char *endptr = NULL;
+
+	num = strtol(threads_str, &endptr, 10);
+	if (unlikely(threads_str == endptr) || unlikely(*endptr != '\0'))
 		return SPP_RET_NG;
-	}
 
-	/* Convert from string to number */
-	int ret_no = strtol(no_str, &endptr, 0);
-	if (unlikely(no_str == endptr) || unlikely(*endptr != '\0')) {
-		/* No IF number */
-		RTE_LOG(ERR, SPP_PCAP, "No interface number. (port = %s)\n",
-								port_str);
+	if (num < 1 || num >= RTE_MAX_LCORE)
 		return SPP_RET_NG;
+
+	*rx_threads = num;
+	RTE_LOG(DEBUG, SPP_PCAP, "Set rx_threads = %d\n", *rx_threads);
+	return SPP_RET_OK;
+}
+
+/* Find capture port from the set and return its index, or -1 */
+static int
+find_capture_port(const struct pcap_port_set *set,
+		const struct spp_port_index *port)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < set->num; cnt++) {
+		if (set->ports[cnt].iface_type == port->iface_type &&
+				set->ports[cnt].iface_no == port->iface_no)
+			return cnt;
 	}
+	return -1;
+}
 
-	*iface_type = type;
-	*iface_no = ret_no;
+/* Parse `-c` option for captured ports separated with ',' */
+static int
+parse_captured_ports(char *ports_str, struct pcap_port_set *set)
+{
+	char *port_str = NULL;
+	char *saveptr = NULL;
+	struct spp_port_index port;
+
+	set->num = 0;
+	port_str = strtok_r(ports_str, ",", &saveptr);
+	while (port_str != NULL) {
+		if (set->num >= PCAP_CAP_PORT_MAX) {
+			RTE_LOG(ERR, SPP_PCAP, "Too many capture ports. "
+					"(max = %d)\n", PCAP_CAP_PORT_MAX);
+			return SPP_RET_NG;
+		}
+		if (spp_convert_port_to_iface(port_str, &port.iface_type,
+				&port.iface_no) != SPP_RET_OK)
+			return SPP_RET_NG;
+		if (find_capture_port(set, &port) >= 0) {
+			RTE_LOG(ERR, SPP_PCAP, "Duplicated capture port. "
+					"(port = %s)\n", port_str);
+			return SPP_RET_NG;
+		}
+		set->ports[set->num].iface_type = port.iface_type;
+		set->ports[set->num].iface_no = port.iface_no;
+		set->num++;
+		port_str = strtok_r(NULL, ",", &saveptr);
+	}
 
-	RTE_LOG(DEBUG, SPP_PCAP, "Port = %s => Type = %d No = %d\n",
-					port_str, *iface_type, *iface_no);
+	if (set->num == 0)
+		return SPP_RET_NG;
 	return SPP_RET_OK;
 }
 
@@ -306,11 +685,15 @@ parse_args(int argc, char *argv[])
 	int proc_flg = 0;
 	int server_flg = 0;
 	int port_flg = 0;
+	uint32_t snaplen;
+	char codec_str[SPP_PCAP_CODEC_STRLEN];
+	uint64_t recorder_mib = 0;
 	int option_index, opt;
 	const int argcopt = argc;
 	char *argvopt[argcopt];
 	const char *progname = argv[0];
-	char port_str[PORT_STR_SIZE];
+	char port_str[PORT_STR_SIZE * PCAP_CAP_PORT_MAX];
+	char ports_buf[PORT_STR_SIZE * PCAP_CAP_PORT_MAX];
 	static struct option lgopts[] = {
 		{ "client-id", required_argument, NULL,
 			SPP_LONGOPT_RETVAL_CLIENT_ID },
@@ -318,6 +701,32 @@ parse_args(int argc, char *argv[])
 			SPP_LONGOPT_RETVAL_OUT_DIR },
 		{ "fsize", required_argument, NULL,
 			SPP_LONGOPT_RETVAL_FILE_SIZE},
+		{ "format", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_FORMAT},
+		{ "rx-threads", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_RX_THREADS},
+		{ "filter", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_FILTER},
+		{ "snaplen", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_SNAPLEN},
+		{ "codec", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_CODEC},
+		{ "recorder", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_RECORDER},
+		{ "recorder-time", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_RECORDER_TIME},
+		{ "dump-on-drops", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_DUMP_ON_DROPS},
+		{ "dump-on-linkdown", no_argument, NULL,
+			SPP_LONGOPT_RETVAL_DUMP_ON_LINKDOWN},
+		{ "rotate-interval", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_ROTATE_INTERVAL},
+		{ "max-files", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_MAX_FILES},
+		{ "dir-quota", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_DIR_QUOTA},
+		{ "index", no_argument, NULL,
+			SPP_LONGOPT_RETVAL_INDEX},
 		{ 0 },
 	};
 	/**
@@ -334,6 +743,9 @@ parse_args(int argc, char *argv[])
 	memset(&g_pcap_option, 0x00, sizeof(g_pcap_option));
 	strcpy(g_pcap_option.compress_file_path, DEFAULT_OUTPUT_DIR);
 	g_pcap_option.fsize_limit = DEFAULT_FILE_LIMIT;
+	g_pcap_option.rx_threads = 1;
+	g_pcap_option.snaplen = PCAP_SNAPLEN_MAX;
+	g_pcap_option.codec.type = SPP_PCAP_CODEC_LZ4;
 
 	/* Check options of application */
 	optind = 0;
@@ -366,11 +778,104 @@ parse_args(int argc, char *argv[])
 				return SPP_RET_NG;
 			}
 			break;
-		case 'c':  /* captured port */
+		case SPP_LONGOPT_RETVAL_FORMAT:
+			if (parse_format(optarg, &g_pcap_option.format) !=
+					SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_RX_THREADS:
+			if (parse_rx_threads(optarg,
+					&g_pcap_option.rx_threads) !=
+					SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_FILTER:
+			if (strlen(optarg) >= PCAP_FILTER_STRLEN) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			strcpy(g_pcap_option.filter.expression, optarg);
+			break;
+		case SPP_LONGOPT_RETVAL_SNAPLEN:
+			if (parse_snaplen(optarg, &snaplen) != SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			g_pcap_option.snaplen = snaplen;
+			break;
+		case SPP_LONGOPT_RETVAL_CODEC:
+			if (spp_pcap_codec_parse(optarg,
+					&g_pcap_option.codec) != SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_RECORDER:
+			if (parse_uint64_value(optarg, &recorder_mib) !=
+					SPP_RET_OK || recorder_mib == 0) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			g_pcap_option.recorder_size = recorder_mib << 20;
+			break;
+		case SPP_LONGOPT_RETVAL_RECORDER_TIME:
+			if (parse_uint64_value(optarg,
+					&g_pcap_option.recorder_time) !=
+					SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_DUMP_ON_DROPS:
+			if (parse_uint64_value(optarg,
+					&g_pcap_option.trigger_drops) !=
+					SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_DUMP_ON_LINKDOWN:
+			g_pcap_option.trigger_linkdown = 1;
+			break;
+		case SPP_LONGOPT_RETVAL_ROTATE_INTERVAL:
+			if (parse_uint64_value(optarg,
+					&g_pcap_option.rotate_interval) !=
+					SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_MAX_FILES:
+			if (parse_uint64_value(optarg,
+					&g_pcap_option.max_files) !=
+					SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_DIR_QUOTA:
+			if (parse_fsize(optarg, &g_pcap_option.dir_quota) !=
+					SPP_RET_OK) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_INDEX:
+			g_pcap_option.index = 1;
+			break;
+		case 'c':  /* captured ports */
+			if (strlen(optarg) >= sizeof(port_str)) {
+				usage(progname);
+				return SPP_RET_NG;
+			}
 			strcpy(port_str, optarg);
-			if (parse_captured_port(optarg,
-					&g_pcap_option.port_cap.iface_type,
-					&g_pcap_option.port_cap.iface_no) !=
+			strcpy(ports_buf, optarg);
+			if (parse_captured_ports(ports_buf,
+					&g_pcap_option.port_set[0]) !=
 					SPP_RET_OK) {
 				usage(progname);
 				return SPP_RET_NG;
@@ -398,18 +903,86 @@ parse_args(int argc, char *argv[])
 		return SPP_RET_NG;
 	}
 
+	/* Triggers are only for flight recorder */
+	if (g_pcap_option.recorder_size == 0 &&
+			(g_pcap_option.recorder_time != 0 ||
+			g_pcap_option.trigger_drops != 0 ||
+			g_pcap_option.trigger_linkdown != 0)) {
+		usage(progname);
+		return SPP_RET_NG;
+	}
+
+	spp_pcap_codec_format(&g_pcap_option.codec, codec_str);
 	RTE_LOG(INFO, SPP_PCAP,
 			"App opts: '--client-id %d', '-s %s:%d', "
-			"'-c %s', '--out-dir %s', '--fsize %ld'\n",
+			"'-c %s', '--out-dir %s', '--fsize %ld', "
+			"'--format %s', '--rx-threads %d', '--filter %s', "
+			"'--snaplen %u', '--codec %s', '--recorder %lu', "
+			"'--recorder-time %lu', '--dump-on-drops %lu', "
+			"'--dump-on-linkdown %d', '--rotate-interval %lu', "
+			"'--max-files %lu', '--dir-quota %lu', "
+			"'--index %d'\n",
 			g_startup_param.client_id,
 			g_startup_param.server_ip,
 			g_startup_param.server_port,
 			port_str,
 			g_pcap_option.compress_file_path,
-			g_pcap_option.fsize_limit);
+			g_pcap_option.fsize_limit,
+			PCAP_FILE_FORMAT_STRINGS[g_pcap_option.format],
+			g_pcap_option.rx_threads,
+			g_pcap_option.filter.expression,
+			g_pcap_option.snaplen,
+			codec_str,
+			recorder_mib,
+			g_pcap_option.recorder_time,
+			g_pcap_option.trigger_drops,
+			g_pcap_option.trigger_linkdown,
+			g_pcap_option.rotate_interval,
+			g_pcap_option.max_files,
+			g_pcap_option.dir_quota,
+			g_pcap_option.index);
 	return SPP_RET_OK;
 }
 
+/**
+ * Number RX queues of the capture port added at the end of the set
+ * following the last one, so that they are assigned to receive threads
+ * in turn.
+ */
+static void
+number_port_queues(struct pcap_port_set *set, int idx)
+{
+	const struct pcap_port_attr *attr = g_pcap_option.port_attr;
+
+	if (idx == 0) {
+		set->first_item[idx] = 0;
+		return;
+	}
+	set->first_item[idx] = set->first_item[idx - 1] +
+			attr[set->ports[idx - 1].dpdk_port].nb_rx_queues;
+}
+
+/**
+ * Return true if receive thread polls any of RX queues of the capture port.
+ * Each of RX queues is assigned to receive thread by its number.
+ */
+static int
+is_polled_port(const struct pcap_mng_info *info,
+		const struct pcap_port_set *set, int idx)
+{
+	const struct pcap_port_attr *attr = g_pcap_option.port_attr;
+	uint32_t item = set->first_item[idx];
+	uint16_t queue;
+
+	for (queue = 0; queue < attr[set->ports[idx].dpdk_port].nb_rx_queues;
+			queue++) {
+		if ((item + queue) % g_pcap_option.rx_threads ==
+				(uint32_t)info->worker_no)
+			return 1;
+	}
+	return 0;
+}
+
 /* Pcap get core status */
 int
 spp_pcap_get_core_status(
@@ -419,21 +992,29 @@ spp_pcap_get_core_status(
 	int ret = SPP_RET_NG;
 	char role_type[8];
 	struct pcap_mng_info *info = &g_pcap_info[lcore_id];
-	char name[PCAP_FPATH_STRLEN + PCAP_FDATE_STRLEN];
-	struct spp_port_index rx_ports[1];
+	char name[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN];
+	struct spp_port_index rx_ports[PCAP_CAP_PORT_MAX];
+	struct pcap_port_set *set;
 	int rx_num = 0;
+	int cnt;
 
 	RTE_LOG(DEBUG, SPP_PCAP, "status core[%d]\n", lcore_id);
 	if (info->type == PCAP_RECEIVE) {
 		memset(rx_ports, 0x00, sizeof(rx_ports));
-		rx_ports[0].iface_type = g_pcap_option.port_cap.iface_type;
-		rx_ports[0].iface_no   = g_pcap_option.port_cap.iface_no;
-		rx_num = 1;
+		set = &g_pcap_option.port_set[g_pcap_option.ref_index];
+		for (cnt = 0; cnt < set->num; cnt++) {
+			if (!is_polled_port(info, set, cnt))
+				continue;
+			rx_ports[rx_num].iface_type =
+					set->ports[cnt].iface_type;
+			rx_ports[rx_num].iface_no = set->ports[cnt].iface_no;
+			rx_num++;
+		}
 		strcpy(role_type, "receive");
 	}
 	if (info->type == PCAP_WRITE) {
 		memset(name, 0x00, sizeof(name));
-		if (info->compress_fp != NULL)
+		if (info->output.fd >= 0)
 			snprintf(name, sizeof(name) - 1, "%s/%s",
 					g_pcap_option.compress_file_path,
 					info->compress_file_name);
@@ -452,105 +1033,1142 @@ spp_pcap_get_core_status(
 	return SPP_RET_OK;
 }
 
-/* write compressed data into file  */
-static int output_pcap_file(FILE *compress_fp, void *srcbuf, size_t write_len)
+/* Get statistics of file writes of writer thread */
+int
+spp_pcap_get_write_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_write_stats *stats)
 {
-	size_t write_size;
+	if (g_pcap_info[lcore_id].type != PCAP_WRITE)
+		return SPP_RET_NG;
 
-	if (write_len == 0)
-		return SPP_RET_OK;
-	write_size = fwrite(srcbuf, write_len, 1, compress_fp);
-	if (write_size != 1) {
-		RTE_LOG(ERR, SPP_PCAP, "file write error len=%lu\n",
-								write_len);
+	*stats = g_pcap_info[lcore_id].output.stats;
+	return SPP_RET_OK;
+}
+
+/* Get counters of capture filter of receive thread */
+int
+spp_pcap_get_filter_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_filter_stats *stats)
+{
+	if (g_pcap_info[lcore_id].type != PCAP_RECEIVE ||
+			g_pcap_option.filter.expression[0] == '\0')
+		return SPP_RET_NG;
+
+	stats->expression = g_pcap_option.filter.expression;
+	stats->pass = g_pcap_info[lcore_id].filter_pass;
+	stats->drop = g_pcap_info[lcore_id].filter_drop;
+	return SPP_RET_OK;
+}
+
+/* Set snaplen of capture files */
+int
+spp_pcap_set_snaplen(uint32_t snaplen)
+{
+	if (snaplen == 0 || snaplen > PCAP_SNAPLEN_MAX) {
+		RTE_LOG(ERR, SPP_PCAP, "Invalid snaplen. (snaplen = %u)\n",
+				snaplen);
 		return SPP_RET_NG;
 	}
+
+	/* Writers start new files if snaplen is changed while capturing */
+	g_pcap_option.snaplen = snaplen;
+	RTE_LOG(INFO, SPP_PCAP, "Snaplen is set to %u.\n", snaplen);
 	return SPP_RET_OK;
 }
 
-/* compress data & write file */
-static int output_lz4_pcap_file(struct pcap_mng_info *info,
-			       void *srcbuf,
-			       int src_len)
+/* Get snaplen of capture files */
+uint32_t
+spp_pcap_get_snaplen(void)
+{
+	return g_pcap_option.snaplen;
+}
+
+/* Set codec of capture files */
+int
+spp_pcap_set_codec(const struct spp_pcap_codec_conf *conf)
 {
-	size_t compress_len;
+	char codec_str[SPP_PCAP_CODEC_STRLEN];
 
-	compress_len = LZ4F_compressUpdate(info->ctx, info->outbuff,
-				info->outbuf_capacity, srcbuf, src_len, NULL);
-	if (LZ4F_isError(compress_len)) {
-		RTE_LOG(ERR, SPP_PCAP, "Compression failed: error %zd\n",
-							compress_len);
+	/* Writers refer to it only when capture is started */
+	if (g_capture_request != SPP_CAPTURE_IDLE ||
+			g_capture_status != SPP_CAPTURE_IDLE) {
+		RTE_LOG(ERR, SPP_PCAP,
+				"Codec cannot be changed while capturing.\n");
 		return SPP_RET_NG;
 	}
-	RTE_LOG(DEBUG, SPP_PCAP, "src len=%d\n", src_len);
-	if (output_pcap_file(info->compress_fp, info->outbuff,
-						compress_len) != 0)
+
+	g_pcap_option.codec = *conf;
+	spp_pcap_codec_format(conf, codec_str);
+	RTE_LOG(INFO, SPP_PCAP, "Codec is set to %s.\n", codec_str);
+	return SPP_RET_OK;
+}
+
+/* Get codec of capture files */
+void
+spp_pcap_get_codec(struct spp_pcap_codec_conf *conf)
+{
+	*conf = g_pcap_option.codec;
+}
+
+/* Get statistics of compression of writer thread */
+int
+spp_pcap_get_codec_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_codec_conf *conf,
+		struct spp_pcap_codec_stats *stats)
+{
+	if (g_pcap_info[lcore_id].type != PCAP_WRITE)
 		return SPP_RET_NG;
 
+	*conf = g_pcap_info[lcore_id].codec.conf;
+	*stats = g_pcap_info[lcore_id].codec.stats;
 	return SPP_RET_OK;
 }
 
 /**
- * File compression operation. There are three mode.
- * Open and update and close.
+ * Set date in names of capture files to the given time. Suffix such as
+ * '-1' is added if files are named again in the same second, so that
+ * files of capture and dumps of flight recorder are not overwritten.
  */
-static int file_compression_operation(struct pcap_mng_info *info,
-				   enum comp_file_generate_mode mode)
+static void set_file_date(const struct timespec *time)
 {
-	struct pcap_header pcap_h;
-	size_t ctxCreation;
-	size_t headerSize;
-	size_t compress_len;
-	char temp_file[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN];
-	char save_file[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN];
-	const char *iface_type_str;
+	char *cur = g_pcap_option.compress_file_date;
+	char date[PCAP_FDATE_STRLEN];
+	struct tm l_time;
+	size_t len;
+
+	memset(date, 0, sizeof(date));
+	localtime_r(&time->tv_sec, &l_time);
+	len = strftime(date, sizeof(date), "%Y%m%d%H%M%S", &l_time);
+	if (strncmp(date, cur, len) == 0 &&
+			(cur[len] == '\0' || cur[len] == '-')) {
+		g_pcap_option.file_date_seq++;
+		snprintf(&date[len], sizeof(date) - len, "-%u",
+				g_pcap_option.file_date_seq);
+	} else {
+		g_pcap_option.file_date_seq = 0;
+	}
+	strcpy(cur, date);
+}
 
-	if (mode == INIT_MODE) { /* initial generation mode */
-		/* write buffer size get */
-		info->outbuf_capacity = LZ4F_compressBound(IN_CHUNK_SIZE,
-								&g_kprefs);
-		/* write buff allocation */
-		info->outbuff = malloc(info->outbuf_capacity);
+/* Request writers to dump packets kept in flight recorders */
+int
+spp_pcap_request_dump(void)
+{
+	unsigned int lcore_id;
+	struct timespec cur_time;
 
-		/* Initialize pcap file name */
-		info->file_size = 0;
-		info->file_no = 1;
-		if (g_pcap_option.port_cap.iface_type == PHY)
-			iface_type_str = SPP_IFTYPE_NIC_STR;
-		else
-			iface_type_str = SPP_IFTYPE_RING_STR;
-		snprintf(info->compress_file_name,
-					PCAP_FNAME_STRLEN - 1,
-					"spp_pcap.%s.%s%d.%u.%u.pcap.lz4",
-					g_pcap_option.compress_file_date,
-					iface_type_str,
-					g_pcap_option.port_cap.iface_no,
-					info->thread_no,
-					info->file_no);
-	} else if (mode == UPDATE_MODE) { /* update generation mode */
-		/* old compress file close */
-		/* flush whatever remains within internal buffers */
-		compress_len = LZ4F_compressEnd(info->ctx, info->outbuff,
-					info->outbuf_capacity, NULL);
-		if (LZ4F_isError(compress_len)) {
-			RTE_LOG(ERR, SPP_PCAP, "Failed to end compression: "
-					"error %zd\n", compress_len);
-			fclose(info->compress_fp);
-			info->compress_fp = NULL;
-			free(info->outbuff);
-			return SPP_RET_NG;
-		}
-		if (output_pcap_file(info->compress_fp, info->outbuff,
-						compress_len) != SPP_RET_OK) {
-			fclose(info->compress_fp);
-			info->compress_fp = NULL;
-			free(info->outbuff);
+	if (g_pcap_option.recorder_size == 0) {
+		RTE_LOG(ERR, SPP_PCAP, "Flight recorder is not enabled.\n");
+		return SPP_RET_NG;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_pcap_info[lcore_id].type == PCAP_WRITE &&
+				g_pcap_info[lcore_id].recorder.dump_gen !=
+				g_dump_gen) {
+			RTE_LOG(ERR, SPP_PCAP,
+					"Previous dump is not completed.\n");
+			return SPP_RET_NG;
+		}
+	}
+
+	/* Files of dump are named with the time of request */
+	clock_gettime(CLOCK_REALTIME, &cur_time);
+	set_file_date(&cur_time);
+	rte_wmb();
+	g_dump_gen++;
+	RTE_LOG(INFO, SPP_PCAP, "Dump of flight recorder is requested.\n");
+	return SPP_RET_OK;
+}
+
+/* Get statistics of flight recorder of writer thread */
+int
+spp_pcap_get_recorder_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_recorder_stats *stats)
+{
+	const struct pcap_recorder *rec = &g_pcap_info[lcore_id].recorder;
+
+	if (g_pcap_info[lcore_id].type != PCAP_WRITE || rec->buf == NULL)
+		return SPP_RET_NG;
+
+	stats->size = rec->size;
+	stats->used = rec->used;
+	stats->packets = rec->packets;
+	stats->dumps = rec->dumps;
+	return SPP_RET_OK;
+}
+
+/**
+ * Get frequency of the clock of NIC if it stamps received packets, or
+ * return 0. Timestamp offload is enabled by primary process, so it is only
+ * checked here. Frequency is measured with TSC because it is not provided
+ * by ethdev.
+ */
+static uint64_t get_nic_clock_hz(const struct spp_port_info *port)
+{
+#if RTE_VERSION >= RTE_VERSION_NUM(19, 8, 0, 0)
+	struct rte_eth_rxq_info qinfo;
+	uint64_t clk1, clk2;
+	uint64_t tsc1, tsc2;
+
+	if (port->iface_type != PHY)
+		return 0;
+
+	if (rte_eth_rx_queue_info_get(port->dpdk_port, 0, &qinfo) != 0 ||
+			!(qinfo.conf.offloads & DEV_RX_OFFLOAD_TIMESTAMP))
+		return 0;
+
+	tsc1 = rte_rdtsc();
+	if (rte_eth_read_clock(port->dpdk_port, &clk1) != 0)
+		return 0;
+	rte_delay_ms(NIC_CLOCK_MEASURE_MS);
+	tsc2 = rte_rdtsc();
+	if (rte_eth_read_clock(port->dpdk_port, &clk2) != 0)
+		return 0;
+
+	return (clk2 - clk1) * rte_get_tsc_hz() / (tsc2 - tsc1);
+#else
+	RTE_SET_USED(port);
+	return 0;
+#endif
+}
+
+/**
+ * Read clock of NIC with TSC at the same time as the base for converting
+ * timestamp of packets given by NIC.
+ */
+static void init_port_clock(const struct spp_port_info *port)
+{
+	struct pcap_port_attr *attr = &g_pcap_option.port_attr[port->dpdk_port];
+
+	if (attr->nic_clock_hz == 0)
+		return;
+#if RTE_VERSION >= RTE_VERSION_NUM(19, 8, 0, 0)
+	attr->base_tsc = rte_rdtsc();
+	rte_eth_read_clock(port->dpdk_port, &attr->base_nic_clock);
+#endif
+}
+
+/**
+ * Get DPDK port ID of capture port of given type and number, and set up
+ * attributes of the port. Ring PMD is created if it is not added yet.
+ */
+static int setup_capture_port(struct spp_port_info *port_cap)
+{
+	int ret;
+	struct pcap_port_attr *attr;
+	struct rte_eth_dev_info dev_info;
+	struct spp_port_info *port_info = get_iface_info(
+					port_cap->iface_type,
+					port_cap->iface_no);
+	if (port_info == NULL) {
+		RTE_LOG(ERR, SPP_PCAP, "caputre port undefined.\n");
+		return SPP_RET_NG;
+	}
+	if (port_cap->iface_type == PHY) {
+		if (port_info->iface_type == UNDEF) {
+			RTE_LOG(ERR, SPP_PCAP,
+				"caputre port undefined.(phy:%d)\n",
+						port_cap->iface_no);
+			return SPP_RET_NG;
+		}
+	} else if (port_info->iface_type == UNDEF) {
+		ret = add_ring_pmd(port_info->iface_no);
+		if (ret == SPP_RET_NG) {
+			RTE_LOG(ERR, SPP_PCAP, "caputre port "
+				"undefined.(ring:%d)\n",
+				port_cap->iface_no);
+			return SPP_RET_NG;
+		}
+		/* Ring PMD is kept to be reused after the port is deleted */
+		port_info->iface_type = RING;
+		port_info->dpdk_port = ret;
+	}
+	port_cap->dpdk_port = port_info->dpdk_port;
+	RTE_LOG(DEBUG, SPP_PCAP,
+			"Recv port type=%d, no=%d, port_id=%d\n",
+			port_cap->iface_type, port_cap->iface_no,
+			port_cap->dpdk_port);
+
+	/* Use timestamp of NIC if it is enabled for the port */
+	attr = &g_pcap_option.port_attr[port_cap->dpdk_port];
+	spp_format_port_string(attr->name, port_cap->iface_type,
+			port_cap->iface_no);
+	attr->nic_clock_hz = get_nic_clock_hz(port_cap);
+	RTE_LOG(INFO, SPP_PCAP, "Timestamp of packets from %s is by %s.\n",
+			attr->name, attr->nic_clock_hz != 0 ? "NIC" : "TSC");
+	init_port_clock(port_cap);
+
+	/* All of RX queues configured by primary are polled */
+	rte_eth_dev_info_get(port_cap->dpdk_port, &dev_info);
+	attr->nb_rx_queues = RTE_MAX(dev_info.nb_rx_queues, (uint16_t)1);
+	RTE_LOG(DEBUG, SPP_PCAP, "Num of RX queues of %s is %u.\n",
+			attr->name, attr->nb_rx_queues);
+	return SPP_RET_OK;
+}
+
+/* Release programs of capture filter */
+static void release_capture_filter(void)
+{
+	struct pcap_filter *filter = &g_pcap_option.filter;
+
+#ifdef PCAP_USE_RTE_BPF
+	if (filter->bpf != NULL)
+		rte_bpf_destroy(filter->bpf);
+	filter->bpf = NULL;
+	filter->jit = NULL;
+#endif
+	pcap_freecode(&filter->prog);
+}
+
+/**
+ * Compile capture filter given as `--filter` option to classic BPF, and
+ * convert it to eBPF to be JIT-ed if librte_bpf supports it. Programs of
+ * previous filter are released before.
+ */
+static int setup_capture_filter(void)
+{
+	struct pcap_filter *filter = &g_pcap_option.filter;
+	const char *engine = "libpcap";
+	pcap_t *pcap;
+#ifdef PCAP_USE_RTE_BPF
+	struct rte_bpf_prm *prm;
+	struct rte_bpf_jit jit;
+#endif
+
+	release_capture_filter();
+	if (filter->expression[0] == '\0')
+		return SPP_RET_OK;
+
+	pcap = pcap_open_dead(DLT_EN10MB, PCAP_SNAPLEN_MAX);
+	if (pcap == NULL) {
+		RTE_LOG(ERR, SPP_PCAP, "Cannot compile capture filter.\n");
+		return SPP_RET_NG;
+	}
+	if (pcap_compile(pcap, &filter->prog, filter->expression, 1,
+			PCAP_NETMASK_UNKNOWN) != 0) {
+		RTE_LOG(ERR, SPP_PCAP, "Invalid capture filter '%s' (%s).\n",
+				filter->expression, pcap_geterr(pcap));
+		pcap_close(pcap);
+		return SPP_RET_NG;
+	}
+	pcap_close(pcap);
+
+#ifdef PCAP_USE_RTE_BPF
+	prm = rte_bpf_convert(&filter->prog);
+	if (prm != NULL) {
+		filter->bpf = rte_bpf_load(prm);
+		rte_free(prm);
+	}
+	if (filter->bpf != NULL) {
+		engine = "rte_bpf";
+		if (rte_bpf_get_jit(filter->bpf, &jit) == 0 &&
+				jit.func != NULL) {
+			filter->jit = jit.func;
+			engine = "rte_bpf JIT";
+		}
+	}
+#endif
+	RTE_LOG(INFO, SPP_PCAP, "Capture filter '%s' is evaluated by %s.\n",
+			filter->expression, engine);
+	return SPP_RET_OK;
+}
+
+/**
+ * Wait for receive threads to refer to the set of ports updated, so that
+ * the other set is not referred while it is updated next time.
+ */
+static void wait_port_set_update(int ref_index)
+{
+	unsigned int lcore_id;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_pcap_info[lcore_id].type != PCAP_RECEIVE)
+			continue;
+		while (g_pcap_info[lcore_id].ref_index != ref_index &&
+				spp_get_core_status(lcore_id) !=
+				SPP_CORE_STOP)
+			usleep(10);
+	}
+}
+
+/* Update capture ports */
+int
+spp_pcap_update_port(
+		enum spp_command_action action,
+		const struct spp_port_index *port)
+{
+	int upd_index = g_pcap_option.ref_index ^ 1;
+	struct pcap_port_set *set = &g_pcap_option.port_set[upd_index];
+	char port_str[PORT_STR_SIZE];
+	int idx;
+
+	*set = g_pcap_option.port_set[g_pcap_option.ref_index];
+	idx = find_capture_port(set, port);
+	spp_format_port_string(port_str, port->iface_type, port->iface_no);
+
+	if (action == SPP_CMD_ACTION_ADD) {
+		if (idx >= 0 || set->num >= PCAP_CAP_PORT_MAX) {
+			RTE_LOG(ERR, SPP_PCAP, "Cannot add capture port. "
+					"(port = %s)\n", port_str);
+			return SPP_RET_NG;
+		}
+		memset(&set->ports[set->num], 0x00,
+				sizeof(set->ports[set->num]));
+		set->ports[set->num].iface_type = port->iface_type;
+		set->ports[set->num].iface_no = port->iface_no;
+		if (setup_capture_port(&set->ports[set->num]) != SPP_RET_OK)
+			return SPP_RET_NG;
+		number_port_queues(set, set->num);
+		set->num++;
+	} else {
+		/* At least one port is required for naming files */
+		if (idx < 0 || set->num == 1) {
+			RTE_LOG(ERR, SPP_PCAP, "Cannot delete capture port. "
+					"(port = %s)\n", port_str);
+			return SPP_RET_NG;
+		}
+		set->num--;
+		memmove(&set->ports[idx], &set->ports[idx + 1],
+				sizeof(set->ports[0]) * (set->num - idx));
+		memmove(&set->first_item[idx], &set->first_item[idx + 1],
+				sizeof(set->first_item[0]) * (set->num - idx));
+	}
+
+	rte_wmb();
+	g_pcap_option.ref_index = upd_index;
+	wait_port_set_update(upd_index);
+	RTE_LOG(INFO, SPP_PCAP, "Capture port %s is %s.\n", port_str,
+			action == SPP_CMD_ACTION_ADD ? "added" : "deleted");
+	return SPP_RET_OK;
+}
+
+/* Reap a write of block in flight and update statistics of writer */
+static int reap_output_block(struct pcap_output_file *out, int idx, int wait)
+{
+	const struct aiocb *cbs[1];
+	struct aiocb *cb = &out->cbs[idx];
+	uint64_t latency;
+	ssize_t written;
+	int err;
+
+	if (!out->in_flight[idx])
+		return SPP_RET_OK;
+
+	cbs[0] = cb;
+	while ((err = aio_error(cb)) == EINPROGRESS) {
+		if (!wait)
+			return SPP_RET_OK;
+		aio_suspend(cbs, 1, NULL);
+	}
+	written = aio_return(cb);
+	out->in_flight[idx] = 0;
+	out->stats.queue_depth--;
+
+	latency = (rte_rdtsc() - out->submit_tsc[idx]) * US_PER_S /
+			rte_get_tsc_hz();
+	out->stats.writes++;
+	out->stats.latency_total += latency;
+	if (latency > out->stats.latency_max)
+		out->stats.latency_max = latency;
+
+	if (err != 0 || written != (ssize_t)cb->aio_nbytes) {
+		RTE_LOG(ERR, SPP_PCAP, "file write error len=%zu (%s)\n",
+				cb->aio_nbytes, strerror(err));
+		return SPP_RET_NG;
+	}
+	return SPP_RET_OK;
+}
+
+/* Reap writes of all blocks in flight, or only completed ones */
+static int reap_output_blocks(struct pcap_output_file *out, int wait)
+{
+	int ret = SPP_RET_OK;
+	int idx;
+
+	for (idx = 0; idx < PCAP_IO_BLOCK_NUM; idx++) {
+		if (reap_output_block(out, idx, wait) != SPP_RET_OK)
+			ret = SPP_RET_NG;
+	}
+	return ret;
+}
+
+/**
+ * Submit current block to be written asynchronously and move to next one.
+ * Writer is stalled only if next block is still in flight.
+ */
+static int submit_output_block(struct pcap_output_file *out)
+{
+	struct aiocb *cb = &out->cbs[out->cur];
+
+	/* update statistics with blocks completed so far */
+	if (reap_output_blocks(out, 0) != SPP_RET_OK)
+		return SPP_RET_NG;
+
+	memset(cb, 0, sizeof(*cb));
+	cb->aio_fildes = out->fd;
+	cb->aio_buf = out->blocks[out->cur];
+	cb->aio_nbytes = out->fill;
+	cb->aio_offset = out->offset;
+	out->submit_tsc[out->cur] = rte_rdtsc();
+	if (aio_write(cb) != 0) {
+		RTE_LOG(ERR, SPP_PCAP, "aio_write error len=%zu (%s)\n",
+				out->fill, strerror(errno));
+		return SPP_RET_NG;
+	}
+	out->in_flight[out->cur] = 1;
+	out->offset += out->fill;
+	out->stats.queue_depth++;
+	if (out->stats.queue_depth > out->stats.queue_depth_max)
+		out->stats.queue_depth_max = out->stats.queue_depth;
+
+	out->cur = (out->cur + 1) % PCAP_IO_BLOCK_NUM;
+	out->fill = 0;
+	if (out->in_flight[out->cur]) {
+		out->stats.stalls++;
+		return reap_output_block(out, out->cur, 1);
+	}
+	return SPP_RET_OK;
+}
+
+/* write compressed data into file  */
+static int output_pcap_file(struct pcap_output_file *out,
+			    void *srcbuf, size_t write_len)
+{
+	const char *src = srcbuf;
+	size_t len;
+
+	while (write_len > 0) {
+		len = RTE_MIN(write_len, PCAP_IO_BLOCK_SIZE - out->fill);
+		rte_memcpy(out->blocks[out->cur] + out->fill, src, len);
+		out->fill += len;
+		src += len;
+		write_len -= len;
+		if (out->fill == PCAP_IO_BLOCK_SIZE &&
+				submit_output_block(out) != SPP_RET_OK)
+			return SPP_RET_NG;
+	}
+	return SPP_RET_OK;
+}
+
+/**
+ * Open file for output with O_DIRECT. It is opened without O_DIRECT if
+ * not supported by the file system, for example tmpfs.
+ */
+static int open_output_file(struct pcap_output_file *out, const char *path)
+{
+	out->direct = 1;
+	out->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+	if (out->fd < 0 && errno == EINVAL) {
+		RTE_LOG(DEBUG, SPP_PCAP, "O_DIRECT not supported on %s\n",
+				path);
+		out->direct = 0;
+		out->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	if (out->fd < 0)
+		return SPP_RET_NG;
+
+	out->offset = 0;
+	out->cur = 0;
+	out->fill = 0;
+	return SPP_RET_OK;
+}
+
+/**
+ * Wait for all blocks in flight and write the rest of data, then close
+ * the file. The rest is written without O_DIRECT because its length is
+ * not aligned to the block size of device.
+ */
+static int close_output_file(struct pcap_output_file *out)
+{
+	int ret;
+	int flags;
+
+	if (out->fd < 0)
+		return SPP_RET_OK;
+
+	ret = reap_output_blocks(out, 1);
+	if (out->fill != 0) {
+		if (out->direct) {
+			flags = fcntl(out->fd, F_GETFL);
+			fcntl(out->fd, F_SETFL, flags & ~O_DIRECT);
+		}
+		if (pwrite(out->fd, out->blocks[out->cur], out->fill,
+				out->offset) != (ssize_t)out->fill) {
+			RTE_LOG(ERR, SPP_PCAP, "file write error len=%zu "
+					"(%s)\n", out->fill, strerror(errno));
+			ret = SPP_RET_NG;
+		}
+		out->offset += out->fill;
+		out->fill = 0;
+	}
+	close(out->fd);
+	out->fd = -1;
+	return ret;
+}
+
+/* allocate blocks aligned for O_DIRECT */
+static int alloc_output_blocks(struct pcap_output_file *out)
+{
+	int idx;
+
+	for (idx = 0; idx < PCAP_IO_BLOCK_NUM; idx++) {
+		if (posix_memalign((void **)&out->blocks[idx],
+				PCAP_IO_ALIGN, PCAP_IO_BLOCK_SIZE) != 0) {
+			out->blocks[idx] = NULL;
+			return SPP_RET_NG;
+		}
+	}
+	return SPP_RET_OK;
+}
+
+/* free buffers for compression */
+static void free_compress_buffer(struct pcap_mng_info *info)
+{
+	int idx;
+
+	spp_pcap_codec_free(&info->codec);
+	if (info->index.fp != NULL) {
+		/* index of the file not completed is left as temporary */
+		fclose(info->index.fp);
+		info->index.fp = NULL;
+	}
+	free(info->inbuff);
+	info->inbuff = NULL;
+	info->inbuf_len = 0;
+	for (idx = 0; idx < PCAP_IO_BLOCK_NUM; idx++) {
+		free(info->output.blocks[idx]);
+		info->output.blocks[idx] = NULL;
+	}
+}
+
+/* write compressed data given by codec into file */
+static int write_codec_data(void *arg, void *buf, size_t len)
+{
+	return output_pcap_file(arg, buf, len);
+}
+
+/* compress data & write file */
+static int output_compressed_pcap_file(struct pcap_mng_info *info,
+			       void *srcbuf,
+			       int src_len)
+{
+	RTE_LOG(DEBUG, SPP_PCAP, "src len=%d\n", src_len);
+	return spp_pcap_codec_compress(&info->codec, srcbuf, src_len);
+}
+
+/* Return offset of the end of data given to capture file */
+static inline uint64_t
+get_output_position(const struct pcap_output_file *out)
+{
+	return out->offset + out->fill;
+}
+
+/**
+ * Write the entry of current chunk to index if it has any of packets or
+ * interfaces, and start the entry of the next chunk.
+ */
+static int write_index_entry(struct pcap_mng_info *info)
+{
+	struct pcap_index *idx = &info->index;
+	uint64_t pos = get_output_position(&info->output);
+
+	idx->entry.length = pos - idx->entry.offset;
+	if (idx->entry.packets != 0 || idx->entry.flags != 0) {
+		if (fwrite(&idx->entry, sizeof(idx->entry), 1, idx->fp) != 1) {
+			RTE_LOG(ERR, SPP_PCAP, "index write error (%s)\n",
+					strerror(errno));
+			return SPP_RET_NG;
+		}
+		idx->size += sizeof(idx->entry);
+	}
+
+	memset(&idx->entry, 0, sizeof(idx->entry));
+	idx->entry.offset = pos;
+	idx->chunk_len = 0;
+	return SPP_RET_OK;
+}
+
+/**
+ * End the chunk of index at the boundary of frames of codec, so that
+ * a reader can decompress each of chunks without the preceding ones.
+ */
+static int end_index_chunk(struct pcap_mng_info *info)
+{
+	if (spp_pcap_codec_restart(&info->codec) != SPP_RET_OK)
+		return SPP_RET_NG;
+	return write_index_entry(info);
+}
+
+/* compress pcap records in staging buffer at once & write file */
+static int flush_staging_buffer(struct pcap_mng_info *info)
+{
+	int ret;
+
+	if (info->inbuf_len == 0)
+		return SPP_RET_OK;
+
+	ret = output_compressed_pcap_file(info, info->inbuff, info->inbuf_len);
+	info->index.chunk_len += info->inbuf_len;
+	info->inbuf_len = 0;
+	if (ret == SPP_RET_OK && info->index.fp != NULL &&
+			info->index.chunk_len >= PCAP_INDEX_CHUNK_SIZE)
+		ret = end_index_chunk(info);
+	return ret;
+}
+
+/* Append an option of pcapng with padding and return its length */
+static size_t append_pcapng_option(char *buf, uint16_t code,
+		const void *value, uint16_t len)
+{
+	struct pcapng_option_header opt_h;
+	size_t padded_len = RTE_ALIGN_CEIL(len, 4);
+
+	opt_h.code = code;
+	opt_h.length = len;
+	memcpy(buf, &opt_h, sizeof(opt_h));
+	if (len != 0)
+		memcpy(buf + sizeof(opt_h), value, len);
+	memset(buf + sizeof(opt_h) + len, 0, padded_len - len);
+	return sizeof(opt_h) + padded_len;
+}
+
+/* Terminate a block of pcapng with its length and return the length */
+static uint32_t close_pcapng_block(char *block, size_t len)
+{
+	uint32_t block_len = len + sizeof(uint32_t);
+
+	/* block length is placed after block type */
+	memcpy(block + sizeof(uint32_t), &block_len, sizeof(block_len));
+	memcpy(block + len, &block_len, sizeof(block_len));
+	return block_len;
+}
+
+/* Split timestamp of nanosecond into two of 32 bits for pcapng */
+static void set_pcapng_timestamp(const struct timespec *ts,
+		uint32_t *ts_high, uint32_t *ts_low)
+{
+	uint64_t nsec = (uint64_t)ts->tv_sec * NS_PER_S + ts->tv_nsec;
+
+	*ts_high = (uint32_t)(nsec >> 32);
+	*ts_low = (uint32_t)nsec;
+}
+
+/**
+ * Write section header block of pcapng. Interface description blocks are
+ * staged for each of ports at the first packet from the port, so that
+ * ports added while capturing are also described.
+ */
+static int write_pcapng_header(struct pcap_mng_info *info)
+{
+	char buf[PCAPNG_BLOCK_BUF_SIZE];
+	size_t len = 0;
+	int port;
+	struct pcapng_section_header shb;
+
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++)
+		info->if_id[port] = -1;
+	info->num_if = 0;
+
+	shb.block_type = PCAPNG_BLOCK_SHB;
+	shb.byte_order_magic = PCAPNG_BYTE_ORDER_MAGIC;
+	shb.version_major = PCAPNG_VERSION_MAJOR;
+	shb.version_minor = PCAPNG_VERSION_MINOR;
+	shb.section_length = -1;
+	memcpy(buf, &shb, sizeof(shb));
+	len = close_pcapng_block(buf, sizeof(shb));
+
+	return output_compressed_pcap_file(info, buf, len);
+}
+
+/* Stage a block of pcapng other than EPB */
+static int stage_pcapng_block(struct pcap_mng_info *info,
+		const char *block, size_t len)
+{
+	if (info->inbuf_len + len > PCAP_STAGING_SIZE) {
+		if (flush_staging_buffer(info) != SPP_RET_OK)
+			return SPP_RET_NG;
+	}
+	rte_memcpy((char *)info->inbuff + info->inbuf_len, block, len);
+	info->inbuf_len += len;
+	info->file_size += len;
+	return SPP_RET_OK;
+}
+
+/**
+ * Stage interface description block of pcapng for the capture port of
+ * given DPDK port ID, and assign interface ID to the port. Interface ID
+ * is the index of the block in the section.
+ */
+static int stage_pcapng_interface(struct pcap_mng_info *info, uint16_t port)
+{
+	char buf[PCAPNG_BLOCK_BUF_SIZE];
+	const char *if_name = g_pcap_option.port_attr[port].name;
+	uint8_t tsresol = PCAPNG_TSRESOL_NSEC;
+	size_t len = 0;
+	struct pcapng_interface_description idb;
+
+	idb.block_type = PCAPNG_BLOCK_IDB;
+	idb.linktype = PCAP_LINKTYPE;
+	idb.reserved = 0;
+	idb.snaplen = info->snaplen;
+	memcpy(buf, &idb, sizeof(idb));
+	len = sizeof(idb);
+
+	len += append_pcapng_option(buf + len, PCAPNG_OPT_IF_NAME,
+			if_name, strlen(if_name));
+	len += append_pcapng_option(buf + len, PCAPNG_OPT_IF_TSRESOL,
+			&tsresol, sizeof(tsresol));
+	len += append_pcapng_option(buf + len, PCAPNG_OPT_END, NULL, 0);
+	len = close_pcapng_block(buf, len);
+
+	if (stage_pcapng_block(info, buf, len) != SPP_RET_OK)
+		return SPP_RET_NG;
+	info->if_id[port] = info->num_if++;
+	info->index.entry.flags |= PCAP_INDEX_F_IDB;
+	return SPP_RET_OK;
+}
+
+/**
+ * Sum up the num of packets received from the port and dropped by each of
+ * receive threads.
+ */
+static void get_port_counts(uint16_t port, uint64_t *rx, uint64_t *drop)
+{
+	unsigned int lcore_id;
+
+	*rx = 0;
+	*drop = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_pcap_info[lcore_id].type != PCAP_RECEIVE)
+			continue;
+		*rx += g_pcap_info[lcore_id].port_rx[port];
+		*drop += g_pcap_info[lcore_id].port_drop[port];
+	}
+}
+
+/**
+ * Stage interface statistics blocks of pcapng with the number of packets
+ * received from each of ports described in the file and dropped before
+ * written.
+ */
+static int stage_pcapng_statistics(struct pcap_mng_info *info)
+{
+	char buf[PCAPNG_BLOCK_BUF_SIZE];
+	size_t len = 0;
+	int port;
+	uint64_t ifrecv;
+	uint64_t osdrop;
+	struct timespec cur_time;
+	struct pcapng_interface_statistics isb;
+
+	clock_gettime(CLOCK_REALTIME, &cur_time);
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++) {
+		if (info->if_id[port] < 0)
+			continue;
+
+		get_port_counts(port, &ifrecv, &osdrop);
+		isb.block_type = PCAPNG_BLOCK_ISB;
+		isb.interface_id = info->if_id[port];
+		set_pcapng_timestamp(&cur_time, &isb.ts_high, &isb.ts_low);
+		memcpy(buf, &isb, sizeof(isb));
+		len = sizeof(isb);
+
+		len += append_pcapng_option(buf + len, PCAPNG_OPT_ISB_IFRECV,
+				&ifrecv, sizeof(ifrecv));
+		len += append_pcapng_option(buf + len, PCAPNG_OPT_ISB_OSDROP,
+				&osdrop, sizeof(osdrop));
+		len += append_pcapng_option(buf + len, PCAPNG_OPT_END,
+				NULL, 0);
+		len = close_pcapng_block(buf, len);
+
+		if (stage_pcapng_block(info, buf, len) != SPP_RET_OK)
+			return SPP_RET_NG;
+	}
+	return SPP_RET_OK;
+}
+
+/* Write header of capture file in the format given as option */
+static int write_file_header(struct pcap_mng_info *info)
+{
+	struct pcap_header pcap_h;
+
+	/* snaplen is fixed until the file is closed */
+	info->snaplen = g_pcap_option.snaplen;
+
+	if (g_pcap_option.format == PCAP_FORMAT_PCAPNG)
+		return write_pcapng_header(info);
+
+	/* init the common pcap header */
+	pcap_h.magic_number = TCPDUMP_MAGIC_NSEC;
+	pcap_h.version_major = PCAP_VERSION_MAJOR;
+	pcap_h.version_minor = PCAP_VERSION_MINOR;
+	pcap_h.thiszone = 0;
+	pcap_h.sigfigs = 0;
+	pcap_h.snaplen = info->snaplen;
+	pcap_h.network = PCAP_LINKTYPE;
+
+	return output_compressed_pcap_file(info, &pcap_h,
+			sizeof(struct pcap_header));
+}
+
+/* Stage trailer of capture file in the format given as option */
+static int stage_file_trailer(struct pcap_mng_info *info)
+{
+	if (g_pcap_option.format == PCAP_FORMAT_PCAPNG)
+		return stage_pcapng_statistics(info);
+	return SPP_RET_OK;
+}
+
+/**
+ * Set name of capture file. Capture ports at the time are joined with '-'
+ * in the name, such as 'phy0-ring1'.
+ */
+static void set_file_name(struct pcap_mng_info *info)
+{
+	char ports_str[PCAP_FNAME_STRLEN];
+	const char *iface_type_str;
+	const struct pcap_port_set *set;
+	size_t len = 0;
+	int cnt;
+
+	set = &g_pcap_option.port_set[g_pcap_option.ref_index];
+	memset(ports_str, 0x00, sizeof(ports_str));
+	for (cnt = 0; cnt < set->num && len < sizeof(ports_str); cnt++) {
+		if (set->ports[cnt].iface_type == PHY)
+			iface_type_str = SPP_IFTYPE_NIC_STR;
+		else
+			iface_type_str = SPP_IFTYPE_RING_STR;
+		len += snprintf(&ports_str[len], sizeof(ports_str) - len,
+				"%s%s%d", cnt == 0 ? "" : "-",
+				iface_type_str, set->ports[cnt].iface_no);
+	}
+
+	snprintf(info->compress_file_name,
+				PCAP_FNAME_STRLEN - 1,
+				"spp_pcap.%s.%s.%u.%u.%s%s",
+				g_pcap_option.compress_file_date,
+				ports_str,
+				info->worker_no + 1,
+				info->file_no,
+				PCAP_FILE_FORMAT_STRINGS[g_pcap_option.format],
+				spp_pcap_codec_extension(
+					info->codec.conf.type));
+}
+
+/**
+ * Open index of capture file and write its header. The frame of file
+ * header is ended here, so the first chunk starts with records.
+ */
+static int open_index_file(struct pcap_mng_info *info)
+{
+	struct pcap_index *idx = &info->index;
+	struct pcap_index_header hdr;
+	char path[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN];
+
+	if (spp_pcap_codec_restart(&info->codec) != SPP_RET_OK)
+		return SPP_RET_NG;
+
+	snprintf(path, sizeof(path), "%s/%s.idx.tmp",
+			g_pcap_option.compress_file_path,
+			info->compress_file_name);
+	idx->fp = fopen(path, "w");
+	if (idx->fp == NULL) {
+		RTE_LOG(ERR, SPP_PCAP, "index open error! filename=%s (%s)\n",
+				path, strerror(errno));
+		return SPP_RET_NG;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = PCAP_INDEX_MAGIC;
+	hdr.version = PCAP_INDEX_VERSION;
+	hdr.format = g_pcap_option.format;
+	hdr.codec = info->codec.conf.type;
+	hdr.snaplen = info->snaplen;
+	if (fwrite(&hdr, sizeof(hdr), 1, idx->fp) != 1) {
+		RTE_LOG(ERR, SPP_PCAP, "index write error (%s)\n",
+				strerror(errno));
+		return SPP_RET_NG;
+	}
+	idx->size = sizeof(hdr);
+
+	memset(&idx->entry, 0, sizeof(idx->entry));
+	idx->entry.offset = get_output_position(&info->output);
+	idx->chunk_len = 0;
+	return SPP_RET_OK;
+}
+
+/* Write the entry of the last chunk and close index of capture file */
+static int close_index_file(struct pcap_mng_info *info)
+{
+	struct pcap_index *idx = &info->index;
+	int ret;
+
+	if (idx->fp == NULL)
+		return SPP_RET_OK;
+
+	ret = write_index_entry(info);
+	if (fclose(idx->fp) != 0)
+		ret = SPP_RET_NG;
+	idx->fp = NULL;
+	return ret;
+}
+
+/* Rename index of capture file completed, before the capture file */
+static void rename_index_file(const char *save_file)
+{
+	char temp_idx[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN + 8];
+	char save_idx[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN + 8];
+
+	if (!g_pcap_option.index)
+		return;
+
+	snprintf(temp_idx, sizeof(temp_idx), "%s.idx.tmp", save_file);
+	snprintf(save_idx, sizeof(save_idx), "%s.idx", save_file);
+	rename(temp_idx, save_idx);
+}
+
+/**
+ * Return TSC when the file opened now is rotated by `--rotate-interval`.
+ * Files are rotated at multiples of the interval of wall clock, such as
+ * every hour on the hour, so that each of them covers the same period.
+ */
+static uint64_t get_rotate_tsc(void)
+{
+	struct timespec cur_time;
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t remain;
+
+	clock_gettime(CLOCK_REALTIME, &cur_time);
+	remain = (g_pcap_option.rotate_interval -
+			(uint64_t)cur_time.tv_sec %
+			g_pcap_option.rotate_interval) * NS_PER_S -
+			cur_time.tv_nsec;
+	return rte_rdtsc() + remain / NS_PER_S * hz +
+			remain % NS_PER_S * hz / NS_PER_S;
+}
+
+/* Delete the oldest capture file retained */
+static void delete_oldest_file(struct pcap_retention *ret)
+{
+	struct pcap_retained_file *file = &ret->files[ret->head];
+	char idx_path[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN + 8];
+
+	if (unlink(file->path) != 0 && errno != ENOENT)
+		RTE_LOG(ERR, SPP_PCAP, "Cannot delete %s (%s)\n",
+				file->path, strerror(errno));
+	else
+		RTE_LOG(INFO, SPP_PCAP, "Delete %s\n", file->path);
+
+	if (g_pcap_option.index) {
+		snprintf(idx_path, sizeof(idx_path), "%s.idx", file->path);
+		unlink(idx_path);
+	}
+
+	ret->bytes -= file->size;
+	ret->head = (ret->head + 1) % ret->cap;
+	ret->num--;
+}
+
+/**
+ * Add a capture file completed to the retention, and delete the oldest
+ * ones if over `--max-files` or the share of `--dir-quota`. Room for the
+ * file being written is kept in the quota, which is `--fsize` at most.
+ */
+static void retain_capture_file(struct pcap_mng_info *info,
+		const char *path)
+{
+	struct pcap_retention *ret = &info->retention;
+	struct pcap_retained_file *files;
+	size_t tail;
+
+	if (ret->cap == 0)
+		return;
+
+	/* extend ring if no limit of num of files */
+	if (ret->num == ret->cap) {
+		files = realloc(ret->files, sizeof(*files) * ret->cap * 2);
+		if (files == NULL) {
+			delete_oldest_file(ret);
+		} else {
+			memcpy(&files[ret->cap], files,
+					sizeof(*files) * ret->head);
+			ret->files = files;
+			ret->cap *= 2;
+		}
+	}
+
+	tail = (ret->head + ret->num) % ret->cap;
+	strcpy(ret->files[tail].path, path);
+	ret->files[tail].size = info->output.offset + info->index.size;
+	ret->bytes += ret->files[tail].size;
+	ret->num++;
+
+	while (ret->num > 0 &&
+			((g_pcap_option.max_files != 0 &&
+			  ret->num > g_pcap_option.max_files) ||
+			 (ret->quota != 0 && ret->bytes +
+			  g_pcap_option.fsize_limit > ret->quota)))
+		delete_oldest_file(ret);
+}
+
+/**
+ * File compression operation. There are three mode.
+ * Open and update and close.
+ */
+static int file_compression_operation(struct pcap_mng_info *info,
+				   enum comp_file_generate_mode mode)
+{
+	int ret = SPP_RET_OK;
+	char temp_file[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN];
+	char save_file[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN];
+
+	if (mode == INIT_MODE) { /* initial generation mode */
+		/* codec is fixed until capture is stopped */
+		info->inbuff = malloc(PCAP_STAGING_SIZE);
+		info->inbuf_len = 0;
+		if (spp_pcap_codec_init(&info->codec, &g_pcap_option.codec,
+				PCAP_STAGING_SIZE, write_codec_data,
+				&info->output) != SPP_RET_OK ||
+				info->inbuff == NULL ||
+				alloc_output_blocks(&info->output) !=
+				SPP_RET_OK) {
+			RTE_LOG(ERR, SPP_PCAP, "Cannot allocate buffers.\n");
+			free_compress_buffer(info);
+			return SPP_RET_NG;
+		}
+
+		memset(&info->output.stats, 0, sizeof(info->output.stats));
+
+		/* Initialize pcap file name */
+		info->file_size = 0;
+		info->file_no = 1;
+		set_file_name(info);
+	} else if (mode == UPDATE_MODE) { /* update generation mode */
+		/* old compress file close */
+		/* flush whatever remains within internal buffers */
+		if (stage_file_trailer(info) != SPP_RET_OK ||
+				flush_staging_buffer(info) != SPP_RET_OK) {
+			close_output_file(&info->output);
+			free_compress_buffer(info);
+			return SPP_RET_NG;
+		}
+		if (spp_pcap_codec_end(&info->codec) != SPP_RET_OK ||
+				close_index_file(info) != SPP_RET_OK) {
+			close_output_file(&info->output);
+			free_compress_buffer(info);
 			return SPP_RET_NG;
 		}
 
 		/* flush remained data */
-		fclose(info->compress_fp);
-		info->compress_fp = NULL;
+		if (close_output_file(&info->output) != SPP_RET_OK) {
+			free_compress_buffer(info);
+			return SPP_RET_NG;
+		}
 
 		/* rename temporary file */
 		memset(temp_file, 0,
@@ -565,39 +2183,41 @@ static int file_compression_operation(struct pcap_mng_info *info,
 		    (PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN) - 1,
 		    "%s/%s", g_pcap_option.compress_file_path,
 		    info->compress_file_name);
+		rename_index_file(save_file);
 		rename(temp_file, save_file);
+		retain_capture_file(info, save_file);
 
 		/* Initialize pcap file name */
 		info->file_size = 0;
 		info->file_no++;
-		if (g_pcap_option.port_cap.iface_type == PHY)
-			iface_type_str = SPP_IFTYPE_NIC_STR;
-		else
-			iface_type_str = SPP_IFTYPE_RING_STR;
-		snprintf(info->compress_file_name,
-					PCAP_FNAME_STRLEN - 1,
-					"spp_pcap.%s.%s%d.%u.%u.pcap.lz4",
-					g_pcap_option.compress_file_date,
-					iface_type_str,
-					g_pcap_option.port_cap.iface_no,
-					info->thread_no,
-					info->file_no);
+		set_file_name(info);
 	} else { /* close mode */
 		/* Close temporary file and rename to persistent */
-		if (info->compress_fp == NULL)
+		if (info->output.fd < 0)
 			return SPP_RET_OK;
-		compress_len = LZ4F_compressEnd(info->ctx, info->outbuff,
-					info->outbuf_capacity, NULL);
-		if (LZ4F_isError(compress_len)) {
-			RTE_LOG(ERR, SPP_PCAP, "Failed to end compression: "
-					"error %zd\n", compress_len);
-		} else {
-			output_pcap_file(info->compress_fp, info->outbuff,
-								compress_len);
-			info->file_size += compress_len;
+
+		/*
+		 * Failures are logged and the file is closed anyway, so that
+		 * records written before are kept in the file.
+		 */
+		if (stage_file_trailer(info) != SPP_RET_OK) {
+			RTE_LOG(ERR, SPP_PCAP, "Cannot write trailer of "
+					"file. (file = %s)\n",
+					info->compress_file_name);
+			ret = SPP_RET_NG;
 		}
+		if (flush_staging_buffer(info) != SPP_RET_OK) {
+			RTE_LOG(ERR, SPP_PCAP, "Cannot flush staged records. "
+					"(file = %s)\n",
+					info->compress_file_name);
+			ret = SPP_RET_NG;
+		}
+		if (spp_pcap_codec_end(&info->codec) != SPP_RET_OK ||
+				close_index_file(info) != SPP_RET_OK)
+			ret = SPP_RET_NG;
 		/* flush remained data */
-		fclose(info->compress_fp);
+		if (close_output_file(&info->output) != SPP_RET_OK)
+			ret = SPP_RET_NG;
 
 		/* rename temporary file */
 		memset(temp_file, 0,
@@ -612,11 +2232,12 @@ static int file_compression_operation(struct pcap_mng_info *info,
 		    (PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN) - 1,
 		    "%s/%s", g_pcap_option.compress_file_path,
 		    info->compress_file_name);
+		rename_index_file(save_file);
 		rename(temp_file, save_file);
+		retain_capture_file(info, save_file);
 
-		info->compress_fp = NULL;
-		free(info->outbuff);
-		return SPP_RET_OK;
+		free_compress_buffer(info);
+		return ret;
 	}
 
 	/* file open */
@@ -627,151 +2248,573 @@ static int file_compression_operation(struct pcap_mng_info *info,
 		"%s/%s.tmp", g_pcap_option.compress_file_path,
 		info->compress_file_name);
 	RTE_LOG(INFO, SPP_PCAP, "open compress filename=%s\n", temp_file);
-	info->compress_fp = fopen(temp_file, "wb");
-	if (info->compress_fp == NULL) {
+	if (open_output_file(&info->output, temp_file) != SPP_RET_OK) {
 		RTE_LOG(ERR, SPP_PCAP, "file open error! filename=%s\n",
 						info->compress_file_name);
-		free(info->outbuff);
+		free_compress_buffer(info);
 		return SPP_RET_NG;
 	}
 
-	/* init lz4 stream */
-	ctxCreation = LZ4F_createCompressionContext(&info->ctx, LZ4F_VERSION);
-	if (LZ4F_isError(ctxCreation)) {
-		RTE_LOG(ERR, SPP_PCAP, "LZ4F_createCompressionContext error "
-						"(%zd)\n", ctxCreation);
-		fclose(info->compress_fp);
-		info->compress_fp = NULL;
-		free(info->outbuff);
+	/* write compress frame header */
+	if (spp_pcap_codec_begin(&info->codec) != SPP_RET_OK) {
+		close_output_file(&info->output);
+		free_compress_buffer(info);
 		return SPP_RET_NG;
 	}
+	info->file_size = 0;
+	if (g_pcap_option.rotate_interval != 0)
+		info->rotate_tsc = get_rotate_tsc();
 
-	/* write compress frame header */
-	headerSize = LZ4F_compressBegin(info->ctx, info->outbuff,
-					info->outbuf_capacity, &g_kprefs);
-	if (LZ4F_isError(headerSize)) {
-		RTE_LOG(ERR, SPP_PCAP, "Failed to start compression: "
-					"error %zd\n", headerSize);
-		fclose(info->compress_fp);
-		info->compress_fp = NULL;
-		free(info->outbuff);
+	/* pcap header write */
+	if (write_file_header(info) != SPP_RET_OK) {
+		RTE_LOG(ERR, SPP_PCAP, "pcap header write  error!\n");
+		close_output_file(&info->output);
+		free_compress_buffer(info);
 		return SPP_RET_NG;
 	}
-	RTE_LOG(DEBUG, SPP_PCAP, "Buffer size is %zd bytes, header size %zd "
-			"bytes\n", info->outbuf_capacity, headerSize);
-	if (output_pcap_file(info->compress_fp, info->outbuff,
-						headerSize) != 0) {
-		fclose(info->compress_fp);
-		info->compress_fp = NULL;
-		free(info->outbuff);
+
+	/* index is started after the frame of file header */
+	if (g_pcap_option.index && open_index_file(info) != SPP_RET_OK) {
+		close_output_file(&info->output);
+		free_compress_buffer(info);
 		return SPP_RET_NG;
 	}
-	info->file_size = headerSize;
 
-	/* init the common pcap header */
-	pcap_h.magic_number = TCPDUMP_MAGIC;
-	pcap_h.version_major = PCAP_VERSION_MAJOR;
-	pcap_h.version_minor = PCAP_VERSION_MINOR;
-	pcap_h.thiszone = 0;
-	pcap_h.sigfigs = 0;
-	pcap_h.snaplen = PCAP_SNAPLEN_MAX;
-	pcap_h.network = PCAP_LINKTYPE;
+	return SPP_RET_OK;
+}
 
-	/* pcap header write */
-	if (output_lz4_pcap_file(info, &pcap_h, sizeof(struct pcap_header))
-							!= SPP_RET_OK) {
-		RTE_LOG(ERR, SPP_PCAP, "pcap header write  error!\n");
-		fclose(info->compress_fp);
-		info->compress_fp = NULL;
-		free(info->outbuff);
+/* Convert cycles of a clock to the ones of another clock without overflow */
+static inline uint64_t convert_cycles(uint64_t cycles, uint64_t from_hz,
+		uint64_t to_hz)
+{
+	return cycles / from_hz * to_hz + cycles % from_hz * to_hz / from_hz;
+}
+
+/**
+ * Convert timestamp of packet to time of day based on the time when
+ * capture started. It is the clock of NIC if PKT_RX_TIMESTAMP is set,
+ * or TSC stamped by receive thread. Clock of NIC is converted to TSC from
+ * the base read at the same time for the source port of the packet.
+ */
+static void convert_stamp_to_time(const struct rte_mbuf *pkt,
+		struct timespec *ts)
+{
+	const struct pcap_port_attr *attr =
+			&g_pcap_option.port_attr[pkt->port];
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t delta = pkt->timestamp - g_pcap_option.start_tsc;
+	uint64_t nsec;
+
+	if (pkt->ol_flags & PKT_RX_TIMESTAMP) {
+		delta = attr->base_tsc - g_pcap_option.start_tsc;
+		if (pkt->timestamp > attr->base_nic_clock)
+			delta += convert_cycles(
+					pkt->timestamp - attr->base_nic_clock,
+					attr->nic_clock_hz, hz);
+	}
+	nsec = g_pcap_option.start_time.tv_nsec +
+			(delta % hz) * NS_PER_S / hz;
+
+	ts->tv_sec = g_pcap_option.start_time.tv_sec + delta / hz +
+			nsec / NS_PER_S;
+	ts->tv_nsec = nsec % NS_PER_S;
+}
+
+/**
+ * Start the next file if size of file is over the limit, interval of
+ * rotation is passed or snaplen changed.
+ */
+static int rotate_capture_file(struct pcap_mng_info *info)
+{
+	if (info->file_size > g_pcap_option.fsize_limit ||
+			unlikely(info->snaplen != g_pcap_option.snaplen) ||
+			(g_pcap_option.rotate_interval != 0 &&
+			 rte_rdtsc() >= info->rotate_tsc))
+		return file_compression_operation(info, UPDATE_MODE);
+	return SPP_RET_OK;
+}
+
+/* Update range of timestamps and num of packets of chunk of index */
+static inline void update_index_entry(struct pcap_index_entry *entry,
+		const struct timespec *cap_time)
+{
+	uint64_t time_ns = (uint64_t)cap_time->tv_sec * NS_PER_S +
+			cap_time->tv_nsec;
+
+	/* packets from several receivers are not strictly in order */
+	if (entry->packets == 0 || time_ns < entry->first_ns)
+		entry->first_ns = time_ns;
+	if (time_ns > entry->last_ns)
+		entry->last_ns = time_ns;
+	entry->packets++;
+}
+
+/**
+ * Stage header and trailer of a pcap record in the staging buffer, and
+ * return the room for packet data between them, or NULL if failed.
+ */
+static char *stage_packet_record(struct pcap_mng_info *info, uint16_t port,
+		const struct timespec *cap_time, uint32_t write_packet_length,
+		uint32_t packet_length)
+{
+	struct pcap_packet_header pcap_packet_h;
+	struct pcapng_enhanced_packet epb;
+	const void *header = NULL;
+	size_t header_len = 0;
+	size_t padding_len = 0;
+	size_t trailer_len = 0;
+	size_t record_len;
+	char *staging;
+
+	/* describe source port of packet at the first time in the file */
+	if (g_pcap_option.format == PCAP_FORMAT_PCAPNG &&
+			info->if_id[port] < 0) {
+		if (stage_pcapng_interface(info, port) != SPP_RET_OK)
+			return NULL;
+	}
+
+	/* make block header */
+	if (g_pcap_option.format == PCAP_FORMAT_PCAPNG) {
+		/* packet data is padded and followed by block length */
+		padding_len = RTE_ALIGN_CEIL(write_packet_length, 4) -
+				write_packet_length;
+		header = &epb;
+		header_len = sizeof(struct pcapng_enhanced_packet);
+		trailer_len = padding_len + sizeof(uint32_t);
+		epb.block_type = PCAPNG_BLOCK_EPB;
+		epb.block_length = header_len + write_packet_length +
+				trailer_len;
+		epb.interface_id = info->if_id[port];
+		set_pcapng_timestamp(cap_time, &epb.ts_high, &epb.ts_low);
+		epb.captured_len = write_packet_length;
+		epb.packet_len = packet_length;
+	} else {
+		header = &pcap_packet_h;
+		header_len = sizeof(struct pcap_packet_header);
+		pcap_packet_h.ts_sec = (int32_t)cap_time->tv_sec;
+		pcap_packet_h.ts_nsec = (int32_t)cap_time->tv_nsec;
+		pcap_packet_h.write_len = write_packet_length;
+		pcap_packet_h.packet_len = packet_length;
+	}
+
+	/* compress staged records if no room for this one */
+	record_len = header_len + write_packet_length + trailer_len;
+	if (info->inbuf_len + record_len > PCAP_STAGING_SIZE) {
+		if (flush_staging_buffer(info) != SPP_RET_OK)
+			return NULL;
+	}
+	staging = (char *)info->inbuff + info->inbuf_len;
+	info->inbuf_len += record_len;
+	info->file_size += record_len;
+	if (info->index.fp != NULL)
+		update_index_entry(&info->index.entry, cap_time);
+
+	/* write block header and trailer around packet data */
+	rte_memcpy(staging, header, header_len);
+	staging += header_len;
+	if (trailer_len != 0) {
+		memset(staging + write_packet_length, 0, padding_len);
+		memcpy(staging + write_packet_length + padding_len,
+				&epb.block_length, sizeof(uint32_t));
+	}
+
+	return staging;
+}
+
+/**
+ * Stage packet data for compression. Pcap records are gathered into the
+ * staging buffer, and compressed at once when it has no room for the next
+ * one to reduce overhead of codec for small packets.
+ */
+static int compress_file_packet(struct pcap_mng_info *info,
+				struct rte_mbuf *cap_pkt)
+{
+	unsigned int write_packet_length;
+	unsigned int packet_length;
+	struct timespec cap_time;
+	unsigned int remaining_bytes;
+	int bytes_to_write;
+	char *staging;
+
+	if (info->output.fd < 0)
+		return SPP_RET_OK;
+
+	/* capture file rool, or start new file for snaplen changed */
+	if (rotate_capture_file(info) != SPP_RET_OK)
 		return SPP_RET_NG;
+
+	/* cast to packet */
+	packet_length = rte_pktmbuf_pkt_len(cap_pkt);
+
+	/* truncate packet over the maximum length */
+	write_packet_length = TRANCATE_SNAPLEN(info->snaplen, packet_length);
+
+	convert_stamp_to_time(cap_pkt, &cap_time);
+	staging = stage_packet_record(info, cap_pkt->port, &cap_time,
+			write_packet_length, packet_length);
+	if (staging == NULL) {
+		file_compression_operation(info, CLOSE_MODE);
+		return SPP_RET_NG;
+	}
+
+	/* write content, without walking chain if first segment is enough */
+	if (likely(write_packet_length <= rte_pktmbuf_data_len(cap_pkt))) {
+		rte_memcpy(staging, rte_pktmbuf_mtod(cap_pkt, void *),
+				write_packet_length);
+	} else {
+		remaining_bytes = write_packet_length;
+		while (cap_pkt != NULL && remaining_bytes > 0) {
+			bytes_to_write = TRANCATE_SNAPLEN(
+					rte_pktmbuf_data_len(cap_pkt),
+					remaining_bytes);
+
+			rte_memcpy(staging,
+					rte_pktmbuf_mtod(cap_pkt, void *),
+					bytes_to_write);
+			staging += bytes_to_write;
+			cap_pkt = cap_pkt->next;
+			remaining_bytes -= bytes_to_write;
+		}
 	}
 
 	return SPP_RET_OK;
 }
 
-/* compress packet data */
-static int compress_file_packet(struct pcap_mng_info *info,
-				struct rte_mbuf *cap_pkt)
+/* Return the oldest record of flight recorder, or NULL if it is unused */
+static inline struct recorder_record *
+peek_record(const struct pcap_recorder *rec)
+{
+	struct recorder_record *hdr;
+
+	if (rec->size - rec->head < sizeof(struct recorder_record))
+		return NULL;
+	hdr = (struct recorder_record *)(rec->buf + rec->head);
+	return hdr->rec_len == 0 ? NULL : hdr;
+}
+
+/* Evict the oldest record, or unused data at the end, of flight recorder */
+static void evict_record(struct pcap_recorder *rec)
+{
+	const struct recorder_record *hdr = peek_record(rec);
+
+	if (hdr == NULL) {
+		rec->used -= rec->size - rec->head;
+		rec->head = 0;
+	} else {
+		rec->used -= hdr->rec_len;
+		rec->head += hdr->rec_len;
+		if (rec->head == rec->size)
+			rec->head = 0;
+		rec->packets--;
+	}
+
+	if (rec->used == 0) {
+		rec->head = 0;
+		rec->tail = 0;
+		rec->packets = 0;
+	}
+}
+
+/**
+ * Copy packet into flight recorder. The oldest records are evicted until
+ * it has room for this one.
+ */
+static void record_packet(struct pcap_mng_info *info, struct rte_mbuf *pkt)
+{
+	struct pcap_recorder *rec = &info->recorder;
+	struct recorder_record *hdr;
+	struct timespec cap_time;
+	uint32_t packet_length = rte_pktmbuf_pkt_len(pkt);
+	uint32_t write_packet_length = TRANCATE_SNAPLEN(
+			g_pcap_option.snaplen, packet_length);
+	size_t rec_len = RTE_ALIGN_CEIL(sizeof(struct recorder_record) +
+			write_packet_length, PCAP_RECORDER_ALIGN);
+	size_t gap;
+	const void *data;
+
+	/* record is not split, so the rest of buffer is skipped if short */
+	for (;;) {
+		gap = (rec->size - rec->tail < rec_len) ?
+				rec->size - rec->tail : 0;
+		if (rec->size - rec->used >= gap + rec_len)
+			break;
+		evict_record(rec);
+	}
+	if (gap != 0) {
+		if (gap >= sizeof(struct recorder_record))
+			((struct recorder_record *)
+					(rec->buf + rec->tail))->rec_len = 0;
+		rec->used += gap;
+		rec->tail = 0;
+	}
+
+	convert_stamp_to_time(pkt, &cap_time);
+	hdr = (struct recorder_record *)(rec->buf + rec->tail);
+	hdr->time_ns = (uint64_t)cap_time.tv_sec * NS_PER_S +
+			cap_time.tv_nsec;
+	hdr->rec_len = rec_len;
+	hdr->caplen = write_packet_length;
+	hdr->len = packet_length;
+	hdr->port = pkt->port;
+	hdr->reserved = 0;
+
+	/* data is returned without copy if it is in the first segment */
+	data = rte_pktmbuf_read(pkt, 0, write_packet_length, hdr + 1);
+	if (data != hdr + 1)
+		rte_memcpy(hdr + 1, data, write_packet_length);
+
+	rec->tail += rec_len;
+	if (rec->tail == rec->size)
+		rec->tail = 0;
+	rec->used += rec_len;
+	rec->packets++;
+}
+
+/* Stage a packet kept in flight recorder into capture file */
+static int stage_recorded_packet(struct pcap_mng_info *info,
+		const struct recorder_record *hdr)
+{
+	struct timespec cap_time;
+	uint32_t write_packet_length;
+	char *staging;
+
+	if (rotate_capture_file(info) != SPP_RET_OK)
+		return SPP_RET_NG;
+
+	/* snaplen might be decreased after recorded */
+	write_packet_length = TRANCATE_SNAPLEN(info->snaplen, hdr->caplen);
+	cap_time.tv_sec = hdr->time_ns / NS_PER_S;
+	cap_time.tv_nsec = hdr->time_ns % NS_PER_S;
+	staging = stage_packet_record(info, hdr->port, &cap_time,
+			write_packet_length, hdr->len);
+	if (staging == NULL)
+		return SPP_RET_NG;
+
+	rte_memcpy(staging, hdr + 1, write_packet_length);
+	return SPP_RET_OK;
+}
+
+/**
+ * Dump packets kept in flight recorder to capture files, and empty it.
+ * Packets older than `--recorder-time` are discarded. Recording is paused
+ * while dumping, so packets are accumulated in rings from receivers.
+ */
+static void dump_recorder(struct pcap_mng_info *info)
+{
+	struct pcap_recorder *rec = &info->recorder;
+	const struct recorder_record *hdr;
+	struct timespec cur_time;
+	uint64_t oldest = 0;
+	uint64_t dumped = 0;
+	int ret = SPP_RET_OK;
+
+	rec->dump_gen = g_dump_gen;
+	rte_rmb();
+	if (rec->packets == 0)
+		return;
+
+	clock_gettime(CLOCK_REALTIME, &cur_time);
+	if (g_pcap_option.recorder_time != 0)
+		oldest = (uint64_t)cur_time.tv_sec * NS_PER_S +
+				cur_time.tv_nsec -
+				g_pcap_option.recorder_time * NS_PER_S;
+
+	if (file_compression_operation(info, INIT_MODE) != SPP_RET_OK) {
+		RTE_LOG(ERR, SPP_PCAP, "Failed to dump recorder on lcore "
+				"%d.\n", rte_lcore_id());
+		return;
+	}
+	while (rec->used != 0) {
+		hdr = peek_record(rec);
+		if (hdr != NULL && hdr->time_ns >= oldest) {
+			ret = stage_recorded_packet(info, hdr);
+			if (ret != SPP_RET_OK)
+				break;
+			dumped++;
+		}
+		evict_record(rec);
+	}
+	file_compression_operation(info, CLOSE_MODE);
+
+	/* records are discarded even if failed */
+	rec->head = 0;
+	rec->tail = 0;
+	rec->used = 0;
+	rec->packets = 0;
+	if (ret != SPP_RET_OK) {
+		RTE_LOG(ERR, SPP_PCAP, "Failed to dump recorder on lcore "
+				"%d.\n", rte_lcore_id());
+		return;
+	}
+	rec->dumps++;
+	RTE_LOG(INFO, SPP_PCAP, "Dump %lu packets of recorder on lcore %d.\n",
+			dumped, rte_lcore_id());
+}
+
+/**
+ * Stamp received packets with TSC and tag them with DPDK port ID of the
+ * source port. Timestamp given by NIC is kept if its clock is available
+ * for conversion.
+ */
+static inline void stamp_rx_packets(struct rte_mbuf **bufs, int nb_rx,
+		uint16_t port)
+{
+	int buf;
+	uint64_t tsc = rte_rdtsc();
+	uint64_t nic_clock_hz = g_pcap_option.port_attr[port].nic_clock_hz;
+
+	for (buf = 0; buf < nb_rx; buf++) {
+		bufs[buf]->port = port;
+		if (nic_clock_hz != 0 &&
+				(bufs[buf]->ol_flags & PKT_RX_TIMESTAMP))
+			continue;
+		bufs[buf]->ol_flags &= ~PKT_RX_TIMESTAMP;
+		bufs[buf]->timestamp = tsc;
+	}
+}
+
+/* Return true if any of receive threads is capturing */
+static int is_receiver_running(void)
 {
-	unsigned int write_packet_length;
-	unsigned int packet_length;
-	struct timespec cap_time;
-	struct pcap_packet_header pcap_packet_h;
-	unsigned int remaining_bytes;
-	int bytes_to_write;
+	unsigned int lcore_id;
 
-	if (info->compress_fp == NULL)
-		return SPP_RET_OK;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_pcap_info[lcore_id].type == PCAP_RECEIVE &&
+				g_pcap_info[lcore_id].status ==
+				SPP_CAPTURE_RUNNING)
+			return 1;
+	}
+	return 0;
+}
 
-	/* capture file rool */
-	if (info->file_size > g_pcap_option.fsize_limit) {
-		if (file_compression_operation(info, UPDATE_MODE)
-							!= SPP_RET_OK)
-			return SPP_RET_NG;
+/**
+ * Evaluate capture filter for each of received packets and set non-zero to
+ * the result if matched. Packet of multi-segment is evaluated only for its
+ * first segment unless it is done by librte_bpf.
+ */
+static inline void eval_capture_filter(struct rte_mbuf **bufs,
+		uint64_t *rc, int nb_rx)
+{
+	const struct pcap_filter *filter = &g_pcap_option.filter;
+	int buf;
+
+#ifdef PCAP_USE_RTE_BPF
+	if (filter->jit != NULL) {
+		for (buf = 0; buf < nb_rx; buf++)
+			rc[buf] = filter->jit(bufs[buf]);
+		return;
+	}
+	if (filter->bpf != NULL) {
+		rte_bpf_exec_burst(filter->bpf, (void **)bufs, rc, nb_rx);
+		return;
 	}
+#endif
+	for (buf = 0; buf < nb_rx; buf++)
+		rc[buf] = bpf_filter(filter->prog.bf_insns,
+				rte_pktmbuf_mtod(bufs[buf], const u_char *),
+				rte_pktmbuf_pkt_len(bufs[buf]),
+				rte_pktmbuf_data_len(bufs[buf]));
+}
 
-	/* cast to packet */
-	packet_length = rte_pktmbuf_pkt_len(cap_pkt);
+/**
+ * Free received packets which do not match capture filter, and return the
+ * num of packets left in the array.
+ */
+static int filter_rx_packets(struct pcap_mng_info *info,
+		struct rte_mbuf **bufs, int nb_rx)
+{
+	uint64_t rc[MAX_PCAP_BURST];
+	int nb_pass = 0;
+	int buf;
 
-	/* truncate packet over the maximum length */
-	write_packet_length = TRANCATE_SNAPLEN(PCAP_SNAPLEN_MAX,
-							packet_length);
+	eval_capture_filter(bufs, rc, nb_rx);
+	for (buf = 0; buf < nb_rx; buf++) {
+		if (rc[buf] != 0)
+			bufs[nb_pass++] = bufs[buf];
+		else
+			rte_pktmbuf_free(bufs[buf]);
+	}
 
-	/* get time */
-	clock_gettime(CLOCK_REALTIME, &cap_time);
+	info->filter_pass += nb_pass;
+	info->filter_drop += nb_rx - nb_pass;
+	return nb_pass;
+}
 
-	/* write block header */
-	pcap_packet_h.ts_sec = (int32_t)cap_time.tv_sec;
-	pcap_packet_h.ts_usec = (int32_t)(cap_time.tv_nsec / 1000);
-	pcap_packet_h.write_len = write_packet_length;
-	pcap_packet_h.packet_len = packet_length;
+/**
+ * Enqueue received packets to the rings of writer threads, and return the
+ * num of packets dropped. Packets are distributed by RSS hash so that the
+ * order of packets in a flow is kept. Packets without RSS hash are sent to
+ * the writer decided by RX queue.
+ */
+static int enqueue_rx_packets(struct pcap_mng_info *info,
+		struct rte_mbuf **bufs, int nb_rx, uint32_t item)
+{
+	struct rte_mbuf *tx_bufs[MAX_PCAP_BURST];
+	uint16_t dst[MAX_PCAP_BURST];
+	int nb_drop = 0;
+	int nb_tx;
+	int ring;
+	int buf;
+	int cnt;
 
-	/* output to lz4_pcap_file */
-	if (output_lz4_pcap_file(info, &pcap_packet_h.ts_sec,
-			sizeof(struct pcap_packet_header)) != SPP_RET_OK) {
-		file_compression_operation(info, CLOSE_MODE);
-		return SPP_RET_NG;
+	if (likely(info->num_ring == 1)) {
+		nb_tx = rte_ring_sp_enqueue_burst(info->rings[0],
+				(void *)bufs, nb_rx, NULL);
+		for (buf = nb_tx; buf < nb_rx; buf++)
+			rte_pktmbuf_free(bufs[buf]);
+		return nb_rx - nb_tx;
 	}
-	info->file_size += sizeof(struct pcap_packet_header);
 
-	/* write content */
-	remaining_bytes = write_packet_length;
-	while (cap_pkt != NULL && remaining_bytes > 0) {
-		/* write file */
-		bytes_to_write = TRANCATE_SNAPLEN(
-					rte_pktmbuf_data_len(cap_pkt),
-					remaining_bytes);
+	for (buf = 0; buf < nb_rx; buf++) {
+		if (bufs[buf]->ol_flags & PKT_RX_RSS_HASH)
+			dst[buf] = bufs[buf]->hash.rss % info->num_ring;
+		else
+			dst[buf] = item % info->num_ring;
+	}
 
-		/* output to lz4_pcap_file */
-		if (output_lz4_pcap_file(info,
-				rte_pktmbuf_mtod(cap_pkt, void*),
-						bytes_to_write) != 0) {
-			file_compression_operation(info, CLOSE_MODE);
-			return SPP_RET_NG;
+	for (ring = 0; ring < info->num_ring; ring++) {
+		cnt = 0;
+		for (buf = 0; buf < nb_rx; buf++) {
+			if (dst[buf] == ring)
+				tx_bufs[cnt++] = bufs[buf];
 		}
-		cap_pkt = cap_pkt->next;
-		remaining_bytes -= bytes_to_write;
-		info->file_size += bytes_to_write;
+		if (cnt == 0)
+			continue;
+
+		nb_tx = rte_ring_sp_enqueue_burst(info->rings[ring],
+				(void *)tx_bufs, cnt, NULL);
+		for (buf = nb_tx; buf < cnt; buf++)
+			rte_pktmbuf_free(tx_bufs[buf]);
+		nb_drop += cnt - nb_tx;
 	}
-
-	return SPP_RET_OK;
+	return nb_drop;
 }
 
-/* Receive packets from shared ring buffer */
+/**
+ * Receive packets from RX queues of capture ports assigned to the thread
+ * and pass them to writer threads. The first receive thread starts and
+ * stops capturing on behalf of all of threads.
+ */
 static int pcap_proc_receive(int lcore_id)
 {
 	struct timespec cur_time;  /* Used as timestamp for the file name */
-	struct tm l_time;
-	int buf;
+	int cnt;
 	int nb_rx = 0;
-	int nb_tx = 0;
+	int nb_cap = 0;
+	int nb_drop = 0;
+	uint16_t queue;
+	uint32_t item;
 	struct spp_port_info *rx;
 	struct rte_mbuf *bufs[MAX_PCAP_BURST];
 	struct pcap_mng_info *info = &g_pcap_info[lcore_id];
-	struct rte_ring *write_ring = g_pcap_option.cap_ring;
-	static long long total_rx;
-	static long long total_drop;
+	struct pcap_port_attr *attr;
+	struct pcap_port_set *set;
+	int leader = (info->worker_no == 0);
+
+	/* Refer to the set of capture ports updated by port command */
+	info->ref_index = g_pcap_option.ref_index;
+	rte_rmb();
+	set = &g_pcap_option.port_set[info->ref_index];
 
 	if (g_capture_request == SPP_CAPTURE_IDLE) {
 		if (info->status == SPP_CAPTURE_RUNNING) {
@@ -779,74 +2822,148 @@ static int pcap_proc_receive(int lcore_id)
 					"Recive on lcore %d, run->idle\n",
 					lcore_id);
 			RTE_LOG(INFO, SPP_PCAP,
-					"Recive on lcore %d, total_rx=%llu, "
-					"total_drop=%llu\n", lcore_id,
-					total_rx, total_drop);
+					"Recive on lcore %d, total_rx=%lu, "
+					"total_drop=%lu\n", lcore_id,
+					info->rx_cnt, info->drop_cnt);
 
 			info->status = SPP_CAPTURE_IDLE;
-			g_capture_status = SPP_CAPTURE_IDLE;
-			if (g_pcap_thread_info.start_up_cnt != 0)
-				g_pcap_thread_info.start_up_cnt -= 1;
+			rte_atomic32_dec(&g_pcap_thread_info.start_up_cnt);
 		}
+
+		/* Writers are stopped after no packet is enqueued anymore */
+		if (leader && g_capture_status == SPP_CAPTURE_RUNNING &&
+				!is_receiver_running())
+			g_capture_status = SPP_CAPTURE_IDLE;
 		return SPP_RET_OK;
 	}
 	if (info->status == SPP_CAPTURE_IDLE) {
-		/* Get time for output file name */
-		clock_gettime(CLOCK_REALTIME, &cur_time);
-		memset(g_pcap_option.compress_file_date, 0, PCAP_FDATE_STRLEN);
-		localtime_r(&cur_time.tv_sec, &l_time);
-		strftime(g_pcap_option.compress_file_date, PCAP_FDATE_STRLEN,
-					"%Y%m%d%H%M%S", &l_time);
+		/* Other threads follow after the leader initialized */
+		if (!leader && g_capture_status != SPP_CAPTURE_RUNNING)
+			return SPP_RET_OK;
+
+		if (leader) {
+			/* Get time for output file name */
+			clock_gettime(CLOCK_REALTIME, &cur_time);
+			g_pcap_option.start_tsc = rte_rdtsc();
+			g_pcap_option.start_time = cur_time;
+			for (cnt = 0; cnt < set->num; cnt++)
+				init_port_clock(&set->ports[cnt]);
+			set_file_date(&cur_time);
+			RTE_LOG(DEBUG, SPP_PCAP,
+					"Recive on lcore %d, start time=%s\n",
+					lcore_id,
+					g_pcap_option.compress_file_date);
+		}
+		info->rx_cnt = 0;
+		info->drop_cnt = 0;
+		memset(info->port_rx, 0, sizeof(info->port_rx));
+		memset(info->port_drop, 0, sizeof(info->port_drop));
+		info->filter_pass = 0;
+		info->filter_drop = 0;
 		info->status = SPP_CAPTURE_RUNNING;
 		g_capture_status = SPP_CAPTURE_RUNNING;
 
 		RTE_LOG(DEBUG, SPP_PCAP,
 				"Recive on lcore %d, idle->run\n", lcore_id);
-		RTE_LOG(DEBUG, SPP_PCAP,
-				"Recive on lcore %d, start time=%s\n",
-				lcore_id, g_pcap_option.compress_file_date);
-		g_pcap_thread_info.start_up_cnt += 1;
-		total_rx = 0;
-		total_drop = 0;
+		rte_atomic32_inc(&g_pcap_thread_info.start_up_cnt);
 	}
 
 	/* Write thread start up wait. */
-	if (g_pcap_thread_info.thread_cnt > g_pcap_thread_info.start_up_cnt)
+	if (g_pcap_thread_info.thread_cnt >
+			rte_atomic32_read(&g_pcap_thread_info.start_up_cnt))
 		return SPP_RET_OK;
 
-	/* Receive packets */
-	rx = &g_pcap_option.port_cap;
-	nb_rx = spp_eth_rx_burst(rx->dpdk_port, 0, bufs, MAX_PCAP_BURST);
-	if (unlikely(nb_rx == 0))
-		return SPP_RET_OK;
+	/* Receive packets from RX queues assigned to this thread */
+	for (cnt = 0; cnt < set->num; cnt++) {
+		rx = &set->ports[cnt];
+		attr = &g_pcap_option.port_attr[rx->dpdk_port];
+		item = set->first_item[cnt];
+		for (queue = 0; queue < attr->nb_rx_queues; queue++, item++) {
+			if (item % g_pcap_option.rx_threads !=
+					(uint32_t)info->worker_no)
+				continue;
+
+			nb_rx = spp_eth_rx_burst(rx->dpdk_port, queue, bufs,
+					MAX_PCAP_BURST);
+			if (unlikely(nb_rx == 0))
+				continue;
+			info->rx_cnt += nb_rx;
+			info->port_rx[rx->dpdk_port] += nb_rx;
+
+			/* Stamp packets at receiving unless stamped by NIC */
+			stamp_rx_packets(bufs, nb_rx, rx->dpdk_port);
+
+			/* Drop packets not matched before compressed */
+			nb_cap = nb_rx;
+			if (g_pcap_option.filter.expression[0] != '\0') {
+				nb_cap = filter_rx_packets(info, bufs, nb_rx);
+				if (nb_cap == 0)
+					continue;
+			}
 
-	/* Forward to ring for writer thread */
-	nb_tx = rte_ring_enqueue_burst(write_ring, (void *)bufs, nb_rx, NULL);
+			/* Forward to rings for writer threads */
+			nb_drop = enqueue_rx_packets(info, bufs, nb_cap, item);
+			if (unlikely(nb_drop > 0))
+				RTE_LOG(ERR, SPP_PCAP,
+						"drop packets(receve) %d\n",
+						nb_drop);
 
-	/* Discard remained packets to release mbuf */
-	if (unlikely(nb_tx < nb_rx)) {
-		RTE_LOG(ERR, SPP_PCAP, "drop packets(receve) %d\n",
-							(nb_rx - nb_tx));
-		for (buf = nb_tx; buf < nb_rx; buf++)
-			rte_pktmbuf_free(bufs[buf]);
+			info->drop_cnt += nb_drop;
+			info->port_drop[rx->dpdk_port] += nb_drop;
+		}
 	}
 
-	total_rx += nb_rx;
-	total_drop += nb_rx - nb_tx;
-
 	return SPP_RET_OK;
 }
 
+/* Compress and write packets to file, and release them */
+static int write_packets(struct pcap_mng_info *info,
+		struct rte_mbuf **bufs, int nb_rx)
+{
+	int ret = SPP_RET_OK;
+	int buf;
+	struct rte_mbuf *mbuf = NULL;
+
+	for (buf = 0; buf < nb_rx; buf++) {
+		mbuf = bufs[buf];
+		rte_prefetch0(rte_pktmbuf_mtod(mbuf, void *));
+		if (info->recorder.buf != NULL) {
+			record_packet(info, mbuf);
+			continue;
+		}
+		if (compress_file_packet(info, mbuf) != SPP_RET_OK) {
+			RTE_LOG(ERR, SPP_PCAP,
+					"Failed compress_file_packet(), "
+					"errno=%d (%s)\n",
+					errno, strerror(errno));
+			ret = SPP_RET_NG;
+			info->status = SPP_CAPTURE_IDLE;
+			file_compression_operation(info, CLOSE_MODE);
+			break;
+		}
+	}
+
+	/* Free mbuf */
+	for (buf = 0; buf < nb_rx; buf++)
+		rte_pktmbuf_free(bufs[buf]);
+
+	return ret;
+}
+
 /* Output packets to file on writer thread */
 static int pcap_proc_write(int lcore_id)
 {
 	int ret = SPP_RET_OK;
-	int buf;
+	int ring;
 	int nb_rx = 0;
+	int nb_total = 0;
 	struct rte_mbuf *bufs[MAX_PCAP_BURST];
-	struct rte_mbuf *mbuf = NULL;
 	struct pcap_mng_info *info = &g_pcap_info[lcore_id];
-	struct rte_ring *read_ring = g_pcap_option.cap_ring;
+
+	/* Flight recorder can be dumped even after capture is stopped */
+	if (info->recorder.buf != NULL &&
+			unlikely(info->recorder.dump_gen != g_dump_gen))
+		dump_recorder(info);
 
 	if (g_capture_status == SPP_CAPTURE_IDLE) {
 		if (info->status == SPP_CAPTURE_IDLE)
@@ -855,19 +2972,39 @@ static int pcap_proc_write(int lcore_id)
 	if (info->status == SPP_CAPTURE_IDLE) {
 		RTE_LOG(DEBUG, SPP_PCAP, "write[%d] idle->run\n", lcore_id);
 		info->status = SPP_CAPTURE_RUNNING;
-		if (file_compression_operation(info, INIT_MODE)
+		if (info->recorder.buf == NULL &&
+				file_compression_operation(info, INIT_MODE)
 						!= SPP_RET_OK) {
 			info->status = SPP_CAPTURE_IDLE;
 			return SPP_RET_NG;
 		}
-		g_pcap_thread_info.start_up_cnt += 1;
+		rte_atomic32_inc(&g_pcap_thread_info.start_up_cnt);
 		g_total_write[lcore_id] = 0;
 	}
 
-	/* Read packets from shared ring */
-	nb_rx =  rte_ring_mc_dequeue_burst(read_ring, (void *)bufs,
-					   MAX_PCAP_BURST, NULL);
-	if (unlikely(nb_rx == 0)) {
+	/* Completed writes are reaped on each poll to keep stats current. */
+	if (info->output.fd >= 0 &&
+			reap_output_blocks(&info->output, 0) != SPP_RET_OK) {
+		info->status = SPP_CAPTURE_IDLE;
+		file_compression_operation(info, CLOSE_MODE);
+		return SPP_RET_NG;
+	}
+
+	/* Read packets from the ring of each of receive threads */
+	for (ring = 0; ring < info->num_ring; ring++) {
+		nb_rx = rte_ring_sc_dequeue_burst(info->rings[ring],
+				(void *)bufs, MAX_PCAP_BURST, NULL);
+		if (nb_rx == 0)
+			continue;
+
+		nb_total += nb_rx;
+		g_total_write[lcore_id] += nb_rx;
+		ret = write_packets(info, bufs, nb_rx);
+		if (unlikely(ret != SPP_RET_OK))
+			return ret;
+	}
+
+	if (unlikely(nb_total == 0)) {
 		if (g_capture_status == SPP_CAPTURE_IDLE) {
 			RTE_LOG(DEBUG, SPP_PCAP,
 					"Write on lcore %d, run->idle\n",
@@ -877,36 +3014,17 @@ static int pcap_proc_write(int lcore_id)
 					lcore_id, g_total_write[lcore_id]);
 
 			info->status = SPP_CAPTURE_IDLE;
-			if (g_pcap_thread_info.start_up_cnt != 0)
-				g_pcap_thread_info.start_up_cnt -= 1;
+			rte_atomic32_dec(&g_pcap_thread_info.start_up_cnt);
 			if (file_compression_operation(info, CLOSE_MODE)
 							!= SPP_RET_OK)
 				return SPP_RET_NG;
-		}
-		return SPP_RET_OK;
-	}
-
-	for (buf = 0; buf < nb_rx; buf++) {
-		mbuf = bufs[buf];
-		rte_prefetch0(rte_pktmbuf_mtod(mbuf, void *));
-		if (compress_file_packet(&g_pcap_info[lcore_id], mbuf)
-							!= SPP_RET_OK) {
-			RTE_LOG(ERR, SPP_PCAP,
-					"Failed compress_file_packet(), "
-					"errno=%d (%s)\n",
-					errno, strerror(errno));
-			ret = SPP_RET_NG;
+		} else if (flush_staging_buffer(info) != SPP_RET_OK) {
+			/* Staged records are compressed while no traffic. */
 			info->status = SPP_CAPTURE_IDLE;
 			file_compression_operation(info, CLOSE_MODE);
-			break;
+			return SPP_RET_NG;
 		}
 	}
-
-	/* Free mbuf */
-	for (buf = 0; buf < nb_rx; buf++)
-		rte_pktmbuf_free(bufs[buf]);
-
-	g_total_write[lcore_id] += nb_rx;
 	return ret;
 }
 
@@ -918,14 +3036,12 @@ slave_main(void *arg __attribute__ ((unused)))
 	unsigned int lcore_id = rte_lcore_id();
 	struct pcap_mng_info *pcap_info = &g_pcap_info[lcore_id];
 
-	if (pcap_info->thread_no == 0) {
-		RTE_LOG(INFO, SPP_PCAP, "Core[%d] Start recive.\n", lcore_id);
-		pcap_info->type = PCAP_RECEIVE;
-	} else {
+	if (pcap_info->type == PCAP_RECEIVE)
+		RTE_LOG(INFO, SPP_PCAP, "Core[%d] Start recive(%d).\n",
+					lcore_id, pcap_info->worker_no);
+	else
 		RTE_LOG(INFO, SPP_PCAP, "Core[%d] Start write(%d).\n",
-					lcore_id, pcap_info->thread_no);
-		pcap_info->type = PCAP_WRITE;
-	}
+					lcore_id, pcap_info->worker_no);
 	set_core_status(lcore_id, SPP_CORE_IDLE);
 
 	while (1) {
@@ -952,6 +3068,311 @@ slave_main(void *arg __attribute__ ((unused)))
 	return ret;
 }
 
+/**
+ * Assign the first threads as many as `--rx-threads` to receive, and the
+ * rest to write. At least one thread is required for write.
+ */
+static int
+assign_worker_threads(void)
+{
+	unsigned int lcore_id;
+	int thread_no = 0;
+	struct pcap_mng_info *info;
+
+	g_pcap_thread_info.thread_cnt = 0;
+	rte_atomic32_set(&g_pcap_thread_info.start_up_cnt, 0);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		info = &g_pcap_info[lcore_id];
+		info->thread_no = thread_no++;
+		if (info->thread_no < g_pcap_option.rx_threads) {
+			info->type = PCAP_RECEIVE;
+			info->worker_no = info->thread_no;
+		} else {
+			info->type = PCAP_WRITE;
+			info->worker_no = info->thread_no -
+					g_pcap_option.rx_threads;
+		}
+		g_pcap_thread_info.thread_cnt += 1;
+	}
+
+	if (thread_no <= g_pcap_option.rx_threads) {
+		RTE_LOG(ERR, SPP_PCAP, "Lack of lcores for write threads. "
+				"(lcores = %d, rx_threads = %d)\n",
+				thread_no, g_pcap_option.rx_threads);
+		return SPP_RET_NG;
+	}
+	return SPP_RET_OK;
+}
+
+/**
+ * Create SPSC rings between each pair of receive thread and write thread.
+ * Receive thread has rings for each of writers, and write thread has rings
+ * from each of receivers.
+ */
+static int
+create_cap_rings(void)
+{
+	unsigned int rx_lcore, wr_lcore;
+	struct pcap_mng_info *rx_info, *wr_info;
+	struct rte_ring *ring;
+	char ring_name[RTE_RING_NAMESIZE];
+
+	RTE_LCORE_FOREACH_SLAVE(rx_lcore) {
+		rx_info = &g_pcap_info[rx_lcore];
+		if (rx_info->type != PCAP_RECEIVE)
+			continue;
+
+		RTE_LCORE_FOREACH_SLAVE(wr_lcore) {
+			wr_info = &g_pcap_info[wr_lcore];
+			if (wr_info->type != PCAP_WRITE)
+				continue;
+
+			snprintf(ring_name, sizeof(ring_name),
+					"cap_ring_%d_%d_%d",
+					g_startup_param.client_id,
+					rx_info->worker_no,
+					wr_info->worker_no);
+			ring = rte_ring_create(ring_name,
+					rte_align32pow2(RING_SIZE),
+					rte_socket_id(),
+					RING_F_SP_ENQ | RING_F_SC_DEQ);
+			if (ring == NULL) {
+				RTE_LOG(ERR, SPP_PCAP,
+						"ring create error(%s).\n",
+						rte_strerror(rte_errno));
+				return SPP_RET_NG;
+			}
+			RTE_LOG(DEBUG, SPP_PCAP,
+					"Ring port name=%s, flags=0x%x\n",
+					ring->name, ring->flags);
+			rx_info->rings[rx_info->num_ring++] = ring;
+			wr_info->rings[wr_info->num_ring++] = ring;
+		}
+	}
+	return SPP_RET_OK;
+}
+
+/* Free rings between receive and write threads */
+static void
+free_cap_rings(void)
+{
+	unsigned int lcore_id;
+	struct pcap_mng_info *info;
+	int cnt;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		info = &g_pcap_info[lcore_id];
+		if (info->type == PCAP_RECEIVE) {
+			for (cnt = 0; cnt < info->num_ring; cnt++)
+				rte_ring_free(info->rings[cnt]);
+		}
+		info->num_ring = 0;
+	}
+}
+
+/**
+ * Allocate flight recorders of write threads on the socket of each lcore.
+ * Memory of `--recorder` is divided equally among writers.
+ */
+static int
+init_recorders(void)
+{
+	unsigned int lcore_id;
+	struct pcap_mng_info *info;
+	int nb_writers = 0;
+	size_t size;
+
+	if (g_pcap_option.recorder_size == 0)
+		return SPP_RET_OK;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_pcap_info[lcore_id].type == PCAP_WRITE)
+			nb_writers++;
+	}
+	size = RTE_ALIGN_FLOOR(g_pcap_option.recorder_size / nb_writers,
+			PCAP_RECORDER_ALIGN);
+	if (size < PCAP_RECORDER_MIN) {
+		RTE_LOG(ERR, SPP_PCAP, "Lack of memory for flight recorder. "
+				"(size = %lu, writers = %d)\n",
+				g_pcap_option.recorder_size, nb_writers);
+		return SPP_RET_NG;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		info = &g_pcap_info[lcore_id];
+		if (info->type != PCAP_WRITE)
+			continue;
+
+		info->recorder.buf = rte_malloc_socket("pcap_recorder", size,
+				RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(lcore_id));
+		if (info->recorder.buf == NULL) {
+			RTE_LOG(ERR, SPP_PCAP, "Cannot allocate flight "
+					"recorder. (lcore = %u, size = %lu)\n",
+					lcore_id, size);
+			return SPP_RET_NG;
+		}
+		info->recorder.size = size;
+	}
+	return SPP_RET_OK;
+}
+
+/* Free flight recorders of write threads */
+static void
+free_recorders(void)
+{
+	unsigned int lcore_id;
+	struct pcap_mng_info *info;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		info = &g_pcap_info[lcore_id];
+		rte_free(info->recorder.buf);
+		info->recorder.buf = NULL;
+	}
+}
+
+/**
+ * Allocate retention of capture files of write threads if the num or total
+ * size of files is limited. `--dir-quota` is divided equally among writers,
+ * and each share should be larger than `--fsize` for the file being written.
+ */
+static int
+init_retention(void)
+{
+	unsigned int lcore_id;
+	struct pcap_retention *ret;
+	int nb_writers = 0;
+	uint64_t quota = 0;
+	size_t cap;
+
+	if (g_pcap_option.max_files == 0 && g_pcap_option.dir_quota == 0)
+		return SPP_RET_OK;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_pcap_info[lcore_id].type == PCAP_WRITE)
+			nb_writers++;
+	}
+	if (g_pcap_option.dir_quota != 0) {
+		quota = g_pcap_option.dir_quota / nb_writers;
+		if (quota <= g_pcap_option.fsize_limit) {
+			RTE_LOG(ERR, SPP_PCAP, "Lack of dir quota for file "
+					"size. (quota = %lu, fsize = %lu, "
+					"writers = %d)\n",
+					g_pcap_option.dir_quota,
+					g_pcap_option.fsize_limit, nb_writers);
+			return SPP_RET_NG;
+		}
+	}
+
+	/* one more entry for a file completed before the oldest deleted */
+	cap = g_pcap_option.max_files != 0 ?
+			g_pcap_option.max_files + 1 : PCAP_RETAIN_FILES_INIT;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		ret = &g_pcap_info[lcore_id].retention;
+		if (g_pcap_info[lcore_id].type != PCAP_WRITE)
+			continue;
+
+		ret->files = malloc(sizeof(*ret->files) * cap);
+		if (ret->files == NULL) {
+			RTE_LOG(ERR, SPP_PCAP, "Cannot allocate retention "
+					"of files. (lcore = %u)\n", lcore_id);
+			return SPP_RET_NG;
+		}
+		ret->cap = cap;
+		ret->quota = quota;
+	}
+	return SPP_RET_OK;
+}
+
+/* Free retention of capture files of write threads */
+static void
+free_retention(void)
+{
+	unsigned int lcore_id;
+	struct pcap_retention *ret;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		ret = &g_pcap_info[lcore_id].retention;
+		free(ret->files);
+		memset(ret, 0, sizeof(*ret));
+	}
+}
+
+/**
+ * Check drops and link status of capture ports, and request dump of flight
+ * recorders if a trigger is fired. It is called from main thread and
+ * checks in every PCAP_TRIGGER_INTERVAL_MS. Triggers are fired once when
+ * the condition becomes true.
+ */
+static void
+check_dump_triggers(void)
+{
+	static uint64_t next_tsc;
+	uint64_t cur_tsc = rte_rdtsc();
+	const struct pcap_port_set *set;
+	struct pcap_port_attr *attr;
+	struct rte_eth_stats stats;
+	struct rte_eth_link link;
+	uint64_t drops;
+	int fire = 0;
+	int over;
+	int cnt;
+
+	if (g_pcap_option.recorder_size == 0 ||
+			(g_pcap_option.trigger_drops == 0 &&
+			 !g_pcap_option.trigger_linkdown))
+		return;
+	if (cur_tsc < next_tsc)
+		return;
+	next_tsc = cur_tsc +
+			rte_get_tsc_hz() * PCAP_TRIGGER_INTERVAL_MS / 1000;
+
+	set = &g_pcap_option.port_set[g_pcap_option.ref_index];
+	for (cnt = 0; cnt < set->num; cnt++) {
+		if (set->ports[cnt].iface_type != PHY)
+			continue;
+		attr = &g_pcap_option.port_attr[set->ports[cnt].dpdk_port];
+
+		if (g_pcap_option.trigger_drops != 0 &&
+				rte_eth_stats_get(set->ports[cnt].dpdk_port,
+				&stats) == 0) {
+			drops = stats.imissed + stats.rx_nombuf;
+			over = attr->drops_sampled &&
+					drops - attr->last_drops >=
+					g_pcap_option.trigger_drops;
+			if (over && !attr->drops_over &&
+					g_capture_status ==
+					SPP_CAPTURE_RUNNING) {
+				RTE_LOG(INFO, SPP_PCAP, "Drops of %s are "
+						"over threshold. (drops = "
+						"%lu)\n", attr->name,
+						drops - attr->last_drops);
+				fire = 1;
+			}
+			attr->drops_over = over;
+			attr->last_drops = drops;
+			attr->drops_sampled = 1;
+		}
+
+		if (g_pcap_option.trigger_linkdown) {
+			memset(&link, 0, sizeof(link));
+			rte_eth_link_get_nowait(set->ports[cnt].dpdk_port,
+					&link);
+			if (attr->link_up && !link.link_status &&
+					g_capture_status ==
+					SPP_CAPTURE_RUNNING) {
+				RTE_LOG(INFO, SPP_PCAP, "Link of %s is "
+						"down.\n", attr->name);
+				fire = 1;
+			}
+			attr->link_up = link.link_status;
+		}
+	}
+
+	if (fire)
+		spp_pcap_request_dump();
+}
+
 /**
  * Main function
  *
@@ -1007,7 +3428,9 @@ main(int argc, char *argv[])
 		if (unlikely(ret_mng != 0))
 			break;
 
-		spp_port_ability_init();
+		int ret_ability_init = spp_port_ability_init();
+		if (unlikely(ret_ability_init != SPP_RET_OK))
+			break;
 
 		/* Setup connection for accepting commands from controller */
 		int ret_command_init = spp_command_proc_init(
@@ -1016,71 +3439,42 @@ main(int argc, char *argv[])
 		if (unlikely(ret_command_init != SPP_RET_OK))
 			break;
 
-		/* capture port setup */
-		struct spp_port_info *port_cap = &g_pcap_option.port_cap;
-		struct spp_port_info *port_info = get_iface_info(
-						port_cap->iface_type,
-						port_cap->iface_no);
-		if (port_info == NULL) {
-			RTE_LOG(ERR, SPP_PCAP, "caputre port undefined.\n");
+		/* capture filter setup */
+		if (setup_capture_filter() != SPP_RET_OK)
 			break;
-		}
-		if (port_cap->iface_type == PHY) {
-			if (port_info->iface_type != UNDEF)
-				port_cap->dpdk_port = port_info->dpdk_port;
-			else {
-				RTE_LOG(ERR, SPP_PCAP,
-					"caputre port undefined.(phy:%d)\n",
-							port_cap->iface_no);
-				break;
-			}
-		} else {
-			if (port_info->iface_type == UNDEF) {
-				ret = add_ring_pmd(port_info->iface_no);
-				if (ret == SPP_RET_NG) {
-					RTE_LOG(ERR, SPP_PCAP, "caputre port "
-						"undefined.(ring:%d)\n",
-						port_cap->iface_no);
-					break;
-				}
-				port_cap->dpdk_port = ret;
-			} else {
-				RTE_LOG(ERR, SPP_PCAP, "caputre port "
-						"undefined.(ring:%d)\n",
-						port_cap->iface_no);
+
+		/* capture ports setup */
+		int cnt_port;
+		struct pcap_port_set *set = &g_pcap_option.port_set[0];
+		for (cnt_port = 0; cnt_port < set->num; cnt_port++) {
+			if (setup_capture_port(&set->ports[cnt_port]) !=
+					SPP_RET_OK)
 				break;
-			}
+			number_port_queues(set, cnt_port);
 		}
-		RTE_LOG(DEBUG, SPP_PCAP,
-				"Recv port type=%d, no=%d, port_id=%d\n",
-				port_cap->iface_type, port_cap->iface_no,
-				port_cap->dpdk_port);
-
-		/* create ring */
-		char ring_name[PORT_STR_SIZE];
-		memset(ring_name, 0x00, PORT_STR_SIZE);
-		snprintf(ring_name, PORT_STR_SIZE,  "cap_ring_%d",
-						g_startup_param.client_id);
-		g_pcap_option.cap_ring = rte_ring_create(ring_name,
-					rte_align32pow2(RING_SIZE),
-					rte_socket_id(), 0);
-		if (g_pcap_option.cap_ring == NULL) {
-			RTE_LOG(ERR, SPP_PCAP, "ring create error(%s).\n",
-						rte_strerror(rte_errno));
+		if (cnt_port < set->num)
+			break;
+
+		/* Assign receive or write to worker threads */
+		if (assign_worker_threads() != SPP_RET_OK)
+			break;
+
+		/* create rings between receive and write threads */
+		if (create_cap_rings() != SPP_RET_OK)
+			break;
+
+		/* allocate flight recorders of write threads */
+		if (init_recorders() != SPP_RET_OK)
+			break;
+
+		/* allocate retention of capture files of write threads */
+		if (init_retention() != SPP_RET_OK)
 			break;
-		}
-		RTE_LOG(DEBUG, SPP_PCAP, "Ring port name=%s, flags=0x%x\n",
-				g_pcap_option.cap_ring->name,
-				g_pcap_option.cap_ring->flags);
 
 		/* Start worker threads of recive or write */
 		unsigned int lcore_id = 0;
-		unsigned int thread_no = 0;
-		g_pcap_thread_info.thread_cnt = 0;
-		g_pcap_thread_info.start_up_cnt = 0;
 		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
-			g_pcap_thread_info.thread_cnt += 1;
-			g_pcap_info[lcore_id].thread_no = thread_no++;
+			g_pcap_info[lcore_id].output.fd = -1;
 			rte_eal_remote_launch(slave_main, NULL, lcore_id);
 		}
 
@@ -1103,6 +3497,9 @@ main(int argc, char *argv[])
 			if (unlikely(ret_do != SPP_RET_OK))
 				break;
 
+			/* Dump flight recorders if triggered */
+			check_dump_triggers();
+
 			/*
 			 * Wait to avoid CPU overloaded.
 			 */
@@ -1126,8 +3523,16 @@ main(int argc, char *argv[])
 			RTE_LOG(ERR, SPP_PCAP, "Core did not stop.\n");
 
 		/* capture write ring free */
-		if (g_pcap_option.cap_ring != NULL)
-			rte_ring_free(g_pcap_option.cap_ring);
+		free_cap_rings();
+
+		/* flight recorder free */
+		free_recorders();
+
+		/* retention of capture files free */
+		free_retention();
+
+		/* capture filter free */
+		release_capture_filter();
 	}
 
 
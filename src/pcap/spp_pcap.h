@@ -6,6 +6,8 @@
 #define __SPP_PCAP_H__
 
 #include "spp_proc.h"
+#include "command_dec.h"
+#include "codec.h"
 
 /**
  * @file
@@ -32,4 +34,169 @@ int spp_pcap_get_core_status(
 		unsigned int lcore_id,
 		struct spp_iterate_core_params *params);
 
+/**
+ * Update capture ports
+ *
+ * Capture port is added to or deleted from the ports polled by receive
+ * thread. It can be updated while capturing.
+ *
+ * @param action
+ *  Action of update, SPP_CMD_ACTION_ADD or SPP_CMD_ACTION_DEL.
+ * @param port
+ *  The pointer to struct spp_port_index of capture port.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed.
+ */
+int spp_pcap_update_port(
+		enum spp_command_action action,
+		const struct spp_port_index *port);
+
+/**
+ * Set snaplen of capture files
+ *
+ * Packets longer than snaplen are truncated. If it is changed while
+ * capturing, writer threads start new files.
+ *
+ * @param snaplen
+ *  Max length of captured packets, from 1 to 65535.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if snaplen is out of range.
+ */
+int spp_pcap_set_snaplen(uint32_t snaplen);
+
+/**
+ * Get snaplen of capture files
+ *
+ * @return
+ *  Max length of captured packets.
+ */
+uint32_t spp_pcap_get_snaplen(void);
+
+/**
+ * Set codec of capture files, which is applied from the next capture.
+ *
+ * @param conf
+ *  The pointer to struct spp_pcap_codec_conf.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if capture is running.
+ */
+int spp_pcap_set_codec(const struct spp_pcap_codec_conf *conf);
+
+/**
+ * Get codec of capture files
+ *
+ * @param conf
+ *  The pointer to struct spp_pcap_codec_conf.@n
+ *  Codec of the next capture is copied to it.
+ */
+void spp_pcap_get_codec(struct spp_pcap_codec_conf *conf);
+
+/** Statistics of asynchronous file writes of writer thread */
+struct spp_pcap_write_stats {
+	uint64_t writes;        /**< Num of blocks written */
+	uint64_t latency_total; /**< Total latency of writes in usec */
+	uint64_t latency_max;   /**< Max latency of writes in usec */
+	unsigned int queue_depth;     /**< Num of blocks in flight */
+	unsigned int queue_depth_max; /**< Max num of blocks in flight */
+	uint64_t stalls;  /**< Num of waits for completion of a block */
+};
+
+/**
+ * Get statistics of file writes of writer thread
+ *
+ * @param lcore_id
+ *  The logical core ID of writer thread.
+ * @param stats
+ *  The pointer to struct spp_pcap_write_stats.@n
+ *  Statistics are copied to it.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if lcore is not a writer.
+ */
+int spp_pcap_get_write_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_write_stats *stats);
+
+/** Counters of capture filter of receive thread */
+struct spp_pcap_filter_stats {
+	const char *expression; /**< Filter expression */
+	uint64_t pass;          /**< Num of packets matched and captured */
+	uint64_t drop;          /**< Num of packets not matched and freed */
+};
+
+/**
+ * Get counters of capture filter of receive thread
+ *
+ * @param lcore_id
+ *  The logical core ID of receive thread.
+ * @param stats
+ *  The pointer to struct spp_pcap_filter_stats.@n
+ *  Counters are copied to it.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if lcore is not a receiver or no filter.
+ */
+int spp_pcap_get_filter_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_filter_stats *stats);
+
+/**
+ * Get statistics of compression of writer thread
+ *
+ * @param lcore_id
+ *  The logical core ID of writer thread.
+ * @param conf
+ *  The pointer to struct spp_pcap_codec_conf.@n
+ *  Codec used in the current or last capture is copied to it.
+ * @param stats
+ *  The pointer to struct spp_pcap_codec_stats.@n
+ *  Statistics of the capture are copied to it.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if lcore is not a writer.
+ */
+int spp_pcap_get_codec_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_codec_conf *conf,
+		struct spp_pcap_codec_stats *stats);
+
+/**
+ * Request write threads to dump packets kept in flight recorders
+ *
+ * Packets are written to capture files named with the time of request,
+ * and flight recorders are emptied.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if flight recorder is not enabled or previous
+ *  dump is not completed.
+ */
+int spp_pcap_request_dump(void);
+
+/** Statistics of flight recorder of writer thread */
+struct spp_pcap_recorder_stats {
+	uint64_t size;     /**< Size of memory of flight recorder */
+	uint64_t used;     /**< Bytes used by packets kept */
+	uint64_t packets;  /**< Num of packets kept */
+	uint64_t dumps;    /**< Num of dumps completed */
+};
+
+/**
+ * Get statistics of flight recorder of writer thread
+ *
+ * @param lcore_id
+ *  The logical core ID of writer thread.
+ * @param stats
+ *  The pointer to struct spp_pcap_recorder_stats.@n
+ *  Statistics of flight recorder are copied to it.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed, if lcore is not a writer or no recorder.
+ */
+int spp_pcap_get_recorder_stats(
+		unsigned int lcore_id,
+		struct spp_pcap_recorder_stats *stats);
+
 #endif /* __SPP_PCAP_H__ */
@@ -257,6 +257,57 @@ int spp_format_port_string(char *port, enum port_type iface_type, int iface_no)
 	return SPP_RET_OK;
 }
 
+/**
+ * Separate port id of combination of iface type and number and
+ * assign to given argument, iface_type and iface_no.
+ *
+ * For instance, 'ring:0' is separated to 'ring' and '0'.
+ */
+int
+spp_convert_port_to_iface(const char *port, enum port_type *iface_type,
+		int *iface_no)
+{
+	enum port_type type = UNDEF;
+	const char *no_str = NULL;
+	char *endptr = NULL;
+
+	/* Find out which type of interface from port */
+	if (strncmp(port, SPP_IFTYPE_NIC_STR ":",
+			strlen(SPP_IFTYPE_NIC_STR)+1) == 0) {
+		/* NIC */
+		type = PHY;
+		no_str = &port[strlen(SPP_IFTYPE_NIC_STR)+1];
+	} else if (strncmp(port, SPP_IFTYPE_RING_STR ":",
+			strlen(SPP_IFTYPE_RING_STR)+1) == 0) {
+		/* RING */
+		type = RING;
+		no_str = &port[strlen(SPP_IFTYPE_RING_STR)+1];
+	} else {
+		/* OTHER */
+		RTE_LOG(ERR, SPP_PROC, "The interface that does not suppor. "
+					"(port = %s)\n", port);
+		return SPP_RET_NG;
+	}
+
+	/* Convert from string to number */
+	int ret_no = strtol(no_str, &endptr, 0);
+	if (unlikely(no_str == endptr) || unlikely(*endptr != '\0') ||
+			unlikely(ret_no < 0) ||
+			unlikely(ret_no >= RTE_MAX_ETHPORTS)) {
+		/* No IF number */
+		RTE_LOG(ERR, SPP_PROC, "No interface number. (port = %s)\n",
+								port);
+		return SPP_RET_NG;
+	}
+
+	*iface_type = type;
+	*iface_no = ret_no;
+
+	RTE_LOG(DEBUG, SPP_PROC, "Port = %s => Type = %d No = %d\n",
+					port, *iface_type, *iface_no);
+	return SPP_RET_OK;
+}
+
 /* Set mange data address */
 int spp_set_mng_data_addr(struct startup_param *startup_param_addr,
 			  struct iface_info *iface_addr,
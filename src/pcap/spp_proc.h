@@ -92,7 +92,20 @@ enum SPP_LONGOPT_RETVAL {
 	 */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,  /* --client-id */
 	SPP_LONGOPT_RETVAL_OUT_DIR,    /* --out-dir */
-	SPP_LONGOPT_RETVAL_FILE_SIZE   /* --fsize */
+	SPP_LONGOPT_RETVAL_FILE_SIZE,  /* --fsize */
+	SPP_LONGOPT_RETVAL_FORMAT,     /* --format */
+	SPP_LONGOPT_RETVAL_RX_THREADS, /* --rx-threads */
+	SPP_LONGOPT_RETVAL_FILTER,     /* --filter */
+	SPP_LONGOPT_RETVAL_SNAPLEN,    /* --snaplen */
+	SPP_LONGOPT_RETVAL_CODEC,      /* --codec */
+	SPP_LONGOPT_RETVAL_RECORDER,   /* --recorder */
+	SPP_LONGOPT_RETVAL_RECORDER_TIME,    /* --recorder-time */
+	SPP_LONGOPT_RETVAL_DUMP_ON_DROPS,    /* --dump-on-drops */
+	SPP_LONGOPT_RETVAL_DUMP_ON_LINKDOWN, /* --dump-on-linkdown */
+	SPP_LONGOPT_RETVAL_ROTATE_INTERVAL,  /* --rotate-interval */
+	SPP_LONGOPT_RETVAL_MAX_FILES,  /* --max-files */
+	SPP_LONGOPT_RETVAL_DIR_QUOTA,  /* --dir-quota */
+	SPP_LONGOPT_RETVAL_INDEX       /* --index */
 };
 
 /* Interface information structure */
@@ -340,6 +353,23 @@ spp_format_port_string(char *port, enum port_type iface_type, int iface_no);
 int
 spp_format_port_string(char *port, enum port_type iface_type, int iface_no);
 
+/**
+ * Convert string of port to iface type and number
+ *
+ * @param port
+ *  Character string of port, such as 'phy:0' or 'ring:1'.
+ * @param iface_type
+ *  The pointer to store port interface type.
+ * @param iface_no
+ *  The pointer to store interface no.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed.
+ */
+int
+spp_convert_port_to_iface(const char *port, enum port_type *iface_type,
+		int *iface_no);
+
 /**
  * Set mange data address
  *
@@ -269,9 +269,14 @@ init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool)
 	fflush(stdout);
 
 	rte_eth_dev_info_get(port_num, &dev_info);
-	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_MBUF_FAST_FREE)
+	/*
+	 * DEV_TX_OFFLOAD_MBUF_FAST_FREE is not enabled because secondaries
+	 * send mbufs of which refcnt is not 1, such as clones of spp_mirror.
+	 */
+	/* Used by secondaries for adding VLAN tag */
+	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_VLAN_INSERT)
 		local_port_conf.txmode.offloads |=
-			DEV_TX_OFFLOAD_MBUF_FAST_FREE;
+			DEV_TX_OFFLOAD_VLAN_INSERT;
 	txq_conf = dev_info.default_txconf;
 	txq_conf.offloads = local_port_conf.txmode.offloads;
 
@@ -280,7 +285,7 @@ init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool)
 	 * rx and tx rings
 	 */
 	retval = rte_eth_dev_configure(port_num, rx_rings, tx_rings,
-		&port_conf);
+		&local_port_conf);
 	if (retval != 0)
 		return retval;
 
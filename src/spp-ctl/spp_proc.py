@@ -85,7 +85,19 @@ APP_OPTS = {
             '-s',  # address and port
             '-c',  # captured port
             '--out-dir',  # captured file dir
-            '--fsize'  # max size of captured file
+            '--fsize',  # max size of captured file
+            '--format',  # format of captured file
+            '--rx-threads',  # num of receive threads
+            '--snaplen',  # max length of captured packets
+            '--codec',  # compression codec of capture files
+            '--recorder',  # memory of flight recorder in MiB
+            '--recorder-time',  # max age of packets dumped from recorder
+            '--dump-on-drops',  # drops per second to trigger dump
+            '--dump-on-linkdown',  # trigger dump if link goes down
+            '--rotate-interval',  # seconds to rotate capture files
+            '--max-files',  # max num of files kept for each writer
+            '--dir-quota',  # max total size of files in out dir
+            '--index'  # write index of capture files
             ]}
 
 
@@ -173,6 +185,11 @@ class VfCommon(SppProc):
     def stop_component(self, comp_name):
         return "component stop {comp_name}".format(**locals())
 
+    @exec_command
+    def move_component(self, comp_name, core_id):
+        return ("component move {comp_name} {core_id}"
+                .format(**locals()))
+
     @exec_command
     def port_del(self, port, direction, comp_name):
         return "port del {port} {direction} {comp_name}".format(**locals())
@@ -200,6 +217,14 @@ class VfProc(VfCommon):
                 command += " %d %d" % (vlan_id, pcp)
         return command
 
+    @exec_command
+    def port_add_ability(self, port, direction, comp_name, op, args):
+        command = ("port add {port} {direction} {comp_name} {op}"
+                   .format(**locals()))
+        for arg in args:
+            command += " %s" % arg
+        return command
+
     @exec_command
     def set_classifier_table(self, mac_address, port):
         return ("classifier_table add mac {mac_address} {port}"
@@ -236,6 +261,29 @@ class MirrorProc(VfCommon):
     def port_add(self, port, direction, comp_name):
         return "port add {port} {direction} {comp_name}".format(**locals())
 
+    @exec_command
+    def start_component(self, comp_name, core_id, comp_type,
+                        copy_mode=None):
+        cmd = ("component start {comp_name} {core_id} {comp_type}"
+               .format(**locals()))
+        if copy_mode is not None:
+            cmd += " {}".format(copy_mode)
+        return cmd
+
+    @exec_command
+    def filter_add(self, comp_name, filter_type, value):
+        return ("filter add {comp_name} {filter_type} {value}"
+                .format(**locals()))
+
+    @exec_command
+    def filter_del(self, comp_name, filter_type, value):
+        return ("filter del {comp_name} {filter_type} {value}"
+                .format(**locals()))
+
+    @exec_command
+    def set_snaplen(self, comp_name, snaplen):
+        return "snaplen {comp_name} {snaplen}".format(**locals())
+
 
 class NfvProc(SppProc):
 
@@ -366,6 +414,26 @@ class PcapProc(SppProc):
     def stop(self):
         return "stop"
 
+    @exec_command
+    def dump(self):
+        return "dump"
+
+    @exec_command
+    def port_add(self, port):
+        return "port add {port}".format(**locals())
+
+    @exec_command
+    def port_del(self, port):
+        return "port del {port}".format(**locals())
+
+    @exec_command
+    def set_snaplen(self, snaplen):
+        return "snaplen {snaplen}".format(**locals())
+
+    @exec_command
+    def set_codec(self, codec):
+        return "codec {codec}".format(**locals())
+
     @exec_command
     def do_exit(self):
         return "exit"
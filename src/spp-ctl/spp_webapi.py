@@ -190,6 +190,12 @@ class V1VFCommon(object):
         if body['type'] not in types:
             raise KeyInvalid('type', body['type'])
 
+    def validate_comp_move(self, body):
+        if 'core' not in body:
+            raise KeyRequired('core')
+        if not isinstance(body['core'], int):
+            raise KeyInvalid('core', body['core'])
+
     def validate_comp_port(self, body):
         for key in ['action', 'port', 'dir']:
             if key not in body:
@@ -224,6 +230,8 @@ class V1VFHandler(BaseHandler, V1VFCommon):
                    callback=self.vf_comp_start)
         self.route('/<sec_id:int>/components/<name>', 'DELETE',
                    callback=self.vf_comp_stop)
+        self.route('/<sec_id:int>/components/<name>', 'PUT',
+                   callback=self.vf_comp_move)
         self.route('/<sec_id:int>/components/<name>/ports', 'PUT',
                    callback=self.vf_comp_port)
         self.route('/<sec_id:int>/classifier_table', 'PUT',
@@ -239,6 +247,10 @@ class V1VFHandler(BaseHandler, V1VFCommon):
     def vf_comp_stop(self, proc, name):
         proc.stop_component(name)
 
+    def vf_comp_move(self, proc, name, body):
+        self.validate_comp_move(body)
+        proc.move_component(name, body['core'])
+
     def _validate_vf_comp_port(self, body):
         self.validate_comp_port(body)
         if body['action'] == "attach":
@@ -252,11 +264,54 @@ class V1VFHandler(BaseHandler, V1VFCommon):
                         int(vlan['pcp'])
                 except:
                     raise KeyInvalid('vlan', vlan)
+            ability = body.get('ability')
+            if ability:
+                try:
+                    self._get_ability_args(ability)
+                except:
+                    raise KeyInvalid('ability', ability)
+
+    def _get_ability_args(self, ability):
+        """Get arguments of spp_vf command from ability param."""
+
+        op = ability['operation']
+        if op == "add_qinq":
+            return [int(ability['id']), int(ability['pcp'])]
+        elif op in ["set_src_mac", "set_dst_mac"]:
+            self._validate_mac(ability['mac'])
+            return [ability['mac']]
+        elif op == "set_dscp":
+            return [int(ability['dscp'])]
+        elif op in ["del_qinq", "dec_ttl"]:
+            return []
+        elif op == "police_srtcm":
+            return [int(ability[k]) for k in ['cir', 'cbs', 'ebs']]
+        elif op == "police_trtcm":
+            return [int(ability[k]) for k in ['cir', 'pir', 'cbs', 'pbs']]
+        elif op == "police_tb":
+            if ability['unit'] not in ["pps", "bps"]:
+                raise ValueError(ability['unit'])
+            return [ability['unit'], int(ability['rate']),
+                    int(ability['burst'])]
+        elif op == "sample":
+            if not ability['ring'].startswith("ring:"):
+                raise ValueError(ability['ring'])
+            self._validate_port(ability['ring'])
+            if ability['mode'] not in ["every", "random"]:
+                raise ValueError(ability['mode'])
+            return [ability['ring'], ability['mode'], int(ability['rate']),
+                    int(ability['snaplen'])]
+        raise ValueError(op)
 
     def vf_comp_port(self, proc, name, body):
         self._validate_vf_comp_port(body)
 
-        if body['action'] == "attach":
+        if body['action'] == "attach" and body.get('ability'):
+            ability = body['ability']
+            proc.port_add_ability(body['port'], body['dir'], name,
+                                  ability['operation'],
+                                  self._get_ability_args(ability))
+        elif body['action'] == "attach":
             op = "none"
             vlan_id = 0
             pcp = 0
@@ -337,19 +392,40 @@ class V1MirrorHandler(BaseHandler, V1VFCommon):
                    callback=self.mirror_comp_start)
         self.route('/<sec_id:int>/components/<name>', 'DELETE',
                    callback=self.mirror_comp_stop)
+        self.route('/<sec_id:int>/components/<name>', 'PUT',
+                   callback=self.mirror_comp_update)
         self.route('/<sec_id:int>/components/<name>/ports', 'PUT',
                    callback=self.mirror_comp_port)
+        self.route('/<sec_id:int>/components/<name>/filters', 'PUT',
+                   callback=self.mirror_comp_filter)
 
     def mirror_get(self, proc):
         return self.convert_info(proc.get_status())
 
-    def mirror_comp_start(self, proc, body):
+    def _validate_mirror_comp_start(self, body):
         self.validate_comp_start(body, ["mirror"])
-        proc.start_component(body['name'], body['core'], body['type'])
+        if 'copy_mode' in body:
+            if body['copy_mode'] not in ["shallow", "deep"]:
+                raise KeyInvalid('copy_mode', body['copy_mode'])
+
+    def mirror_comp_start(self, proc, body):
+        self._validate_mirror_comp_start(body)
+        proc.start_component(body['name'], body['core'], body['type'],
+                             body.get('copy_mode'))
 
     def mirror_comp_stop(self, proc, name):
         proc.stop_component(name)
 
+    def _validate_mirror_comp_update(self, body):
+        if 'snaplen' not in body:
+            raise KeyRequired('snaplen')
+        if not isinstance(body['snaplen'], int) or body['snaplen'] < 0:
+            raise KeyInvalid('snaplen', body['snaplen'])
+
+    def mirror_comp_update(self, proc, name, body):
+        self._validate_mirror_comp_update(body)
+        proc.set_snaplen(name, body['snaplen'])
+
     def mirror_comp_port(self, proc, name, body):
         self.validate_comp_port(body)
         if body['action'] == "attach":
@@ -357,6 +433,26 @@ class V1MirrorHandler(BaseHandler, V1VFCommon):
         else:
             proc.port_del(body['port'], body['dir'], name)
 
+    def _validate_mirror_comp_filter(self, body):
+        for key in ['action', 'type', 'value']:
+            if key not in body:
+                raise KeyRequired(key)
+        if body['action'] not in ["add", "del"]:
+            raise KeyInvalid('action', body['action'])
+        if body['type'] not in ["mac", "vlan", "ether_type", "ip",
+                                "l4_port", "bpf"]:
+            raise KeyInvalid('type', body['type'])
+        value = str(body['value'])
+        if not value or ' ' in value:
+            raise KeyInvalid('value', body['value'])
+
+    def mirror_comp_filter(self, proc, name, body):
+        self._validate_mirror_comp_filter(body)
+        if body['action'] == "add":
+            proc.filter_add(name, body['type'], body['value'])
+        else:
+            proc.filter_del(name, body['type'], body['value'])
+
 
 class V1NFVHandler(BaseHandler):
 
@@ -501,6 +597,11 @@ class V1PcapHandler(BaseHandler):
         self.route('/<sec_id:int>', 'GET', callback=self.pcap_get)
         self.route('/<sec_id:int>', 'DELETE', callback=self.pcap_exit)
         self.route('/<sec_id:int>/capture', 'PUT', callback=self.pcap_action)
+        self.route('/<sec_id:int>/ports', 'PUT', callback=self.pcap_port)
+        self.route('/<sec_id:int>/snaplen', 'PUT',
+                   callback=self.pcap_snaplen)
+        self.route('/<sec_id:int>/codec', 'PUT',
+                   callback=self.pcap_codec)
 
     def pcap_get(self, proc):
         return proc.get_status()["info"]
@@ -508,16 +609,55 @@ class V1PcapHandler(BaseHandler):
     def _validate_pcap_action(self, body):
         if 'action' not in body:
             raise KeyRequired('action')
-        if body['action'] not in ["start", "stop"]:
+        if body['action'] not in ["start", "stop", "dump"]:
             raise KeyInvalid('action', body['action'])
 
     def pcap_action(self, proc, body):
         self._validate_pcap_action(body)
         if body['action'] == "start":
             proc.start()
+        elif body['action'] == "dump":
+            proc.dump()
         else:
             proc.stop()
 
+    def _validate_pcap_port(self, body):
+        for key in ['action', 'port']:
+            if key not in body:
+                raise KeyRequired(key)
+        if body['action'] not in ["add", "del"]:
+            raise KeyInvalid('action', body['action'])
+        self._validate_port(body['port'])
+
+    def pcap_port(self, proc, body):
+        self._validate_pcap_port(body)
+        if body['action'] == "add":
+            proc.port_add(body['port'])
+        else:
+            proc.port_del(body['port'])
+
+    def _validate_pcap_snaplen(self, body):
+        if 'snaplen' not in body:
+            raise KeyRequired('snaplen')
+        if (not isinstance(body['snaplen'], int) or
+                not 0 < body['snaplen'] <= 65535):
+            raise KeyInvalid('snaplen', body['snaplen'])
+
+    def pcap_snaplen(self, proc, body):
+        self._validate_pcap_snaplen(body)
+        proc.set_snaplen(body['snaplen'])
+
+    def _validate_pcap_codec(self, body):
+        if 'codec' not in body:
+            raise KeyRequired('codec')
+        if (not isinstance(body['codec'], str) or
+                not body['codec'] or ' ' in body['codec']):
+            raise KeyInvalid('codec', body['codec'])
+
+    def pcap_codec(self, proc, body):
+        self._validate_pcap_codec(body)
+        proc.set_codec(body['codec'])
+
     def pcap_exit(self, proc):
         self.ctrl.do_exit(proc.type, proc.id)
         proc.do_exit()
@@ -0,0 +1,307 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+/**
+ * Microbenchmark of port abilities.
+ *
+ * Cycles per packet of each mode of port abilities are measured without
+ * any device. spp_port.c is included to call its static functions, and
+ * offloads of the device are emulated by flags of the port. Burst kernels
+ * of VLAN operation are also compared with the scalar path.
+ *
+ *   $ sudo ./build/port_ability_bench -l 1 --no-pci -- [-n ITERATIONS]
+ */
+
+#include <getopt.h>
+#include <rte_eal.h>
+#include <rte_net_crc.h>
+
+#include "../spp_port.c"
+
+/* Number of packets given to port ability at once. */
+#define BENCH_BURST 32
+
+/* Default number of bursts measured for each case. */
+#define BENCH_ITERATIONS 100000
+
+/* Number of mbufs in the pool. */
+#define BENCH_NB_MBUF 1023
+
+/* Length of frames without VLAN tag. */
+#define BENCH_PKT_LEN 64
+
+/* Port ID and VLAN ID used for benchmark. */
+#define BENCH_PORT_ID 0
+#define BENCH_VID     101
+
+/* Burst kernel of VLAN operation used in the case */
+enum bench_kernel {
+	BENCH_KERNEL_DEFAULT, /* Selected by CPU flags */
+	BENCH_KERNEL_SCALAR,  /* Not used */
+	BENCH_KERNEL_SSE,     /* SSE4.1 */
+	BENCH_KERNEL_AVX2,    /* AVX2 */
+};
+
+/* Case of benchmark */
+struct bench_case {
+	const char *name;              /* Name of the case */
+	enum spp_port_rxtx rxtx;       /* Direction of port ability */
+	enum spp_port_ability_ope ope; /* Operation of port ability */
+	int offload;                   /* VLAN offload is enabled */
+	int fcs;                       /* FCS is calculated as before */
+	enum bench_kernel kernel;      /* Burst kernel of VLAN operation */
+};
+
+static const struct bench_case g_bench_cases[] = {
+	{ "add_vlantag (software)", SPP_PORT_RXTX_TX,
+		SPP_PORT_ABILITY_OPE_ADD_VLANTAG, 0, 0,
+		BENCH_KERNEL_DEFAULT },
+	{ "add_vlantag (software with FCS)", SPP_PORT_RXTX_TX,
+		SPP_PORT_ABILITY_OPE_ADD_VLANTAG, 0, 1,
+		BENCH_KERNEL_DEFAULT },
+	{ "add_vlantag (offload)", SPP_PORT_RXTX_TX,
+		SPP_PORT_ABILITY_OPE_ADD_VLANTAG, 1, 0,
+		BENCH_KERNEL_DEFAULT },
+	{ "add_vlantag (scalar)", SPP_PORT_RXTX_TX,
+		SPP_PORT_ABILITY_OPE_ADD_VLANTAG, 0, 0,
+		BENCH_KERNEL_SCALAR },
+	{ "add_vlantag (SSE4.1)", SPP_PORT_RXTX_TX,
+		SPP_PORT_ABILITY_OPE_ADD_VLANTAG, 0, 0,
+		BENCH_KERNEL_SSE },
+	{ "add_vlantag (AVX2)", SPP_PORT_RXTX_TX,
+		SPP_PORT_ABILITY_OPE_ADD_VLANTAG, 0, 0,
+		BENCH_KERNEL_AVX2 },
+	{ "del_vlantag (software)", SPP_PORT_RXTX_RX,
+		SPP_PORT_ABILITY_OPE_DEL_VLANTAG, 0, 0,
+		BENCH_KERNEL_DEFAULT },
+	{ "del_vlantag (software with FCS)", SPP_PORT_RXTX_RX,
+		SPP_PORT_ABILITY_OPE_DEL_VLANTAG, 0, 1,
+		BENCH_KERNEL_DEFAULT },
+	{ "del_vlantag (offload)", SPP_PORT_RXTX_RX,
+		SPP_PORT_ABILITY_OPE_DEL_VLANTAG, 1, 0,
+		BENCH_KERNEL_DEFAULT },
+	{ "del_vlantag (scalar)", SPP_PORT_RXTX_RX,
+		SPP_PORT_ABILITY_OPE_DEL_VLANTAG, 0, 0,
+		BENCH_KERNEL_SCALAR },
+	{ "del_vlantag (SSE4.1)", SPP_PORT_RXTX_RX,
+		SPP_PORT_ABILITY_OPE_DEL_VLANTAG, 0, 0,
+		BENCH_KERNEL_SSE },
+	{ "del_vlantag (AVX2)", SPP_PORT_RXTX_RX,
+		SPP_PORT_ABILITY_OPE_DEL_VLANTAG, 0, 0,
+		BENCH_KERNEL_AVX2 },
+};
+
+/* Burst kernels selected by CPU flags at initialization. */
+static struct port_ability_burst g_bench_add_kernel;
+static struct port_ability_burst g_bench_del_kernel;
+
+/* Result of FCS which is not used, only to keep the calculation. */
+static volatile uint32_t g_fcs_sink;
+
+/* Select burst kernels of VLAN operation, or fail if not supported. */
+static int
+bench_select_kernel(enum bench_kernel kernel)
+{
+	g_add_vlantag_burst = g_bench_add_kernel;
+	g_del_vlantag_burst = g_bench_del_kernel;
+
+	switch (kernel) {
+	case BENCH_KERNEL_SCALAR:
+		g_add_vlantag_burst.func = NULL;
+		g_del_vlantag_burst.func = NULL;
+		break;
+	case BENCH_KERNEL_SSE:
+#ifdef RTE_ARCH_X86
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1) > 0) {
+			g_add_vlantag_burst.func = add_vlantag_burst_sse;
+			g_add_vlantag_burst.num  = SPP_VLAN_BURST_SSE_NUM;
+			g_del_vlantag_burst.func = del_vlantag_burst_sse;
+			g_del_vlantag_burst.num  = SPP_VLAN_BURST_SSE_NUM;
+			break;
+		}
+#endif /* RTE_ARCH_X86 */
+		return SPP_RET_NG;
+	case BENCH_KERNEL_AVX2:
+#ifdef RTE_ARCH_X86
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0) {
+			g_add_vlantag_burst.func = add_vlantag_burst_avx2;
+			g_add_vlantag_burst.num  = SPP_VLAN_BURST_AVX2_NUM;
+			g_del_vlantag_burst.func = del_vlantag_burst_avx2;
+			g_del_vlantag_burst.num  = SPP_VLAN_BURST_AVX2_NUM;
+			break;
+		}
+#endif /* RTE_ARCH_X86 */
+		return SPP_RET_NG;
+	default:
+		break;
+	}
+	return SPP_RET_OK;
+}
+
+/* Compile port ability of the case to the table of benchmark port. */
+static void
+bench_setup_case(const struct bench_case *bcase)
+{
+	struct port_ability_port_mng_info *port_mng =
+			&g_port_mng_info[BENCH_PORT_ID];
+	struct port_ability_mng_info *mng =
+			port_ability_get_mng_info(BENCH_PORT_ID, bcase->rxtx);
+	struct port_ability_table *table = mng->cur;
+	struct spp_vlantag_info *tag = &table->ability[0].data.vlantag;
+
+	port_mng->tx_vlan_insert = bcase->offload;
+	port_mng->rx_vlan_strip = bcase->offload;
+
+	memset(table->ability, 0x00, sizeof(table->ability));
+	table->ability[0].ope = bcase->ope;
+	table->ability[0].rxtx = bcase->rxtx;
+	tag->vid = BENCH_VID;
+	tag->tci = rte_cpu_to_be_16(SPP_VLANTAG_CALC_TCI(BENCH_VID, 0));
+	port_ability_compile_chain(port_mng, mng, table, bcase->rxtx);
+}
+
+/*
+ * Reset packets to the frames given to port ability of the case. Frames
+ * for del_vlantag are tagged, or stripped by the device with offload.
+ */
+static void
+bench_reset_packets(struct rte_mbuf **pkts, const struct bench_case *bcase)
+{
+	int cnt;
+	int tagged = 0;
+	uint16_t len = BENCH_PKT_LEN;
+	struct ether_hdr *ether = NULL;
+	struct vlan_hdr *vlan = NULL;
+
+	if (bcase->ope == SPP_PORT_ABILITY_OPE_DEL_VLANTAG && !bcase->offload) {
+		tagged = 1;
+		len += sizeof(struct vlan_hdr);
+	}
+
+	for (cnt = 0; cnt < BENCH_BURST; cnt++) {
+		rte_pktmbuf_reset(pkts[cnt]);
+		ether = (struct ether_hdr *)rte_pktmbuf_append(pkts[cnt], len);
+		memset(ether, 0x00, len);
+		ether->d_addr.addr_bytes[5] = 0x01;
+		ether->s_addr.addr_bytes[5] = 0x02;
+		ether->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		if (tagged) {
+			vlan = (struct vlan_hdr *)&ether[1];
+			vlan->eth_proto = ether->ether_type;
+			vlan->vlan_tci = rte_cpu_to_be_16(BENCH_VID);
+			ether->ether_type = rte_cpu_to_be_16(ETHER_TYPE_VLAN);
+		}
+		if (bcase->ope == SPP_PORT_ABILITY_OPE_DEL_VLANTAG &&
+				bcase->offload) {
+			pkts[cnt]->ol_flags |= PKT_RX_VLAN |
+					PKT_RX_VLAN_STRIPPED;
+			pkts[cnt]->vlan_tci = BENCH_VID;
+		}
+	}
+}
+
+/* Run the case and return cycles per packet. */
+static double
+bench_run_case(struct rte_mbuf **pkts, const struct bench_case *bcase,
+		uint64_t iterations)
+{
+	int cnt;
+	uint64_t iter;
+	uint64_t start, cycles = 0;
+	uint16_t nb_pkts;
+
+	bench_setup_case(bcase);
+	for (iter = 0; iter < iterations; iter++) {
+		bench_reset_packets(pkts, bcase);
+
+		start = rte_rdtsc_precise();
+		nb_pkts = port_ability_each_operation(BENCH_PORT_ID, pkts,
+				BENCH_BURST, bcase->rxtx);
+		if (bcase->fcs) {
+			for (cnt = 0; cnt < nb_pkts; cnt++)
+				g_fcs_sink = rte_net_crc_calc(
+						rte_pktmbuf_mtod(pkts[cnt],
+						void *), pkts[cnt]->data_len,
+						RTE_NET_CRC32_ETH);
+		}
+		cycles += rte_rdtsc_precise() - start;
+
+		if (unlikely(nb_pkts != BENCH_BURST))
+			rte_exit(EXIT_FAILURE, "Packets are dropped in %s.\n",
+					bcase->name);
+	}
+
+	return (double)cycles / (iterations * BENCH_BURST);
+}
+
+/* Parse options of the application. */
+static int
+bench_parse_args(int argc, char *argv[], uint64_t *iterations)
+{
+	int opt;
+	char *endptr = NULL;
+
+	while ((opt = getopt(argc, argv, "n:")) != -1) {
+		switch (opt) {
+		case 'n':
+			*iterations = strtoull(optarg, &endptr, 10);
+			if (*endptr != '\0' || *iterations == 0)
+				return SPP_RET_NG;
+			break;
+		default:
+			return SPP_RET_NG;
+		}
+	}
+	return SPP_RET_OK;
+}
+
+int
+main(int argc, char *argv[])
+{
+	int ret;
+	unsigned int cnt;
+	uint64_t iterations = BENCH_ITERATIONS;
+	struct rte_mempool *pool = NULL;
+	struct rte_mbuf *pkts[BENCH_BURST];
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Cannot initialize EAL.\n");
+	argc -= ret;
+	argv += ret;
+
+	if (bench_parse_args(argc, argv, &iterations) != SPP_RET_OK)
+		rte_exit(EXIT_FAILURE, "Usage: %s [EAL options] -- "
+				"[-n ITERATIONS]\n", argv[0]);
+
+	pool = rte_pktmbuf_pool_create("bench_pool", BENCH_NB_MBUF, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (pool == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot create mbuf pool.\n");
+	if (rte_pktmbuf_alloc_bulk(pool, pkts, BENCH_BURST) != 0)
+		rte_exit(EXIT_FAILURE, "Cannot allocate mbufs.\n");
+
+	if (spp_port_ability_init() != SPP_RET_OK)
+		rte_exit(EXIT_FAILURE, "Cannot initialize port ability.\n");
+	g_bench_add_kernel = g_add_vlantag_burst;
+	g_bench_del_kernel = g_del_vlantag_burst;
+
+	printf("%d packets of %d bytes per burst, %"PRIu64" bursts\n",
+			BENCH_BURST, BENCH_PKT_LEN, iterations);
+	for (cnt = 0; cnt < RTE_DIM(g_bench_cases); cnt++) {
+		if (bench_select_kernel(g_bench_cases[cnt].kernel) !=
+				SPP_RET_OK) {
+			printf("%-40s not supported\n",
+					g_bench_cases[cnt].name);
+			continue;
+		}
+		printf("%-40s %8.2f cycles/packet\n", g_bench_cases[cnt].name,
+				bench_run_case(pkts, &g_bench_cases[cnt],
+				iterations));
+	}
+
+	for (cnt = 0; cnt < BENCH_BURST; cnt++)
+		rte_pktmbuf_free(pkts[cnt]);
+	return 0;
+}
@@ -4,10 +4,12 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <arpa/inet.h>
 
 #include <rte_ether.h>
 #include <rte_log.h>
 #include <rte_branch_prediction.h>
+#include <rte_ring.h>
 
 #include "command_dec.h"
 
@@ -21,6 +23,8 @@
 #define SPP_COMMAND_EXIT_STR            "exit"
 #define SPP_COMMAND_COMPONENT_STR       "component"
 #define SPP_COMMAND_PORT_STR            "port"
+#define SPP_COMMAND_FILTER_STR          "filter"
+#define SPP_COMMAND_SNAPLEN_STR         "snaplen"
 
 /* classifiler_type string */
 #define SPP_CLASSIFLER_NONE_STR         "none"
@@ -33,6 +37,7 @@
 #define SPP_ACTION_STOP_STR             "stop"
 #define SPP_ACTION_ADD_STR              "add"
 #define SPP_ACTION_DEL_STR              "del"
+#define SPP_ACTION_MOVE_STR             "move"
 
 /* port rx/tx string */
 #define SPP_PORT_RXTX_NONE_STR          "none"
@@ -43,6 +48,46 @@
 #define SPP_ABILITY_NONE_STR            "none"
 #define SPP_ABILITY_ADD_VLANTAG_STR     "add_vlantag"
 #define SPP_ABILITY_DEL_VLANTAG_STR     "del_vlantag"
+#define SPP_ABILITY_ADD_QINQ_STR        "add_qinq"
+#define SPP_ABILITY_DEL_QINQ_STR        "del_qinq"
+#define SPP_ABILITY_SET_SRC_MAC_STR     "set_src_mac"
+#define SPP_ABILITY_SET_DST_MAC_STR     "set_dst_mac"
+#define SPP_ABILITY_DEC_TTL_STR         "dec_ttl"
+#define SPP_ABILITY_SET_DSCP_STR        "set_dscp"
+#define SPP_ABILITY_POLICE_SRTCM_STR    "police_srtcm"
+#define SPP_ABILITY_POLICE_TRTCM_STR    "police_trtcm"
+#define SPP_ABILITY_POLICE_TB_STR       "police_tb"
+#define SPP_ABILITY_SAMPLE_STR          "sample"
+
+/* unit of rate string */
+#define SPP_METER_UNIT_PPS_STR          "pps"
+#define SPP_METER_UNIT_BPS_STR          "bps"
+
+/* mode of sampling string */
+#define SPP_SAMPLE_MODE_EVERY_STR       "every"
+#define SPP_SAMPLE_MODE_RANDOM_STR      "random"
+
+/* mirror copy mode string */
+#define SPP_MIRROR_COPY_SHALLOW_STR     "shallow"
+#define SPP_MIRROR_COPY_DEEP_STR        "deep"
+
+/* mirror filter type string */
+#define SPP_FILTER_NONE_STR             "none"
+#define SPP_FILTER_MAC_STR              "mac"
+#define SPP_FILTER_VLAN_STR             "vlan"
+#define SPP_FILTER_ETHER_TYPE_STR       "ether_type"
+#define SPP_FILTER_IP_STR               "ip"
+#define SPP_FILTER_L4_PORT_STR          "l4_port"
+#define SPP_FILTER_BPF_STR              "bpf"
+
+/* Maximum length of copy of sampled packet */
+#define SPP_SAMPLE_SNAPLEN_MAX 65535
+
+/* Maximum DSCP value */
+#define SPP_DSCP_MAX 63
+
+/* Number of arguments of port command without port ability parameters */
+#define SPP_PORT_ARGC_ABILITY 6
 
 /*
  * classifier type string list
@@ -66,6 +111,7 @@ const char *COMMAND_ACTION_STRINGS[] = {
 	SPP_ACTION_STOP_STR,
 	SPP_ACTION_ADD_STR,
 	SPP_ACTION_DEL_STR,
+	SPP_ACTION_MOVE_STR,
 
 	/* termination */ "",
 };
@@ -84,16 +130,95 @@ const char *PORT_RXTX_STRINGS[] = {
 
 /*
  * port ability string list
- * do it same as the order of enum spp_port_ability_type (spp_vf.h)
+ * do it same as the order of enum spp_port_ability_ope (spp_proc.h)
  */
 const char *PORT_ABILITY_STRINGS[] = {
 	SPP_ABILITY_NONE_STR,
 	SPP_ABILITY_ADD_VLANTAG_STR,
 	SPP_ABILITY_DEL_VLANTAG_STR,
+	SPP_ABILITY_ADD_QINQ_STR,
+	SPP_ABILITY_DEL_QINQ_STR,
+	SPP_ABILITY_SET_SRC_MAC_STR,
+	SPP_ABILITY_SET_DST_MAC_STR,
+	SPP_ABILITY_DEC_TTL_STR,
+	SPP_ABILITY_SET_DSCP_STR,
+	SPP_ABILITY_POLICE_SRTCM_STR,
+	SPP_ABILITY_POLICE_TRTCM_STR,
+	SPP_ABILITY_POLICE_TB_STR,
+	SPP_ABILITY_SAMPLE_STR,
 
 	/* termination */ "",
 };
 
+/*
+ * unit of rate string list
+ * do it same as the order of enum spp_meter_unit (spp_proc.h)
+ */
+const char *METER_UNIT_STRINGS[] = {
+	SPP_METER_UNIT_PPS_STR,
+	SPP_METER_UNIT_BPS_STR,
+
+	/* termination */ "",
+};
+
+/*
+ * mode of sampling string list
+ * do it same as the order of enum spp_sample_mode (spp_proc.h)
+ */
+const char *SAMPLE_MODE_STRINGS[] = {
+	SPP_SAMPLE_MODE_EVERY_STR,
+	SPP_SAMPLE_MODE_RANDOM_STR,
+
+	/* termination */ "",
+};
+
+/*
+ * mirror copy mode string list
+ * do it same as the order of enum spp_mirror_copy_mode (spp_proc.h)
+ */
+const char *MIRROR_COPY_MODE_STRINGS[] = {
+	SPP_MIRROR_COPY_SHALLOW_STR,
+	SPP_MIRROR_COPY_DEEP_STR,
+
+	/* termination */ "",
+};
+
+/*
+ * mirror filter type string list
+ * do it same as the order of enum spp_mirror_filter_type (spp_proc.h)
+ */
+const char *MIRROR_FILTER_TYPE_STRINGS[] = {
+	SPP_FILTER_NONE_STR,
+	SPP_FILTER_MAC_STR,
+	SPP_FILTER_VLAN_STR,
+	SPP_FILTER_ETHER_TYPE_STR,
+	SPP_FILTER_IP_STR,
+	SPP_FILTER_L4_PORT_STR,
+	SPP_FILTER_BPF_STR,
+
+	/* termination */ "",
+};
+
+/*
+ * number of parameters of each port ability
+ * do it same as the order of enum spp_port_ability_ope (spp_proc.h)
+ */
+const int PORT_ABILITY_NUM_PARAMS[] = {
+	0, /* none */
+	2, /* add_vlantag VID PCP */
+	0, /* del_vlantag */
+	2, /* add_qinq VID PCP */
+	0, /* del_qinq */
+	1, /* set_src_mac MAC_ADDR */
+	1, /* set_dst_mac MAC_ADDR */
+	0, /* dec_ttl */
+	1, /* set_dscp DSCP */
+	3, /* police_srtcm CIR CBS EBS */
+	4, /* police_trtcm CIR PIR CBS PBS */
+	3, /* police_tb UNIT RATE BURST */
+	4, /* sample RING MODE RATE SNAPLEN */
+};
+
 /* Check mac address used on the port for registering or removing */
 static int
 spp_check_classid_used_port(
@@ -299,6 +424,30 @@ get_uint_value(
 	return SPP_RET_OK;
 }
 
+/* Get uint64_t type value */
+static int
+get_uint64_value(
+		uint64_t *output,
+		const char *arg_val,
+		uint64_t min,
+		uint64_t max)
+{
+	uint64_t ret = 0;
+	char *endptr = NULL;
+	if (unlikely(*arg_val == '-'))
+		return SPP_RET_NG;
+
+	ret = strtoull(arg_val, &endptr, 0);
+	if (unlikely(endptr == arg_val) || unlikely(*endptr != '\0'))
+		return SPP_RET_NG;
+
+	if (unlikely(ret < min) || unlikely(ret > max))
+		return SPP_RET_NG;
+
+	*output = ret;
+	return SPP_RET_OK;
+}
+
 /* decoding procedure of string */
 static int
 decode_str_value(char *output, const char *arg_val)
@@ -356,7 +505,8 @@ decode_component_action_value(void *output, const char *arg_val,
 	}
 
 	if (unlikely(ret != SPP_CMD_ACTION_START) &&
-			unlikely(ret != SPP_CMD_ACTION_STOP)) {
+			unlikely(ret != SPP_CMD_ACTION_STOP) &&
+			unlikely(ret != SPP_CMD_ACTION_MOVE)) {
 		RTE_LOG(ERR, SPP_COMMAND_PROC,
 				"Unknown component action. val=%s\n",
 				arg_val);
@@ -386,6 +536,17 @@ decode_component_name_value(void *output, const char *arg_val,
 		}
 	}
 
+	/* "move" requires existing component. */
+	if (component->action == SPP_CMD_ACTION_MOVE) {
+		ret = spp_get_component_id(arg_val);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Unknown component name. val=%s\n",
+					arg_val);
+			return SPP_RET_NG;
+		}
+	}
+
 	return decode_str_value(component->name, arg_val);
 }
 
@@ -397,7 +558,8 @@ decode_component_core_value(void *output, const char *arg_val,
 	struct spp_command_component *component = output;
 
 	/* "stop" has no core ID parameter. */
-	if (component->action != SPP_CMD_ACTION_START)
+	if (component->action != SPP_CMD_ACTION_START &&
+			component->action != SPP_CMD_ACTION_MOVE)
 		return SPP_RET_OK;
 
 	return decode_core_value(&component->core, arg_val);
@@ -427,6 +589,34 @@ decode_component_type_value(void *output, const char *arg_val,
 	return SPP_RET_OK;
 }
 
+/* decoding procedure of copy mode for component command */
+static int
+decode_component_copy_mode_value(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	int ret = SPP_RET_OK;
+	struct spp_command_component *component = output;
+
+	/* Only "start" of mirror has copy mode parameter. */
+	if (component->action != SPP_CMD_ACTION_START ||
+			component->type != SPP_COMPONENT_MIRROR) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Copy mode is only for mirror. val=%s\n",
+				arg_val);
+		return SPP_RET_NG;
+	}
+
+	ret = get_arrary_index(arg_val, MIRROR_COPY_MODE_STRINGS);
+	if (unlikely(ret < 0)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Unknown copy mode. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
+	component->copy_mode = ret;
+	return SPP_RET_OK;
+}
+
 /* decoding procedure of action for port command */
 static int
 decode_port_action_value(void *output, const char *arg_val,
@@ -533,9 +723,9 @@ decode_port_name_value(void *output, const char *arg_val,
 	return decode_str_value(output, arg_val);
 }
 
-/* decoding procedure of vlan operation for port command */
+/* decoding procedure of ability operation for port command */
 static int
-decode_port_vlan_operation(void *output, const char *arg_val,
+decode_port_ability_operation(void *output, const char *arg_val,
 				int allow_override __attribute__ ((unused)))
 {
 	int ret = SPP_RET_OK;
@@ -567,51 +757,241 @@ decode_port_vlan_operation(void *output, const char *arg_val,
 
 /* decoding procedure of vid  for port command */
 static int
-decode_port_vid(void *output, const char *arg_val,
-				int allow_override __attribute__ ((unused)))
+decode_port_vid(struct spp_port_ability *ability, const char *arg_val)
 {
 	int ret = SPP_RET_OK;
-	struct spp_command_port *port = output;
-	struct spp_port_ability *ability = &port->ability;
+
+	ret = get_int_value(&ability->data.vlantag.vid,
+		arg_val, 0, ETH_VLAN_ID_MAX);
+	if (unlikely(ret < SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Bad VLAN ID. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+	ability->data.vlantag.pcp = -1;
+
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of mac address for port command */
+static int
+decode_port_mac(struct spp_port_ability *ability, const char *arg_val)
+{
+	int64_t ret = SPP_RET_OK;
+
+	if (strlen(arg_val) >= SPP_MIN_STR_LEN)
+		ret = SPP_RET_NG;
+	else
+		ret = spp_change_mac_str_to_int64(arg_val);
+	if (unlikely(ret < SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Bad mac address string. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
+	ability->data.mac.addr = (uint64_t)ret;
+	strcpy(ability->data.mac.addr_str, arg_val);
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of dscp for port command */
+static int
+decode_port_dscp(struct spp_port_ability *ability, const char *arg_val)
+{
+	int ret = SPP_RET_OK;
+
+	ret = get_int_value(&ability->data.dscp.dscp,
+			arg_val, 0, SPP_DSCP_MAX);
+	if (unlikely(ret < SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Bad DSCP. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of pcp for port command */
+static int
+decode_port_pcp(struct spp_port_ability *ability, const char *arg_val)
+{
+	int ret = SPP_RET_OK;
+
+	ret = get_int_value(&ability->data.vlantag.pcp,
+			arg_val, 0, SPP_VLAN_PCP_MAX);
+	if (unlikely(ret < SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Bad VLAN PCP. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
+	return SPP_RET_OK;
+}
+
+/*
+ * decoding procedure of rate limit parameter for port command
+ *
+ * Parameters are given in the order of
+ *   police_srtcm : CIR CBS EBS
+ *   police_trtcm : CIR PIR CBS PBS
+ *   police_tb    : UNIT RATE BURST
+ */
+static int
+decode_port_meter(struct spp_port_ability *ability, int pos,
+		const char *arg_val)
+{
+	int ret = SPP_RET_OK;
+	struct spp_meter_info *meter = &ability->data.meter;
+	uint64_t *srtcm[] = { &meter->cir, &meter->cbs, &meter->ebs };
+	uint64_t *trtcm[] = {
+		&meter->cir, &meter->pir, &meter->cbs, &meter->pbs };
+	uint64_t *tb[] = { NULL, &meter->cir, &meter->cbs };
+	uint64_t **params = NULL;
+	int num_params = 0;
+	uint64_t *value = NULL;
 
 	switch (ability->ope) {
-	case SPP_PORT_ABILITY_OPE_ADD_VLANTAG:
-		ret = get_int_value(&ability->data.vlantag.vid,
-			arg_val, 0, ETH_VLAN_ID_MAX);
+	case SPP_PORT_ABILITY_OPE_POLICE_SRTCM:
+		params = srtcm;
+		num_params = RTE_DIM(srtcm);
+		break;
+	case SPP_PORT_ABILITY_OPE_POLICE_TRTCM:
+		params = trtcm;
+		num_params = RTE_DIM(trtcm);
+		break;
+	case SPP_PORT_ABILITY_OPE_POLICE_TB:
+		params = tb;
+		num_params = RTE_DIM(tb);
+		break;
+	default:
+		/* Not used. */
+		break;
+	}
+
+	if (unlikely(params == NULL) || unlikely(pos >= num_params)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Too many rate limit parameters. val=%s\n",
+				arg_val);
+		return SPP_RET_NG;
+	}
+
+	value = params[pos];
+	if (value == NULL) {
+		/* Unit of token bucket policer. */
+		ret = get_arrary_index(arg_val, METER_UNIT_STRINGS);
 		if (unlikely(ret < SPP_RET_OK)) {
 			RTE_LOG(ERR, SPP_COMMAND_PROC,
-					"Bad VLAN ID. val=%s\n", arg_val);
+					"Unknown unit of rate. val=%s\n",
+					arg_val);
+			return SPP_RET_NG;
+		}
+		meter->unit = ret;
+		return SPP_RET_OK;
+	}
+
+	/* Only excess burst size of srTCM can be zero. */
+	ret = get_uint64_value(value, arg_val,
+			(value == &meter->ebs) ? 0 : 1, UINT64_MAX);
+	if (unlikely(ret < SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Bad rate limit parameter. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
+	return SPP_RET_OK;
+}
+
+/*
+ * decoding procedure of sampling parameter for port command
+ *
+ * Parameters are given in the order of RING MODE RATE SNAPLEN.
+ */
+static int
+decode_port_sample(struct spp_port_ability *ability, int pos,
+		const char *arg_val)
+{
+	int ret = SPP_RET_OK;
+	struct spp_sample_info *sample = &ability->data.sample;
+
+	switch (pos) {
+	case 0:
+		ret = decode_port_value(&sample->ring, arg_val);
+		if (unlikely(ret < SPP_RET_OK) ||
+				unlikely(sample->ring.iface_type != RING) ||
+				unlikely(rte_ring_lookup(get_rx_queue_name(
+				sample->ring.iface_no)) == NULL)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad ring for sampling. val=%s\n",
+					arg_val);
+			return SPP_RET_NG;
+		}
+		break;
+	case 1:
+		ret = get_arrary_index(arg_val, SAMPLE_MODE_STRINGS);
+		if (unlikely(ret < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Unknown mode of sampling. val=%s\n",
+					arg_val);
+			return SPP_RET_NG;
+		}
+		sample->mode = ret;
+		break;
+	case 2:
+		ret = get_uint_value(&sample->rate, arg_val, 1, UINT32_MAX);
+		if (unlikely(ret < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad rate of sampling. val=%s\n",
+					arg_val);
 			return SPP_RET_NG;
 		}
-		ability->data.vlantag.pcp = -1;
 		break;
 	default:
-		/* Not used. */
+		ret = get_uint_value(&sample->snaplen, arg_val, 0,
+				SPP_SAMPLE_SNAPLEN_MAX);
+		if (unlikely(ret < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad snaplen of sampling. val=%s\n",
+					arg_val);
+			return SPP_RET_NG;
+		}
 		break;
 	}
 
 	return SPP_RET_OK;
 }
 
-/* decoding procedure of pcp for port command */
+/* decoding procedure of n-th ability parameter for port command */
 static int
-decode_port_pcp(void *output, const char *arg_val,
-				int allow_override __attribute__ ((unused)))
+decode_port_ability_param(struct spp_command_port *port, int pos,
+		const char *arg_val)
 {
-	int ret = SPP_RET_OK;
-	struct spp_command_port *port = output;
 	struct spp_port_ability *ability = &port->ability;
 
+	/* parameters over the number of the ability are not acceptable */
+	if (unlikely(pos >= PORT_ABILITY_NUM_PARAMS[ability->ope])) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Too many parameters for port ability. "
+				"val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
 	switch (ability->ope) {
 	case SPP_PORT_ABILITY_OPE_ADD_VLANTAG:
-		ret = get_int_value(&ability->data.vlantag.pcp,
-				arg_val, 0, SPP_VLAN_PCP_MAX);
-		if (unlikely(ret < SPP_RET_OK)) {
-			RTE_LOG(ERR, SPP_COMMAND_PROC,
-					"Bad VLAN PCP. val=%s\n", arg_val);
-			return SPP_RET_NG;
-		}
-		break;
+	case SPP_PORT_ABILITY_OPE_ADD_QINQ:
+		if (pos == 0)
+			return decode_port_vid(ability, arg_val);
+		return decode_port_pcp(ability, arg_val);
+	case SPP_PORT_ABILITY_OPE_SET_SRC_MAC:
+	case SPP_PORT_ABILITY_OPE_SET_DST_MAC:
+		return decode_port_mac(ability, arg_val);
+	case SPP_PORT_ABILITY_OPE_SET_DSCP:
+		return decode_port_dscp(ability, arg_val);
+	case SPP_PORT_ABILITY_OPE_POLICE_SRTCM:
+	case SPP_PORT_ABILITY_OPE_POLICE_TRTCM:
+	case SPP_PORT_ABILITY_OPE_POLICE_TB:
+		return decode_port_meter(ability, pos, arg_val);
+	case SPP_PORT_ABILITY_OPE_SAMPLE:
+		return decode_port_sample(ability, pos, arg_val);
 	default:
 		/* Not used. */
 		break;
@@ -620,6 +1000,38 @@ decode_port_pcp(void *output, const char *arg_val,
 	return SPP_RET_OK;
 }
 
+/* decoding procedure of first ability parameter for port command */
+static int
+decode_port_ability_value1(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	return decode_port_ability_param(output, 0, arg_val);
+}
+
+/* decoding procedure of second ability parameter for port command */
+static int
+decode_port_ability_value2(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	return decode_port_ability_param(output, 1, arg_val);
+}
+
+/* decoding procedure of third ability parameter for port command */
+static int
+decode_port_ability_value3(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	return decode_port_ability_param(output, 2, arg_val);
+}
+
+/* decoding procedure of fourth ability parameter for port command */
+static int
+decode_port_ability_value4(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	return decode_port_ability_param(output, 3, arg_val);
+}
+
 /* decoding procedure of mac address string */
 static int
 decode_mac_addr_str_value(void *output, const char *arg_val,
@@ -752,6 +1164,177 @@ decode_classifier_port_value(void *output, const char *arg_val,
 	return SPP_RET_OK;
 }
 
+/* decoding procedure of action for filter command */
+static int
+decode_filter_action_value(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	int ret = SPP_RET_OK;
+	ret = get_arrary_index(arg_val, COMMAND_ACTION_STRINGS);
+	if (unlikely(ret != SPP_CMD_ACTION_ADD) &&
+			unlikely(ret != SPP_CMD_ACTION_DEL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Unknown filter action. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
+	*(int *)output = ret;
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of type for filter command */
+static int
+decode_filter_type_value(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	int ret = SPP_RET_OK;
+	struct spp_mirror_filter *filter = output;
+
+	ret = get_arrary_index(arg_val, MIRROR_FILTER_TYPE_STRINGS);
+	if (unlikely(ret <= 0)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"Unknown filter type. val=%s\n", arg_val);
+		return SPP_RET_NG;
+	}
+
+	filter->type = ret;
+	return SPP_RET_OK;
+}
+
+/**
+ * Decode IP prefix such as `10.0.0.0/8` or `2001:db8::/32`. Prefix
+ * length can be omitted for host address, and host part of the address
+ * is cleared for comparing it with masked address of packet.
+ */
+static int
+decode_filter_ip_prefix(struct spp_ip_prefix_info *ip, const char *arg_val)
+{
+	int cnt;
+	int max_len;
+	int pos = strcspn(arg_val, "/");
+	char addr_str[INET6_ADDRSTRLEN];
+
+	if (unlikely(pos >= INET6_ADDRSTRLEN))
+		return SPP_RET_NG;
+
+	memcpy(addr_str, arg_val, pos);
+	addr_str[pos] = '\0';
+	if (strchr(addr_str, ':') != NULL) {
+		ip->family = AF_INET6;
+		max_len = 128;
+	} else {
+		ip->family = AF_INET;
+		max_len = 32;
+	}
+
+	if (unlikely(inet_pton(ip->family, addr_str, ip->addr) != 1))
+		return SPP_RET_NG;
+
+	ip->prefix_len = max_len;
+	if (arg_val[pos] == '/' &&
+			unlikely(get_int_value(&ip->prefix_len,
+			&arg_val[pos + 1], 0, max_len) < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	for (cnt = 0; cnt < max_len / 8; cnt++) {
+		if (cnt * 8 >= ip->prefix_len)
+			ip->addr[cnt] = 0;
+		else if (cnt * 8 + 8 > ip->prefix_len)
+			ip->addr[cnt] &= 0xff << (8 - ip->prefix_len % 8);
+	}
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of value for filter command */
+static int
+decode_filter_value(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	int ret = SPP_RET_OK;
+	int value = 0;
+	int64_t mac = 0;
+	struct spp_mirror_filter *filter = output;
+
+	switch (filter->type) {
+	case SPP_MIRROR_FILTER_MAC:
+		mac = SPP_RET_NG;
+		if (strlen(arg_val) < SPP_MIN_STR_LEN)
+			mac = spp_change_mac_str_to_int64(arg_val);
+		if (unlikely(mac < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad mac address string. val=%s\n",
+					arg_val);
+			return SPP_RET_NG;
+		}
+		filter->data.mac = (uint64_t)mac;
+		break;
+	case SPP_MIRROR_FILTER_VLAN:
+		ret = get_int_value(&filter->data.vid, arg_val,
+				0, ETH_VLAN_ID_MAX);
+		if (unlikely(ret < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad VLAN ID. val=%s\n", arg_val);
+			return SPP_RET_NG;
+		}
+		break;
+	case SPP_MIRROR_FILTER_ETHER_TYPE:
+		ret = get_int_value(&value, arg_val, 0, UINT16_MAX);
+		if (unlikely(ret < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad EtherType. val=%s\n", arg_val);
+			return SPP_RET_NG;
+		}
+		filter->data.ether_type = value;
+		break;
+	case SPP_MIRROR_FILTER_IP:
+		ret = decode_filter_ip_prefix(&filter->data.ip, arg_val);
+		if (unlikely(ret < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad IP prefix. val=%s\n", arg_val);
+			return SPP_RET_NG;
+		}
+		break;
+	case SPP_MIRROR_FILTER_L4_PORT:
+		ret = get_int_value(&value, arg_val, 0, UINT16_MAX);
+		if (unlikely(ret < SPP_RET_OK)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Bad L4 port. val=%s\n", arg_val);
+			return SPP_RET_NG;
+		}
+		filter->data.l4_port = value;
+		break;
+	case SPP_MIRROR_FILTER_BPF:
+		if (unlikely(strlen(arg_val) >= SPP_NAME_STR_LEN) ||
+				unlikely(access(arg_val, R_OK) != 0)) {
+			RTE_LOG(ERR, SPP_COMMAND_PROC,
+					"Cannot read BPF file. val=%s\n",
+					arg_val);
+			return SPP_RET_NG;
+		}
+		strcpy(filter->data.bpf_file, arg_val);
+		break;
+	default:
+		return SPP_RET_NG;
+	}
+
+	return SPP_RET_OK;
+}
+
+/* decoding procedure of length for snaplen command */
+static int
+decode_snaplen_value(void *output, const char *arg_val,
+				int allow_override __attribute__ ((unused)))
+{
+	int ret = SPP_RET_OK;
+	ret = get_uint_value(output, arg_val, 0, SPP_MIRROR_SNAPLEN_MAX);
+	if (unlikely(ret < SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC, "Bad snaplen. val=%s\n",
+				arg_val);
+		return SPP_RET_NG;
+	}
+	return SPP_RET_OK;
+}
+
 #define DECODE_PARAMETER_LIST_EMPTY { NULL, 0, NULL }
 
 /* parameter list for decoding */
@@ -850,6 +1433,11 @@ parameter_list[][SPP_CMD_MAX_PARAMETERS] = {
 			.offset = offsetof(struct spp_command, spec.component),
 			.func = decode_component_type_value
 		},
+		{
+			.name = "copy mode",
+			.offset = offsetof(struct spp_command, spec.component),
+			.func = decode_component_copy_mode_value
+		},
 		DECODE_PARAMETER_LIST_EMPTY,
 	},
 	{                                /* port             */
@@ -875,19 +1463,71 @@ parameter_list[][SPP_CMD_MAX_PARAMETERS] = {
 			.func = decode_port_name_value
 		},
 		{
-			.name = "port vlan operation",
+			.name = "port ability",
 			.offset = offsetof(struct spp_command, spec.port),
-			.func = decode_port_vlan_operation
+			.func = decode_port_ability_operation
 		},
 		{
-			.name = "port vid",
+			.name = "port ability value",
 			.offset = offsetof(struct spp_command, spec.port),
-			.func = decode_port_vid
+			.func = decode_port_ability_value1
 		},
 		{
-			.name = "port pcp",
+			.name = "port ability value",
 			.offset = offsetof(struct spp_command, spec.port),
-			.func = decode_port_pcp
+			.func = decode_port_ability_value2
+		},
+		{
+			.name = "port ability value",
+			.offset = offsetof(struct spp_command, spec.port),
+			.func = decode_port_ability_value3
+		},
+		{
+			.name = "port ability value",
+			.offset = offsetof(struct spp_command, spec.port),
+			.func = decode_port_ability_value4
+		},
+		DECODE_PARAMETER_LIST_EMPTY,
+	},
+	{                                /* filter           */
+		{
+			.name = "action",
+			.offset = offsetof(struct spp_command,
+					spec.filter.action),
+			.func = decode_filter_action_value
+		},
+		{
+			.name = "component name",
+			.offset = offsetof(struct spp_command,
+					spec.filter.name),
+			.func = decode_port_name_value
+		},
+		{
+			.name = "filter type",
+			.offset = offsetof(struct spp_command,
+					spec.filter.filter),
+			.func = decode_filter_type_value
+		},
+		{
+			.name = "filter value",
+			.offset = offsetof(struct spp_command,
+					spec.filter.filter),
+			.func = decode_filter_value
+		},
+		DECODE_PARAMETER_LIST_EMPTY,
+	},
+	{                                /* snaplen          */
+		{
+			.name = "component name",
+			.offset = offsetof(struct spp_command,
+					spec.snaplen.name),
+			.func = decode_port_name_value
+		},
+		{
+			.name = "snaplen",
+			.offset = offsetof(struct spp_command,
+					spec.snaplen.snaplen),
+			.func = decode_snaplen_value
 		},
 		DECODE_PARAMETER_LIST_EMPTY,
 	},
@@ -967,16 +1607,19 @@ static int
 decode_command_parameter_port(struct spp_command_request *request,
 				int argc, char *argv[],
 				struct spp_command_decode_error *error,
-				int maxargc)
+				int maxargc __attribute__ ((unused)))
 {
 	int ret = SPP_RET_OK;
 	int ci = request->commands[0].type;
 	int pi = 0;
 	struct decode_parameter_list *list = NULL;
+	struct spp_port_ability *ability = NULL;
+	struct spp_meter_info *meter = NULL;
+	struct spp_command_port *port = NULL;
 	int flag = 0;
 
-	/* check add vlatag */
-	if (argc == maxargc)
+	/* port ability can be added to the port already used */
+	if (argc >= SPP_PORT_ARGC_ABILITY)
 		flag = 1;
 
 	for (pi = 1; pi < argc; pi++) {
@@ -992,6 +1635,67 @@ decode_command_parameter_port(struct spp_command_request *request,
 				list->name);
 		}
 	}
+
+	/* check number of parameters of port ability */
+	ability = &request->commands[0].spec.port.ability;
+	if (unlikely(ability->ope != SPP_PORT_ABILITY_OPE_NONE) &&
+			unlikely(argc != SPP_PORT_ARGC_ABILITY +
+			PORT_ABILITY_NUM_PARAMS[ability->ope])) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC, "Bad number of parameters "
+				"for port ability. command=%s, ability=%s\n",
+				argv[0], argv[5]);
+		return set_string_value_decode_error(error, argv[5],
+				"port ability");
+	}
+
+	/* peak rate of trTCM must not be less than committed rate */
+	meter = &ability->data.meter;
+	if (unlikely(ability->ope == SPP_PORT_ABILITY_OPE_POLICE_TRTCM) &&
+			unlikely(meter->pir < meter->cir)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC, "Peak rate is less than "
+				"committed rate. command=%s\n", argv[0]);
+		return set_string_value_decode_error(error, argv[7],
+				"port ability value");
+	}
+
+	/*
+	 * Rings are single producer, so a sampling ring must not be sent
+	 * by a component or another sampling ability.
+	 */
+	port = &request->commands[0].spec.port;
+	if (unlikely(ability->ope == SPP_PORT_ABILITY_OPE_SAMPLE) &&
+			(spp_check_used_port(RING,
+				ability->data.sample.ring.iface_no,
+				SPP_PORT_RXTX_TX) >= 0 ||
+			spp_check_sample_ring(
+				ability->data.sample.ring.iface_no,
+				&port->port, port->rxtx) == SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC, "Ring for sampling is "
+				"already sent by others. command=%s\n",
+				argv[0]);
+		return set_string_value_decode_error(error, argv[6],
+				"port ability value");
+	}
+	if (unlikely(port->action == SPP_CMD_ACTION_ADD) &&
+			unlikely(port->rxtx == SPP_PORT_RXTX_TX) &&
+			unlikely(port->port.iface_type == RING) &&
+			unlikely(spp_check_sample_ring(port->port.iface_no,
+				NULL, port->rxtx) == SPP_RET_OK)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC, "Ring is used for sampling. "
+				"command=%s\n", argv[0]);
+		return set_string_value_decode_error(error, argv[2],
+				"port");
+	}
+
+	/* token bucket in bps must be filled one byte per second at least */
+	if (unlikely(ability->ope == SPP_PORT_ABILITY_OPE_POLICE_TB) &&
+			unlikely(meter->unit == SPP_METER_UNIT_BPS) &&
+			unlikely(meter->cir < 8)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC, "Rate of token bucket is "
+				"less than 8 bps. command=%s\n", argv[0]);
+		return set_string_value_decode_error(error, argv[7],
+				"port ability value");
+	}
 	return SPP_RET_OK;
 }
 
@@ -1017,10 +1721,14 @@ static struct decode_command_list command_list[] = {
 	{ SPP_COMMAND_GET_CLIENT_ID_STR, 1, 1, NULL }, /* _get_client_id  */
 	{ SPP_COMMAND_STATUS_STR,	 1, 1, NULL }, /* status          */
 	{ SPP_COMMAND_EXIT_STR,		 1, 1, NULL }, /* exit            */
-	{ SPP_COMMAND_COMPONENT_STR,	 3, 5,
+	{ SPP_COMMAND_COMPONENT_STR,	 3, 6,
 		decode_command_parameter_component  }, /* component       */
-	{ SPP_COMMAND_PORT_STR,		 5, 8,
+	{ SPP_COMMAND_PORT_STR,		 5, 10,
 		decode_command_parameter_port       }, /* port            */
+	{ SPP_COMMAND_FILTER_STR,	 5, 5,
+		decode_command_parameter_component  }, /* filter          */
+	{ SPP_COMMAND_SNAPLEN_STR,	 3, 3,
+		decode_command_parameter_component  }, /* snaplen         */
 	{ "",				 0, 0, NULL }  /* termination     */
 };
 
@@ -18,7 +18,7 @@
 #define SPP_CMD_MAX_COMMANDS 32
 
 /** maximum number of parameters per command */
-#define SPP_CMD_MAX_PARAMETERS 8
+#define SPP_CMD_MAX_PARAMETERS 10
 
 /** command name string buffer size (include null char) */
 #define SPP_CMD_NAME_BUFSZ  32
@@ -42,9 +42,10 @@ enum spp_command_decode_error_code {
 /**
  * Define actions of each of components
  *  The Run option of the folllwing commands.
- *   compomnent       : start,stop
+ *   compomnent       : start,stop,move
  *   port             : add,del
  *   classifier_table : add,del
+ *   filter           : add,del
  */
 enum spp_command_action {
 	SPP_CMD_ACTION_NONE,  /**< none */
@@ -52,6 +53,7 @@ enum spp_command_action {
 	SPP_CMD_ACTION_STOP,  /**< stop */
 	SPP_CMD_ACTION_ADD,   /**< add */
 	SPP_CMD_ACTION_DEL,   /**< delete */
+	SPP_CMD_ACTION_MOVE,  /**< move */
 };
 
 /**
@@ -81,6 +83,12 @@ enum spp_command_type {
 
 	/** port command */
 	SPP_CMDTYPE_PORT,
+
+	/** filter command */
+	SPP_CMDTYPE_FILTER,
+
+	/** snaplen command */
+	SPP_CMDTYPE_SNAPLEN,
 };
 
 /** "classifier_table" command specific parameters */
@@ -108,7 +116,7 @@ struct spp_command_flush {
 
 /** "component" command parameters */
 struct spp_command_component {
-	/** Action identifier (start or stop) */
+	/** Action identifier (start, stop or move) */
 	enum spp_command_action action;
 
 	/** Component name */
@@ -119,6 +127,9 @@ struct spp_command_component {
 
 	/** Component type */
 	enum spp_component_type type;
+
+	/** Copy mode of mirror component */
+	enum spp_mirror_copy_mode copy_mode;
 };
 
 /** "port" command parameters */
@@ -139,6 +150,27 @@ struct spp_command_port {
 	struct spp_port_ability ability;
 };
 
+/** "filter" command parameters */
+struct spp_command_filter {
+	/** Action identifier (add or del) */
+	enum spp_command_action action;
+
+	/** Component name */
+	char name[SPP_CMD_NAME_BUFSZ];
+
+	/** Mirror filter */
+	struct spp_mirror_filter filter;
+};
+
+/** "snaplen" command parameters */
+struct spp_command_snaplen {
+	/** Component name */
+	char name[SPP_CMD_NAME_BUFSZ];
+
+	/** Length of mirrored packets, or 0 for whole of packets */
+	unsigned int snaplen;
+};
+
 /** command parameters */
 struct spp_command {
 	enum spp_command_type type; /**< Command type */
@@ -155,6 +187,12 @@ struct spp_command {
 
 		/** Structured data for port command  */
 		struct spp_command_port port;
+
+		/** Structured data for filter command  */
+		struct spp_command_filter filter;
+
+		/** Structured data for snaplen command  */
+		struct spp_command_snaplen snaplen;
 	} spec;
 };
 
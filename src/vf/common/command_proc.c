@@ -4,6 +4,8 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <inttypes.h>
+#include <arpa/inet.h>
 
 #include <rte_log.h>
 #include <rte_branch_prediction.h>
@@ -91,6 +93,55 @@ const char *PORT_ABILITY_STATUS_STRINGS[] = {
 	/* termination */ "",
 };
 
+/*
+ * port ability operation string list
+ * do it same as the order of enum spp_port_ability_ope (spp_proc.h)
+ */
+const char *PORT_ABILITY_OPE_STATUS_STRINGS[] = {
+	"none",
+	"add_vlantag",
+	"del_vlantag",
+	"add_qinq",
+	"del_qinq",
+	"set_src_mac",
+	"set_dst_mac",
+	"dec_ttl",
+	"set_dscp",
+	"police_srtcm",
+	"police_trtcm",
+	"police_tb",
+	"sample",
+
+	/* termination */ "",
+};
+
+/*
+ * mirror copy mode string list
+ * do it same as the order of enum spp_mirror_copy_mode (spp_proc.h)
+ */
+const char *MIRROR_COPY_MODE_STATUS_STRINGS[] = {
+	"shallow",
+	"deep",
+
+	/* termination */ "",
+};
+
+/*
+ * mirror filter type string list
+ * do it same as the order of enum spp_mirror_filter_type (spp_proc.h)
+ */
+const char *MIRROR_FILTER_TYPE_STATUS_STRINGS[] = {
+	"none",
+	"mac",
+	"vlan",
+	"ether_type",
+	"ip",
+	"l4_port",
+	"bpf",
+
+	/* termination */ "",
+};
+
 /*
  * classifier type string list
  * do it same as the order of enum spp_classifier_type (spp_vf.h)
@@ -221,7 +272,7 @@ spp_update_classifier_table(
 }
 
 /**
- * Assign or remove component to/from specified lcore depending
+ * Assign, remove or move component to/from specified lcore depending
  * on component action
  */
 static int
@@ -229,7 +280,8 @@ spp_update_component(
 		enum spp_command_action action,
 		const char *name,
 		unsigned int lcore_id,
-		enum spp_component_type type)
+		enum spp_component_type type,
+		enum spp_mirror_copy_mode copy_mode)
 {
 	int ret = SPP_RET_NG;
 	int ret_del = -1;
@@ -277,6 +329,7 @@ spp_update_component(
 		comp_info->type		= type;
 		comp_info->lcore_id	= lcore_id;
 		comp_info->component_id	= component_id;
+		comp_info->copy_mode	= copy_mode;
 
 		core->id[core->num] = component_id;
 		core->num++;
@@ -313,6 +366,57 @@ spp_update_component(
 		*(change_component + component_id) = 0;
 		break;
 
+	case SPP_CMD_ACTION_MOVE:
+		component_id = spp_get_component_id(name);
+		if (component_id < 0) {
+			RTE_LOG(ERR, APP, "Unknown component '%s'.\n", name);
+			return SPP_RET_NG;
+		}
+
+		comp_info = (comp_info_base + component_id);
+		if (comp_info->lcore_id == lcore_id)
+			return SPP_RET_OK;
+
+		info = (core_info + lcore_id);
+		if (info->status == SPP_CORE_UNUSE) {
+			RTE_LOG(ERR, APP, "Core %d is not available because "
+				"it is in SPP_CORE_UNUSE state.\n", lcore_id);
+			return SPP_RET_NG;
+		}
+
+		core = &info->core[info->upd_index];
+		if (core->num >= RTE_MAX_LCORE) {
+			RTE_LOG(ERR, APP, "Core %d has no room for "
+				"component '%s'.\n", lcore_id, name);
+			return SPP_RET_NG;
+		}
+
+		/**
+		 * Only stage the move in the lists for update of both
+		 * cores. The component is released from the source core
+		 * in spp_flush() before the destination core runs it.
+		 * Component state such as staging buffers of classifier
+		 * is kept per component, so it is handed over as it is.
+		 */
+		core->id[core->num] = component_id;
+		core->num++;
+
+		tmp_lcore_id = comp_info->lcore_id;
+		info = (core_info + tmp_lcore_id);
+		core = &info->core[info->upd_index];
+		ret_del = del_component_info(component_id,
+				core->num, core->id);
+		if (ret_del >= 0)
+			/* If deleted, decrement number. */
+			core->num--;
+
+		*(change_core + tmp_lcore_id) = 1;
+		comp_info->lcore_id = lcore_id;
+
+		ret = SPP_RET_OK;
+		tmp_lcore_id = lcore_id;
+		break;
+
 	default:
 		break;
 	}
@@ -353,7 +457,7 @@ check_port_count(int component_type, enum spp_port_rxtx rxtx, int num_rx,
 		break;
 
 	case SPP_COMPONENT_MIRROR:
-		if (num_rx > 1 || num_tx > 2)
+		if (num_rx > 1 || num_tx > SPP_MIRROR_DEST_MAX + 1)
 			return SPP_RET_NG;
 		break;
 
@@ -365,6 +469,33 @@ check_port_count(int component_type, enum spp_port_rxtx rxtx, int num_rx,
 	return SPP_RET_OK;
 }
 
+/**
+ * Get index of port ability which has the same operation and direction
+ * as given one, or index of free area if not found.
+ * SPP_PORT_ABILITY_MAX is returned if no space.
+ */
+static int
+get_port_ability_index(const struct spp_port_info *port_info,
+		const struct spp_port_ability *ability)
+{
+	int cnt;
+	int free_cnt = SPP_PORT_ABILITY_MAX;
+
+	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		if (port_info->ability[cnt].ope == SPP_PORT_ABILITY_OPE_NONE) {
+			if (free_cnt == SPP_PORT_ABILITY_MAX)
+				free_cnt = cnt;
+			continue;
+		}
+
+		if (port_info->ability[cnt].ope == ability->ope &&
+				port_info->ability[cnt].rxtx == ability->rxtx)
+			return cnt;
+	}
+
+	return free_cnt;
+}
+
 /* Port add or del to execute it */
 /**
  * TODO(Ogasawara) The name `action` should be revised to be more
@@ -382,6 +513,7 @@ spp_update_port(enum spp_command_action action,
 	int ret_del = -1;
 	int component_id = 0;
 	int cnt = 0;
+	int cnt_upd = 0;
 	struct spp_component_info *comp_info = NULL;
 	struct spp_port_info *port_info = NULL;
 	int *num = NULL;
@@ -419,14 +551,13 @@ spp_update_port(enum spp_command_action action,
 		/* Check whether a port has been already registered. */
 		if (ret_check >= SPP_RET_OK) {
 			/* registered */
-			if (ability->ope == SPP_PORT_ABILITY_OPE_ADD_VLANTAG) {
-				while ((cnt < SPP_PORT_ABILITY_MAX) &&
-					    (port_info->ability[cnt].ope !=
-					    SPP_PORT_ABILITY_OPE_ADD_VLANTAG))
-					cnt++;
+			if (ability->ope != SPP_PORT_ABILITY_OPE_NONE) {
+				/* Update same ability or append new one. */
+				cnt = get_port_ability_index(port_info,
+						ability);
 				if (cnt >= SPP_PORT_ABILITY_MAX) {
-					RTE_LOG(ERR, APP, "update VLAN tag "
-						"Non-registratio\n");
+					RTE_LOG(ERR, APP,
+						"No space of port ability.\n");
 					return SPP_RET_NG;
 				}
 				memcpy(&port_info->ability[cnt], ability,
@@ -467,15 +598,23 @@ spp_update_port(enum spp_command_action action,
 		break;
 
 	case SPP_CMD_ACTION_DEL:
-		for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		/* Keep order of remained abilities for the other direction. */
+		for (cnt = 0, cnt_upd = 0; cnt < SPP_PORT_ABILITY_MAX;
+				cnt++) {
 			if (port_info->ability[cnt].ope ==
-					SPP_PORT_ABILITY_OPE_NONE)
+					SPP_PORT_ABILITY_OPE_NONE ||
+					port_info->ability[cnt].rxtx == rxtx)
 				continue;
 
-			if (port_info->ability[cnt].rxtx == rxtx)
-				memset(&port_info->ability[cnt], 0x00,
+			if (cnt_upd != cnt)
+				memcpy(&port_info->ability[cnt_upd],
+					&port_info->ability[cnt],
 					sizeof(struct spp_port_ability));
+			cnt_upd++;
 		}
+		memset(&port_info->ability[cnt_upd], 0x00,
+				sizeof(struct spp_port_ability) *
+				(SPP_PORT_ABILITY_MAX - cnt_upd));
 
 		ret_del = get_del_port_element(port_info, *num, ports);
 		if (ret_del == 0)
@@ -492,6 +631,128 @@ spp_update_port(enum spp_command_action action,
 	return ret;
 }
 
+/* Check if given mirror filters match the same packets. */
+static int
+is_same_filter(const struct spp_mirror_filter *a,
+		const struct spp_mirror_filter *b)
+{
+	if (a->type != b->type)
+		return 0;
+
+	switch (a->type) {
+	case SPP_MIRROR_FILTER_MAC:
+		return a->data.mac == b->data.mac;
+	case SPP_MIRROR_FILTER_VLAN:
+		return a->data.vid == b->data.vid;
+	case SPP_MIRROR_FILTER_ETHER_TYPE:
+		return a->data.ether_type == b->data.ether_type;
+	case SPP_MIRROR_FILTER_IP:
+		return a->data.ip.family == b->data.ip.family &&
+			a->data.ip.prefix_len == b->data.ip.prefix_len &&
+			memcmp(a->data.ip.addr, b->data.ip.addr,
+			(a->data.ip.family == AF_INET) ? 4 : 16) == 0;
+	case SPP_MIRROR_FILTER_L4_PORT:
+		return a->data.l4_port == b->data.l4_port;
+	case SPP_MIRROR_FILTER_BPF:
+		return strcmp(a->data.bpf_file, b->data.bpf_file) == 0;
+	default:
+		return 0;
+	}
+}
+
+/* Add or del mirror filter of component to execute it */
+static int
+spp_update_filter(enum spp_command_action action,
+		const char *name,
+		const struct spp_mirror_filter *filter)
+{
+	int cnt = 0;
+	int component_id = 0;
+	struct spp_component_info *comp_info = NULL;
+	struct spp_component_info *comp_info_base = NULL;
+	int *change_component = NULL;
+
+	component_id = spp_get_component_id(name);
+	if (component_id < 0) {
+		RTE_LOG(ERR, APP, "Unknown component by filter command. "
+				"(component = %s)\n", name);
+		return SPP_RET_NG;
+	}
+	spp_get_mng_data_addr(NULL, NULL,
+			&comp_info_base, NULL, NULL, &change_component, NULL);
+	comp_info = (comp_info_base + component_id);
+	if (comp_info->type != SPP_COMPONENT_MIRROR) {
+		RTE_LOG(ERR, APP, "Filter is only for mirror component. "
+				"(component = %s)\n", name);
+		return SPP_RET_NG;
+	}
+
+	for (cnt = 0; cnt < comp_info->num_filter; cnt++) {
+		if (is_same_filter(&comp_info->filter[cnt], filter))
+			break;
+	}
+
+	switch (action) {
+	case SPP_CMD_ACTION_ADD:
+		if (cnt < comp_info->num_filter)
+			return SPP_RET_OK;
+
+		if (comp_info->num_filter >= SPP_MIRROR_FILTER_MAX) {
+			RTE_LOG(ERR, APP, "No space of filter.\n");
+			return SPP_RET_NG;
+		}
+		memcpy(&comp_info->filter[comp_info->num_filter], filter,
+				sizeof(struct spp_mirror_filter));
+		comp_info->num_filter++;
+		break;
+
+	case SPP_CMD_ACTION_DEL:
+		if (cnt >= comp_info->num_filter)
+			return SPP_RET_OK;
+
+		comp_info->num_filter--;
+		memmove(&comp_info->filter[cnt], &comp_info->filter[cnt + 1],
+				sizeof(struct spp_mirror_filter) *
+				(comp_info->num_filter - cnt));
+		break;
+
+	default:
+		return SPP_RET_NG;
+	}
+
+	*(change_component + component_id) = 1;
+	return SPP_RET_OK;
+}
+
+/* Set length of packets mirrored by component to execute it */
+static int
+spp_update_snaplen(const char *name, unsigned int snaplen)
+{
+	int component_id = 0;
+	struct spp_component_info *comp_info = NULL;
+	struct spp_component_info *comp_info_base = NULL;
+	int *change_component = NULL;
+
+	component_id = spp_get_component_id(name);
+	if (component_id < 0) {
+		RTE_LOG(ERR, APP, "Unknown component by snaplen command. "
+				"(component = %s)\n", name);
+		return SPP_RET_NG;
+	}
+	spp_get_mng_data_addr(NULL, NULL,
+			&comp_info_base, NULL, NULL, &change_component, NULL);
+	comp_info = (comp_info_base + component_id);
+	if (comp_info->type != SPP_COMPONENT_MIRROR) {
+		RTE_LOG(ERR, APP, "Snaplen is only for mirror component. "
+				"(component = %s)\n", name);
+		return SPP_RET_NG;
+	}
+
+	comp_info->snaplen = snaplen;
+	*(change_component + component_id) = 1;
+	return SPP_RET_OK;
+}
+
 /* Flush command to execute it */
 static int
 spp_flush(void)
@@ -508,6 +769,7 @@ spp_flush(void)
 		return ret;
 
 	/* Flush of core index. */
+	flush_moved_component();
 	flush_core();
 
 	/* Flush of component */
@@ -655,6 +917,27 @@ append_json_uint_value(const char *name, char **output, unsigned int value)
 	return SPP_RET_OK;
 }
 
+/* append data of 64-bit unsigned integral type for JSON format */
+static int
+append_json_uint64_value(const char *name, char **output, uint64_t value)
+{
+	int len = strlen(*output);
+	/* extend the buffer */
+	*output = spp_strbuf_append(*output, "",
+			strlen(name) + CMD_TAG_APPEND_SIZE*2);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"JSON's numeric format failed to add. "
+				"(name = %s, uint64 = %"PRIu64")\n",
+				name, value);
+		return SPP_RET_NG;
+	}
+
+	sprintf(&(*output)[len], JSON_APPEND_VALUE("%"PRIu64),
+			JSON_APPEND_COMMA(len), name, value);
+	return SPP_RET_OK;
+}
+
 /* append data of integral type for JSON format */
 static int
 append_json_int_value(const char *name, char **output, int value)
@@ -770,7 +1053,8 @@ execute_command(const struct spp_command *command)
 				command->spec.component.action,
 				command->spec.component.name,
 				command->spec.component.core,
-				command->spec.component.type);
+				command->spec.component.type,
+				command->spec.component.copy_mode);
 		if (ret == 0) {
 			RTE_LOG(INFO, SPP_COMMAND_PROC,
 					"Execute flush.\n");
@@ -795,6 +1079,34 @@ execute_command(const struct spp_command *command)
 		}
 		break;
 
+	case SPP_CMDTYPE_FILTER:
+		RTE_LOG(INFO, SPP_COMMAND_PROC,
+				"Execute filter command. (act = %d)\n",
+				command->spec.filter.action);
+		ret = spp_update_filter(
+				command->spec.filter.action,
+				command->spec.filter.name,
+				&command->spec.filter.filter);
+		if (ret == 0) {
+			RTE_LOG(INFO, SPP_COMMAND_PROC,
+					"Execute flush.\n");
+			ret = spp_flush();
+		}
+		break;
+
+	case SPP_CMDTYPE_SNAPLEN:
+		RTE_LOG(INFO, SPP_COMMAND_PROC,
+				"Execute snaplen command.\n");
+		ret = spp_update_snaplen(
+				command->spec.snaplen.name,
+				command->spec.snaplen.snaplen);
+		if (ret == 0) {
+			RTE_LOG(INFO, SPP_COMMAND_PROC,
+					"Execute flush.\n");
+			ret = spp_flush();
+		}
+		break;
+
 	default:
 		RTE_LOG(INFO, SPP_COMMAND_PROC,
 				"Execute other command. type=%d\n",
@@ -1079,6 +1391,191 @@ append_vlan_block(const char *name, char **output,
 	return ret;
 }
 
+/* append parameters and counters of sampling for JSON format */
+static int
+append_sample_value(char **output, const int port_id,
+		const struct spp_port_ability *ability)
+{
+	int ret = SPP_RET_NG;
+	char ring_str[CMD_TAG_APPEND_SIZE];
+	const struct spp_sample_info *sample = &ability->data.sample;
+	struct spp_port_sample_stats stats;
+
+	spp_format_port_string(ring_str, sample->ring.iface_type,
+			sample->ring.iface_no);
+	ret = append_json_str_value("ring", output, ring_str);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_str_value("mode", output,
+			sample->mode == SPP_SAMPLE_MODE_RANDOM ?
+			"random" : "every");
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_uint_value("rate", output, sample->rate);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_uint_value("snaplen", output, sample->snaplen);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	spp_port_ability_get_sample_stats(port_id, ability->rxtx, &stats);
+	ret = append_json_uint64_value("sampled", output, stats.sampled);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	return append_json_uint64_value("dropped", output, stats.dropped);
+}
+
+/* append parameters of port ability limiting rate for JSON format */
+static int
+append_meter_value(char **output, const struct spp_port_ability *ability)
+{
+	int ret = SPP_RET_NG;
+	const struct spp_meter_info *meter = &ability->data.meter;
+
+	if (ability->ope == SPP_PORT_ABILITY_OPE_POLICE_TB) {
+		ret = append_json_str_value("unit", output,
+				meter->unit == SPP_METER_UNIT_BPS ?
+				"bps" : "pps");
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+
+		ret = append_json_uint64_value("rate", output, meter->cir);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+
+		return append_json_uint64_value("burst", output, meter->cbs);
+	}
+
+	ret = append_json_uint64_value("cir", output, meter->cir);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	if (ability->ope == SPP_PORT_ABILITY_OPE_POLICE_TRTCM) {
+		ret = append_json_uint64_value("pir", output, meter->pir);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+	}
+
+	ret = append_json_uint64_value("cbs", output, meter->cbs);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	if (ability->ope == SPP_PORT_ABILITY_OPE_POLICE_TRTCM)
+		return append_json_uint64_value("pbs", output, meter->pbs);
+	return append_json_uint64_value("ebs", output, meter->ebs);
+}
+
+/* append a block of port ability for JSON format */
+static int
+append_ability_block(char **output, const int port_id,
+		const struct spp_port_ability *ability)
+{
+	int ret = SPP_RET_NG;
+	struct spp_port_meter_stats stats;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (name = ability_block)\n");
+		return SPP_RET_NG;
+	}
+
+	ret = append_json_str_value("operation", &tmp_buff,
+			PORT_ABILITY_OPE_STATUS_STRINGS[ability->ope]);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	switch (ability->ope) {
+	case SPP_PORT_ABILITY_OPE_ADD_VLANTAG:
+	case SPP_PORT_ABILITY_OPE_ADD_QINQ:
+		ret = append_json_int_value("id", &tmp_buff,
+				ability->data.vlantag.vid);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+
+		ret = append_json_int_value("pcp", &tmp_buff,
+				ability->data.vlantag.pcp);
+		break;
+	case SPP_PORT_ABILITY_OPE_SET_SRC_MAC:
+	case SPP_PORT_ABILITY_OPE_SET_DST_MAC:
+		ret = append_json_str_value("mac", &tmp_buff,
+				ability->data.mac.addr_str);
+		break;
+	case SPP_PORT_ABILITY_OPE_SET_DSCP:
+		ret = append_json_int_value("dscp", &tmp_buff,
+				ability->data.dscp.dscp);
+		break;
+	case SPP_PORT_ABILITY_OPE_POLICE_SRTCM:
+	case SPP_PORT_ABILITY_OPE_POLICE_TRTCM:
+	case SPP_PORT_ABILITY_OPE_POLICE_TB:
+		ret = append_meter_value(&tmp_buff, ability);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+
+		spp_port_ability_get_meter_stats(port_id, ability->rxtx,
+				ability->ope, &stats);
+		ret = append_json_uint64_value("conform", &tmp_buff,
+				stats.conform);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+
+		ret = append_json_uint64_value("exceed", &tmp_buff,
+				stats.exceed);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+
+		ret = append_json_uint64_value("violate", &tmp_buff,
+				stats.violate);
+		break;
+	case SPP_PORT_ABILITY_OPE_SAMPLE:
+		ret = append_sample_value(&tmp_buff, port_id, ability);
+		break;
+	default:
+		/* no parameter */
+		break;
+	}
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_block_brackets("", output, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append a list of port abilities for JSON format */
+static int
+append_ability_array(const char *name, char **output,
+		const int port_id, const enum spp_port_rxtx rxtx)
+{
+	int ret = SPP_RET_NG;
+	int i = 0;
+	struct spp_port_ability *info = NULL;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (name = %s)\n",
+				name);
+		return SPP_RET_NG;
+	}
+
+	spp_port_ability_get_info(port_id, rxtx, &info);
+	for (i = 0; i < SPP_PORT_ABILITY_MAX; i++) {
+		if (info[i].ope == SPP_PORT_ABILITY_OPE_NONE)
+			break;
+
+		ret = append_ability_block(&tmp_buff, port_id, &info[i]);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+	}
+
+	ret = append_json_array_brackets(name, output, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 /* append a block of port numbers for JSON format */
 static int
 append_port_block(char **output, const struct spp_port_index *port,
@@ -1104,6 +1601,12 @@ append_port_block(char **output, const struct spp_port_index *port,
 	if (unlikely(ret < SPP_RET_OK))
 		return SPP_RET_NG;
 
+	ret = append_ability_array("ability", &tmp_buff,
+			spp_get_dpdk_port(port->iface_type, port->iface_no),
+			rxtx);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
 	ret = append_json_block_brackets("", output, tmp_buff);
 	spp_strbuf_free(tmp_buff);
 	return ret;
@@ -1136,6 +1639,188 @@ append_port_array(const char *name, char **output, const int num,
 	return ret;
 }
 
+#ifdef SPP_MIRROR_MODULE
+/* append a block of mirror filter for JSON format */
+static int
+append_filter_block(char **output, const struct spp_mirror_filter *filter)
+{
+	int ret = SPP_RET_NG;
+	int len = 0;
+	const uint8_t *mac = (const uint8_t *)&filter->data.mac;
+	char value[SPP_NAME_STR_LEN];
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (name = filter_block)\n");
+		return SPP_RET_NG;
+	}
+
+	switch (filter->type) {
+	case SPP_MIRROR_FILTER_MAC:
+		sprintf(value, "%02x:%02x:%02x:%02x:%02x:%02x",
+				mac[0], mac[1], mac[2],
+				mac[3], mac[4], mac[5]);
+		break;
+	case SPP_MIRROR_FILTER_VLAN:
+		sprintf(value, "%d", filter->data.vid);
+		break;
+	case SPP_MIRROR_FILTER_ETHER_TYPE:
+		sprintf(value, "0x%04x", filter->data.ether_type);
+		break;
+	case SPP_MIRROR_FILTER_IP:
+		inet_ntop(filter->data.ip.family, filter->data.ip.addr,
+				value, sizeof(value));
+		len = strlen(value);
+		sprintf(&value[len], "/%d", filter->data.ip.prefix_len);
+		break;
+	case SPP_MIRROR_FILTER_L4_PORT:
+		sprintf(value, "%u", filter->data.l4_port);
+		break;
+	case SPP_MIRROR_FILTER_BPF:
+		strcpy(value, filter->data.bpf_file);
+		break;
+	default:
+		value[0] = '\0';
+		break;
+	}
+
+	ret = append_json_str_value("type", &tmp_buff,
+			MIRROR_FILTER_TYPE_STATUS_STRINGS[filter->type]);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_str_value("value", &tmp_buff, value);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_block_brackets("", output, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append a list of mirror filters of component for JSON format */
+static int
+append_filter_array(const char *name, char **output,
+		const struct spp_component_info *comp_info)
+{
+	int ret = SPP_RET_NG;
+	int i = 0;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (name = %s)\n",
+				name);
+		return SPP_RET_NG;
+	}
+
+	for (i = 0; i < comp_info->num_filter; i++) {
+		ret = append_filter_block(&tmp_buff, &comp_info->filter[i]);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+	}
+
+	ret = append_json_array_brackets(name, output, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append a block of counters of tx port of mirror for JSON format */
+static int
+append_mirror_tx_stats_block(char **output, int component_id,
+		const struct spp_port_info *port)
+{
+	int ret = SPP_RET_NG;
+	char port_str[CMD_TAG_APPEND_SIZE];
+	struct spp_mirror_tx_stats stats;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (name = tx_stats_block)\n");
+		return SPP_RET_NG;
+	}
+
+	spp_mirror_get_tx_stats(component_id, port->dpdk_port, &stats);
+
+	spp_format_port_string(port_str, port->iface_type, port->iface_no);
+	ret = append_json_str_value("port", &tmp_buff, port_str);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_uint64_value("sent", &tmp_buff, stats.sent);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_uint64_value("dropped", &tmp_buff, stats.dropped);
+	if (unlikely(ret < SPP_RET_OK))
+		return SPP_RET_NG;
+
+	ret = append_json_block_brackets("", output, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append a list of counters of tx ports of mirror for JSON format */
+static int
+append_mirror_tx_stats_array(const char *name, char **output,
+		int component_id, const struct spp_component_info *comp_info)
+{
+	int ret = SPP_RET_NG;
+	int i = 0;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, SPP_COMMAND_PROC,
+				"allocate error. (name = %s)\n",
+				name);
+		return SPP_RET_NG;
+	}
+
+	for (i = 0; i < comp_info->num_tx_port; i++) {
+		if (comp_info->tx_ports[i]->dpdk_port < 0)
+			continue;
+
+		ret = append_mirror_tx_stats_block(&tmp_buff, component_id,
+				comp_info->tx_ports[i]);
+		if (unlikely(ret < SPP_RET_OK))
+			return SPP_RET_NG;
+	}
+
+	ret = append_json_array_brackets(name, output, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append settings of mirror component for JSON format */
+static int
+append_mirror_settings(char **output, const char *comp_name)
+{
+	int ret = SPP_RET_NG;
+	int component_id = spp_get_component_id(comp_name);
+	struct spp_component_info *comp_info = NULL;
+
+	if (unlikely(component_id < 0))
+		return SPP_RET_OK;
+
+	spp_get_mng_data_addr(NULL, NULL, &comp_info, NULL, NULL, NULL, NULL);
+	comp_info += component_id;
+
+	ret = append_json_str_value("copy_mode", output,
+			MIRROR_COPY_MODE_STATUS_STRINGS[comp_info->copy_mode]);
+	if (unlikely(ret < SPP_RET_OK))
+		return ret;
+
+	ret = append_json_uint_value("snaplen", output, comp_info->snaplen);
+	if (unlikely(ret < SPP_RET_OK))
+		return ret;
+
+	ret = append_filter_array("filter", output, comp_info);
+	if (unlikely(ret < SPP_RET_OK))
+		return ret;
+
+	return append_mirror_tx_stats_array("tx_stats", output,
+			component_id, comp_info);
+}
+#endif /* SPP_MIRROR_MODULE */
+
 /* append one element of core information for JSON format */
 static int
 append_core_element_value(
@@ -1184,6 +1869,12 @@ append_core_element_value(
 				num_tx, tx_ports, SPP_PORT_RXTX_TX);
 		if (unlikely(ret < SPP_RET_OK))
 			return ret;
+
+#ifdef SPP_MIRROR_MODULE
+		ret = append_mirror_settings(&tmp_buff, name);
+		if (unlikely(ret < SPP_RET_OK))
+			return ret;
+#endif /* SPP_MIRROR_MODULE */
 	}
 
 	ret = append_json_block_brackets("", &buff, tmp_buff);
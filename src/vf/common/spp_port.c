@@ -6,246 +6,1572 @@
 #include <rte_ip.h>
 #include <rte_udp.h>
 #include <rte_tcp.h>
-#include <rte_net_crc.h>
+#include <rte_ethdev.h>
+#include <rte_cpuflags.h>
+#include <rte_prefetch.h>
+#include <rte_malloc.h>
+#include <rte_version.h>
+#include <rte_meter.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+#include <rte_mempool.h>
+#ifdef RTE_ARCH_X86
+#include <immintrin.h>
+#endif /* RTE_ARCH_X86 */
+
+/*
+ * Meters of port abilities are configured with profiles, which are
+ * introduced in DPDK v18.08.
+ */
+#if RTE_VERSION < RTE_VERSION_NUM(18, 8, 0, 0)
+#error "DPDK v18.08 or later is required for meter profiles"
+#endif
+
+/*
+ * RCU library is experimental API of DPDK v19.05 or later. Quiescent state
+ * of readers is tracked in SPP itself for earlier versions.
+ */
+#if RTE_VERSION >= RTE_VERSION_NUM(19, 5, 0, 0)
+#include <rte_rcu_qsbr.h>
+#define SPP_PORT_ABILITY_RCU
+#endif
 
 #include "spp_port.h"
 #include "ringlatencystats.h"
 
-/* Port ability management information */
-struct port_ability_mng_info {
-	volatile int ref_index; /* Index to reference area */
-	volatile int upd_index; /* Index to update area    */
-	struct spp_port_ability ability[SPP_INFO_AREA_MAX]
-				[SPP_PORT_ABILITY_MAX];
-				/* Port ability information */
-};
+/* TPID of outer VLAN tag for QinQ (IEEE 802.1ad). */
+#define SPP_ETHER_TYPE_QINQ 0x88a8
+
+/* Mask of DSCP in Traffic Class of IPv6 header (host order). */
+#define SPP_IPV6_DSCP_SHIFT 22
+#define SPP_IPV6_DSCP_MASK  (0x3f << SPP_IPV6_DSCP_SHIFT)
+
+/* Length of frame header handled in a vector register. */
+#define SPP_VLAN_BURST_HDR_LEN 16
+
+/* Number of packets processed by a burst kernel of each instruction set. */
+#define SPP_VLAN_BURST_SSE_NUM  4
+#define SPP_VLAN_BURST_AVX2_NUM 8
+
+/* Definition of function that operates a port ability on a packet. */
+typedef int (*port_ability_pkt_func)(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx);
+
+/**
+ * Definition of function that operates a port ability on a burst of
+ * packets. Packets failed are moved to the end of `pkts`, and the number
+ * of passed packets is returned.
+ */
+typedef uint16_t (*port_ability_func)(
+		struct rte_mbuf **pkts,
+		uint16_t nb_pkts,
+		const union spp_ability_data *data,
+		void *ctx);
+
+/* Definition of function that operates a port ability on packets. */
+typedef int (*port_ability_burst_func)(
+		struct rte_mbuf **pkts,
+		const union spp_ability_data *data);
+
+/* Burst kernel processing fixed number of packets at once. */
+struct port_ability_burst {
+	port_ability_burst_func func; /* Kernel, or NULL if not used */
+	int num;                      /* Number of packets per call */
+};
+
+/* Chain of burst functions compiled from port abilities. */
+struct port_ability_chain {
+	int num; /* Number of functions */
+	port_ability_func func[SPP_PORT_ABILITY_MAX];
+				/* Functions called in order */
+	const union spp_ability_data *data[SPP_PORT_ABILITY_MAX];
+				/* Data given to each of functions */
+	void *ctx[SPP_PORT_ABILITY_MAX];
+				/* Runtime data given to each of functions */
+};
+
+/* Runtime data of port ability limiting rate */
+struct port_ability_meter {
+	union {
+		struct rte_meter_srtcm srtcm;
+		struct rte_meter_trtcm trtcm;
+	} m;                    /* Run-time data of meter */
+	union {
+		struct rte_meter_srtcm_profile srtcm;
+		struct rte_meter_trtcm_profile trtcm;
+	} profile;              /* Profile of meter */
+	struct spp_port_meter_stats *stats;
+				/* Counters of results of meter */
+};
+
+/* Runtime data of sampling port ability */
+struct port_ability_sample {
+	struct rte_ring *ring;       /* Ring to send sampled packets */
+	struct rte_mempool *pool;    /* Pool of copied packets */
+	uint32_t countdown;          /* Packets until next sample */
+	uint64_t rand_state;         /* State of xorshift for random mode */
+	struct spp_port_sample_stats *stats;
+				/* Counters of sampling */
+};
+
+/* Runtime data of each port ability */
+union port_ability_context {
+	struct port_ability_meter meter;   /* For limiting rate */
+	struct port_ability_sample sample; /* For sampling */
+};
+
+/* Port ability table published to workers */
+struct port_ability_table {
+	uint64_t generation;    /* Generation number of this table */
+	struct spp_port_ability ability[SPP_PORT_ABILITY_MAX];
+				/* Port ability information */
+	struct port_ability_chain chain;
+				/* Compiled port ability functions */
+	union port_ability_context context[SPP_PORT_ABILITY_MAX];
+				/* Runtime data used by functions of chain */
+};
+
+/**
+ * Port ability management information
+ *
+ * Workers refer the table pointed by `cur`. The control thread builds
+ * new abilities in the other table, publishes it by replacing `cur`,
+ * and waits for a grace period of `g_port_ability_qsbr` before the old
+ * one is reused. The grace period is waited once for all tables updated
+ * at once.
+ */
+struct port_ability_mng_info {
+	struct port_ability_table *cur; /* Table referred by workers */
+	uint64_t generation;            /* Last published generation */
+	struct port_ability_table table[SPP_INFO_AREA_MAX];
+				/* Tables of current and next generation */
+	struct spp_port_meter_stats meter_stats[SPP_PORT_ABILITY_METER_NUM];
+				/* Counters kept over generations */
+	struct spp_port_sample_stats sample_stats;
+				/* Counters of sampling */
+};
+
+/* Port ability port information */
+struct port_ability_port_mng_info {
+	/* Interface type (phy/vhost/ring) */
+	enum port_type iface_type;
+
+	/* Interface number */
+	int            iface_no;
+
+	/* VLAN tag is inserted by the device on sending */
+	int            tx_vlan_insert;
+
+	/* VLAN tag is stripped by the device on receiving */
+	int            rx_vlan_strip;
+
+	/* Management data of port ability for receiving */
+	struct port_ability_mng_info rx;
+
+	/* Management data of port ability for sending */
+	struct port_ability_mng_info tx;
+};
+
+/* Information for VLAN tag management. */
+struct port_ability_port_mng_info g_port_mng_info[RTE_MAX_ETHPORTS];
+
+/* TPID of VLAN. */
+static uint16_t g_vlan_tpid;
+
+/* TPID of outer VLAN tag for QinQ. */
+static uint16_t g_qinq_tpid;
+
+/* Burst kernels of VLAN operation selected by CPU flags. */
+static struct port_ability_burst g_add_vlantag_burst;
+static struct port_ability_burst g_del_vlantag_burst;
+
+#ifdef SPP_PORT_ABILITY_RCU
+
+/* QSBR variable of worker lcores referring port ability tables. */
+static struct rte_rcu_qsbr *g_port_ability_qsbr;
+
+/* Initialize QSBR variable of port ability. */
+static int
+port_ability_qsbr_init(void)
+{
+	size_t qsbr_size = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+
+	g_port_ability_qsbr = rte_zmalloc(NULL, qsbr_size,
+			RTE_CACHE_LINE_SIZE);
+	if (unlikely(g_port_ability_qsbr == NULL))
+		return SPP_RET_NG;
+
+	if (unlikely(rte_rcu_qsbr_init(g_port_ability_qsbr,
+			RTE_MAX_LCORE) != 0)) {
+		rte_free(g_port_ability_qsbr);
+		g_port_ability_qsbr = NULL;
+		return SPP_RET_NG;
+	}
+	return SPP_RET_OK;
+}
+
+/* Register lcore as a reader of port ability tables. */
+void
+spp_port_ability_register_lcore(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_thread_register(g_port_ability_qsbr, lcore_id);
+	rte_rcu_qsbr_thread_online(g_port_ability_qsbr, lcore_id);
+}
+
+/* Unregister lcore from readers of port ability tables. */
+void
+spp_port_ability_unregister_lcore(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_thread_offline(g_port_ability_qsbr, lcore_id);
+	rte_rcu_qsbr_thread_unregister(g_port_ability_qsbr, lcore_id);
+}
+
+/* Report that lcore does not refer any of port ability tables. */
+void
+spp_port_ability_quiescent(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_quiescent(g_port_ability_qsbr, lcore_id);
+}
+
+/* Wait until no reader refers tables replaced before. */
+static void
+port_ability_synchronize(void)
+{
+	rte_rcu_qsbr_synchronize(g_port_ability_qsbr, RTE_QSBR_THRID_INVALID);
+}
+
+#else /* SPP_PORT_ABILITY_RCU */
+
+/* Quiescent state of a reader lcore */
+struct port_ability_qs_lcore {
+	uint64_t cnt;   /* Token of the last quiescent state */
+	int online;     /* Reader refers tables */
+} __rte_cache_aligned;
+
+/* Quiescent state of reader lcores of port ability tables. */
+struct port_ability_qsbr {
+	uint64_t token; /* Incremented for each grace period */
+	struct port_ability_qs_lcore lcore[RTE_MAX_LCORE];
+};
+
+/* Quiescent state of worker lcores referring port ability tables. */
+static struct port_ability_qsbr *g_port_ability_qsbr;
+
+/* Initialize quiescent state of port ability. */
+static int
+port_ability_qsbr_init(void)
+{
+	g_port_ability_qsbr = rte_zmalloc(NULL,
+			sizeof(struct port_ability_qsbr),
+			RTE_CACHE_LINE_SIZE);
+	if (unlikely(g_port_ability_qsbr == NULL))
+		return SPP_RET_NG;
+	return SPP_RET_OK;
+}
+
+/* Register lcore as a reader of port ability tables. */
+void
+spp_port_ability_register_lcore(unsigned int lcore_id)
+{
+	struct port_ability_qs_lcore *qs =
+			&g_port_ability_qsbr->lcore[lcore_id];
+
+	__atomic_store_n(&qs->cnt, __atomic_load_n(
+			&g_port_ability_qsbr->token, __ATOMIC_ACQUIRE),
+			__ATOMIC_RELEASE);
+	__atomic_store_n(&qs->online, 1, __ATOMIC_RELEASE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/* Unregister lcore from readers of port ability tables. */
+void
+spp_port_ability_unregister_lcore(unsigned int lcore_id)
+{
+	__atomic_store_n(&g_port_ability_qsbr->lcore[lcore_id].online, 0,
+			__ATOMIC_RELEASE);
+}
+
+/* Report that lcore does not refer any of port ability tables. */
+void
+spp_port_ability_quiescent(unsigned int lcore_id)
+{
+	__atomic_store_n(&g_port_ability_qsbr->lcore[lcore_id].cnt,
+			__atomic_load_n(&g_port_ability_qsbr->token,
+			__ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+/* Wait until no reader refers tables replaced before. */
+static void
+port_ability_synchronize(void)
+{
+	unsigned int lcore_id;
+	struct port_ability_qs_lcore *qs = NULL;
+	uint64_t token = __atomic_add_fetch(&g_port_ability_qsbr->token, 1,
+			__ATOMIC_SEQ_CST);
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		qs = &g_port_ability_qsbr->lcore[lcore_id];
+		while (__atomic_load_n(&qs->online, __ATOMIC_ACQUIRE) &&
+				__atomic_load_n(&qs->cnt,
+				__ATOMIC_ACQUIRE) < token)
+			rte_pause();
+	}
+}
+
+#endif /* SPP_PORT_ABILITY_RCU */
+
+static void port_ability_select_burst(void);
+
+/* Initialize port ability. */
+int
+spp_port_ability_init(void)
+{
+	int cnt = 0;
+
+	g_vlan_tpid = rte_cpu_to_be_16(ETHER_TYPE_VLAN);
+	g_qinq_tpid = rte_cpu_to_be_16(SPP_ETHER_TYPE_QINQ);
+	memset(g_port_mng_info, 0x00, sizeof(g_port_mng_info));
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		g_port_mng_info[cnt].rx.cur = &g_port_mng_info[cnt].rx.table[0];
+		g_port_mng_info[cnt].tx.cur = &g_port_mng_info[cnt].tx.table[0];
+	}
+
+	if (unlikely(port_ability_qsbr_init() != SPP_RET_OK)) {
+		RTE_LOG(ERR, PORT, "Cannot initialize QSBR variable "
+				"of port ability.\n");
+		return SPP_RET_NG;
+	}
+
+	port_ability_select_burst();
+	return SPP_RET_OK;
+}
+
+/* Get management information of port ability for rx or tx. */
+static inline struct port_ability_mng_info *
+port_ability_get_mng_info(int port_id, enum spp_port_rxtx rxtx)
+{
+	if (rxtx == SPP_PORT_RXTX_RX)
+		return &g_port_mng_info[port_id].rx;
+	return &g_port_mng_info[port_id].tx;
+}
+
+/* Get port ability table currently published. */
+static inline const struct port_ability_table *
+port_ability_get_table(const struct port_ability_mng_info *mng)
+{
+	return __atomic_load_n(&mng->cur, __ATOMIC_ACQUIRE);
+}
+
+/* Get information of port ability. */
+void
+spp_port_ability_get_info(
+		int port_id, enum spp_port_rxtx rxtx,
+		struct spp_port_ability **info)
+{
+	struct port_ability_mng_info *mng =
+			port_ability_get_mng_info(port_id, rxtx);
+
+	/* Only the control thread replaces tables, no grace period needed */
+	*info = mng->cur->ability;
+}
+
+/* Get counters of port ability limiting rate. */
+void
+spp_port_ability_get_meter_stats(
+		int port_id, enum spp_port_rxtx rxtx,
+		enum spp_port_ability_ope ope,
+		struct spp_port_meter_stats *stats)
+{
+	struct port_ability_mng_info *mng =
+			port_ability_get_mng_info(port_id, rxtx);
+	struct spp_port_meter_stats *cur = &mng->meter_stats[ope -
+			SPP_PORT_ABILITY_OPE_POLICE_SRTCM];
+
+	/* Counters are updated atomically by workers. */
+	stats->conform = __atomic_load_n(&cur->conform, __ATOMIC_RELAXED);
+	stats->exceed = __atomic_load_n(&cur->exceed, __ATOMIC_RELAXED);
+	stats->violate = __atomic_load_n(&cur->violate, __ATOMIC_RELAXED);
+}
+
+/* Get counters of sampling port ability. */
+void
+spp_port_ability_get_sample_stats(
+		int port_id, enum spp_port_rxtx rxtx,
+		struct spp_port_sample_stats *stats)
+{
+	struct port_ability_mng_info *mng =
+			port_ability_get_mng_info(port_id, rxtx);
+
+	/* Counters are updated atomically by workers. */
+	stats->sampled = __atomic_load_n(&mng->sample_stats.sampled,
+			__ATOMIC_RELAXED);
+	stats->dropped = __atomic_load_n(&mng->sample_stats.dropped,
+			__ATOMIC_RELAXED);
+}
+
+/* Add tag of given TPID to packet, or update TCI if it is tagged. */
+static inline int
+add_tag_packet(struct rte_mbuf *pkt, uint16_t tpid, uint16_t tci)
+{
+	struct ether_hdr *old_ether = NULL;
+	struct ether_hdr *new_ether = NULL;
+	struct vlan_hdr  *vlan      = NULL;
+
+	old_ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	if (old_ether->ether_type == tpid) {
+		/* For packets with VLAN tags, only VLAN ID is updated */
+		new_ether = old_ether;
+		vlan = (struct vlan_hdr *)&new_ether[1];
+	} else {
+		/* For packets without VLAN tag, add VLAN tag. */
+		new_ether = (struct ether_hdr *)rte_pktmbuf_prepend(pkt,
+				sizeof(struct vlan_hdr));
+		if (unlikely(new_ether == NULL)) {
+			RTE_LOG(ERR, PORT, "Failed to "
+					"get additional header area.\n");
+			return SPP_RET_NG;
+		}
+
+		rte_memcpy(new_ether, old_ether, sizeof(struct ether_hdr));
+		vlan = (struct vlan_hdr *)&new_ether[1];
+		vlan->eth_proto = new_ether->ether_type;
+		new_ether->ether_type = tpid;
+	}
+
+	vlan->vlan_tci = tci;
+	return SPP_RET_OK;
+}
+
+/* Delete outermost tag of given TPID from packet. */
+static inline int
+del_tag_packet(struct rte_mbuf *pkt, uint16_t tpid)
+{
+	struct ether_hdr *old_ether = NULL;
+	struct ether_hdr *new_ether = NULL;
+	uint32_t *old, *new;
+
+	old_ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	if (old_ether->ether_type == tpid) {
+		/* For packets without VLAN tag, delete VLAN tag. */
+		new_ether = (struct ether_hdr *)rte_pktmbuf_adj(pkt,
+				sizeof(struct vlan_hdr));
+		if (unlikely(new_ether == NULL)) {
+			RTE_LOG(ERR, PORT, "Failed to "
+					"delete unnecessary header area.\n");
+			return SPP_RET_NG;
+		}
+
+		old = (uint32_t *)old_ether;
+		new = (uint32_t *)new_ether;
+		new[2] = old[2];
+		new[1] = old[1];
+		new[0] = old[0];
+		old[0] = 0;
+	}
+	return SPP_RET_OK;
+}
+
+/* Add VLAN tag to packet. */
+static inline int
+add_vlantag_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx __attribute__ ((unused)))
+{
+	return add_tag_packet(pkt, g_vlan_tpid, data->vlantag.tci);
+}
+
+/* Delete VLAN tag to packet. */
+static inline int
+del_vlantag_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data __attribute__ ((unused)),
+		void *ctx __attribute__ ((unused)))
+{
+	return del_tag_packet(pkt, g_vlan_tpid);
+}
+
+/* Add outer VLAN tag of QinQ to packet. */
+static inline int
+add_qinq_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx __attribute__ ((unused)))
+{
+	return add_tag_packet(pkt, g_qinq_tpid, data->vlantag.tci);
+}
+
+/* Delete outer VLAN tag of QinQ from packet. */
+static inline int
+del_qinq_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data __attribute__ ((unused)),
+		void *ctx __attribute__ ((unused)))
+{
+	return del_tag_packet(pkt, g_qinq_tpid);
+}
+
+/**
+ * Add VLAN tag to packet by the device.
+ *
+ * Tag is inserted by the device with PKT_TX_VLAN_PKT. Tagged packets are
+ * updated in place as software path because the device adds another tag.
+ */
+static inline int
+add_vlantag_packet_offload(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx __attribute__ ((unused)))
+{
+	struct ether_hdr *ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	if (unlikely(ether->ether_type == g_vlan_tpid)) {
+		((struct vlan_hdr *)&ether[1])->vlan_tci = data->vlantag.tci;
+		return SPP_RET_OK;
+	}
+
+	pkt->vlan_tci = rte_be_to_cpu_16(data->vlantag.tci);
+	pkt->ol_flags |= PKT_TX_VLAN_PKT;
+	return SPP_RET_OK;
+}
+
+/**
+ * Delete VLAN tag to packet stripped by the device.
+ *
+ * Stripped tag is only kept in mbuf, so it is cleared. Packets which are
+ * not stripped by the device are handled as software path.
+ */
+static inline int
+del_vlantag_packet_offload(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx)
+{
+	if (likely(pkt->ol_flags & PKT_RX_VLAN_STRIPPED)) {
+		pkt->ol_flags &= ~(PKT_RX_VLAN | PKT_RX_VLAN_STRIPPED);
+		pkt->vlan_tci = 0;
+		return SPP_RET_OK;
+	}
+
+	return del_vlantag_packet(pkt, data, ctx);
+}
+
+/* Rewrite source MAC address of packet. */
+static inline int
+set_src_mac_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx __attribute__ ((unused)))
+{
+	struct ether_hdr *ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	ether_addr_copy((const struct ether_addr *)&data->mac.addr,
+			&ether->s_addr);
+	return SPP_RET_OK;
+}
+
+/* Rewrite destination MAC address of packet. */
+static inline int
+set_dst_mac_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx __attribute__ ((unused)))
+{
+	struct ether_hdr *ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	ether_addr_copy((const struct ether_addr *)&data->mac.addr,
+			&ether->d_addr);
+	return SPP_RET_OK;
+}
+
+/**
+ * Get L3 header following VLAN tags.
+ *
+ * Return NULL if the packet is too short for the L3 header of `l3_len`.
+ */
+static inline void *
+get_l3_header(struct rte_mbuf *pkt, uint16_t *ether_type, uint32_t l3_len)
+{
+	struct ether_hdr *ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
+	struct vlan_hdr *vlan = NULL;
+	uint16_t type = ether->ether_type;
+	uint32_t offset = sizeof(struct ether_hdr);
+
+	while (type == g_vlan_tpid || type == g_qinq_tpid) {
+		if (unlikely(offset + sizeof(struct vlan_hdr) >
+				pkt->data_len))
+			return NULL;
+
+		vlan = rte_pktmbuf_mtod_offset(pkt, struct vlan_hdr *,
+				offset);
+		type = vlan->eth_proto;
+		offset += sizeof(struct vlan_hdr);
+	}
+
+	if (unlikely(offset + l3_len > pkt->data_len))
+		return NULL;
+
+	*ether_type = type;
+	return rte_pktmbuf_mtod_offset(pkt, void *, offset);
+}
+
+/**
+ * Update checksum of IPv4 header incrementally as RFC 1624 for a 16-bit
+ * word changed from `old_val` to `new_val` given in host order.
+ */
+static inline void
+update_ipv4_cksum(struct ipv4_hdr *ip, uint16_t old_val, uint16_t new_val)
+{
+	uint32_t sum = (uint16_t)~rte_be_to_cpu_16(ip->hdr_checksum);
+	sum += (uint16_t)~old_val;
+	sum += new_val;
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	ip->hdr_checksum = rte_cpu_to_be_16((uint16_t)~sum);
+}
+
+/* Decrement TTL of IPv4 or hop limit of IPv6, and drop if expired. */
+static inline int
+dec_ttl_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data __attribute__ ((unused)),
+		void *ctx __attribute__ ((unused)))
+{
+	uint16_t ether_type = 0;
+	uint16_t old_val = 0;
+	struct ipv4_hdr *ipv4 = NULL;
+	struct ipv6_hdr *ipv6 = NULL;
+
+	ipv4 = get_l3_header(pkt, &ether_type, sizeof(struct ipv4_hdr));
+	if (unlikely(ipv4 == NULL))
+		return SPP_RET_OK;
+
+	if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+		if (unlikely(ipv4->time_to_live <= 1))
+			return SPP_RET_NG;
+
+		old_val = (ipv4->time_to_live << 8) | ipv4->next_proto_id;
+		ipv4->time_to_live--;
+		update_ipv4_cksum(ipv4, old_val, old_val - 0x0100);
+	} else if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
+		ipv6 = get_l3_header(pkt, &ether_type,
+				sizeof(struct ipv6_hdr));
+		if (unlikely(ipv6 == NULL))
+			return SPP_RET_OK;
+
+		if (unlikely(ipv6->hop_limits <= 1))
+			return SPP_RET_NG;
+
+		ipv6->hop_limits--;
+	}
+	return SPP_RET_OK;
+}
+
+/* Remark DSCP of IPv4 or IPv6 packet. */
+static inline int
+set_dscp_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx __attribute__ ((unused)))
+{
+	uint16_t ether_type = 0;
+	uint16_t old_val, new_val;
+	uint32_t vtc_flow = 0;
+	struct ipv4_hdr *ipv4 = NULL;
+	struct ipv6_hdr *ipv6 = NULL;
+
+	ipv4 = get_l3_header(pkt, &ether_type, sizeof(struct ipv4_hdr));
+	if (unlikely(ipv4 == NULL))
+		return SPP_RET_OK;
+
+	if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+		old_val = (ipv4->version_ihl << 8) | ipv4->type_of_service;
+		ipv4->type_of_service = (data->dscp.dscp << 2) |
+				(ipv4->type_of_service & 0x03);
+		new_val = (ipv4->version_ihl << 8) | ipv4->type_of_service;
+		update_ipv4_cksum(ipv4, old_val, new_val);
+	} else if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
+		ipv6 = get_l3_header(pkt, &ether_type,
+				sizeof(struct ipv6_hdr));
+		if (unlikely(ipv6 == NULL))
+			return SPP_RET_OK;
+
+		vtc_flow = rte_be_to_cpu_32(ipv6->vtc_flow);
+		vtc_flow = (vtc_flow & ~SPP_IPV6_DSCP_MASK) |
+				((uint32_t)data->dscp.dscp <<
+				SPP_IPV6_DSCP_SHIFT);
+		ipv6->vtc_flow = rte_cpu_to_be_32(vtc_flow);
+	}
+	return SPP_RET_OK;
+}
+
+/* Definition of function that checks color of a packet with meter. */
+typedef enum rte_meter_color (*port_ability_color_func)(
+		struct port_ability_meter *meter,
+		const union spp_ability_data *data,
+		struct rte_mbuf *pkt,
+		uint64_t time);
+
+/* Check color of packet with single rate three color marker. */
+static inline enum rte_meter_color
+police_srtcm_color(
+		struct port_ability_meter *meter,
+		const union spp_ability_data *data __attribute__ ((unused)),
+		struct rte_mbuf *pkt,
+		uint64_t time)
+{
+	return rte_meter_srtcm_color_blind_check(&meter->m.srtcm,
+			&meter->profile.srtcm, time, rte_pktmbuf_pkt_len(pkt));
+}
+
+/* Check color of packet with two rate three color marker. */
+static inline enum rte_meter_color
+police_trtcm_color(
+		struct port_ability_meter *meter,
+		const union spp_ability_data *data __attribute__ ((unused)),
+		struct rte_mbuf *pkt,
+		uint64_t time)
+{
+	return rte_meter_trtcm_color_blind_check(&meter->m.trtcm,
+			&meter->profile.trtcm, time, rte_pktmbuf_pkt_len(pkt));
+}
+
+/**
+ * Check color of packet with token bucket policer.
+ *
+ * srTCM of which excess burst size is zero is used as a token bucket.
+ * Packet consumes one token in pps, or its length in bps.
+ */
+static inline enum rte_meter_color
+police_tb_color(
+		struct port_ability_meter *meter,
+		const union spp_ability_data *data,
+		struct rte_mbuf *pkt,
+		uint64_t time)
+{
+	uint32_t len = 1;
+
+	if (data->meter.unit == SPP_METER_UNIT_BPS)
+		len = rte_pktmbuf_pkt_len(pkt);
+
+	return rte_meter_srtcm_color_blind_check(&meter->m.srtcm,
+			&meter->profile.srtcm, time, len);
+}
+
+/**
+ * Police packets with meter, and drop packets marked as red.
+ *
+ * Time is read once per burst. Results are counted locally and added to
+ * the counters atomically at the end of burst, because the counters are
+ * read by the control thread while workers update them.
+ */
+static __rte_always_inline uint16_t
+port_ability_apply_meter(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data,
+		struct port_ability_meter *meter,
+		port_ability_color_func check)
+{
+	uint16_t cnt;
+	uint16_t ok_pkts = 0;
+	uint64_t colors[e_RTE_METER_COLORS] = { 0 };
+	uint64_t time = rte_rdtsc();
+	enum rte_meter_color color;
+	struct rte_mbuf *pkt = NULL;
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		pkt = pkts[cnt];
+		color = (*check)(meter, data, pkt, time);
+		colors[color]++;
+		if (unlikely(color == e_RTE_METER_RED))
+			continue;
+
+		pkts[cnt] = pkts[ok_pkts];
+		pkts[ok_pkts++] = pkt;
+	}
+
+	if (colors[e_RTE_METER_GREEN] != 0)
+		__atomic_fetch_add(&meter->stats->conform,
+				colors[e_RTE_METER_GREEN], __ATOMIC_RELAXED);
+	if (colors[e_RTE_METER_YELLOW] != 0)
+		__atomic_fetch_add(&meter->stats->exceed,
+				colors[e_RTE_METER_YELLOW], __ATOMIC_RELAXED);
+	if (colors[e_RTE_METER_RED] != 0)
+		__atomic_fetch_add(&meter->stats->violate,
+				colors[e_RTE_METER_RED], __ATOMIC_RELAXED);
+	return ok_pkts;
+}
+
+/* Police packets with single rate three color marker. */
+static uint16_t
+police_srtcm_packet_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data, void *ctx)
+{
+	return port_ability_apply_meter(pkts, nb_pkts, data, ctx,
+			police_srtcm_color);
+}
+
+/* Police packets with two rate three color marker. */
+static uint16_t
+police_trtcm_packet_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data, void *ctx)
+{
+	return port_ability_apply_meter(pkts, nb_pkts, data, ctx,
+			police_trtcm_color);
+}
+
+/* Police packets with token bucket. */
+static uint16_t
+police_tb_packet_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data, void *ctx)
+{
+	return port_ability_apply_meter(pkts, nb_pkts, data, ctx,
+			police_tb_color);
+}
+
+/**
+ * Make a copy of first bytes of packet.
+ *
+ * The copy is a single segment, so that it is truncated to the room of
+ * an mbuf of `pool` even if `snaplen` is larger.
+ */
+static inline struct rte_mbuf *
+sample_copy_packet(struct rte_mbuf *pkt, struct rte_mempool *pool,
+		uint32_t snaplen)
+{
+	struct rte_mbuf *copy = NULL;
+	const void *src = NULL;
+	char *dst = NULL;
+	uint32_t len = RTE_MIN(snaplen, rte_pktmbuf_pkt_len(pkt));
+
+	copy = rte_pktmbuf_alloc(pool);
+	if (unlikely(copy == NULL))
+		return NULL;
+
+	len = RTE_MIN(len, (uint32_t)rte_pktmbuf_tailroom(copy));
+	dst = rte_pktmbuf_append(copy, len);
+	src = rte_pktmbuf_read(pkt, 0, len, dst);
+	if (src != dst)
+		rte_memcpy(dst, src, len);
+	copy->port = pkt->port;
+	return copy;
+}
+
+/**
+ * Send sampled packet to ring.
+ *
+ * The packet is always passed to the next function. Checking the ring
+ * before touching the packet makes the cost almost nothing if the ring
+ * is full.
+ */
+static inline int
+sample_packet(
+		struct rte_mbuf *pkt,
+		const union spp_ability_data *data,
+		void *ctx)
+{
+	struct port_ability_sample *sample = ctx;
+	struct rte_mbuf *out = NULL;
+	uint32_t snaplen = data->sample.snaplen;
+	uint64_t x;
+
+	if (data->sample.mode == SPP_SAMPLE_MODE_EVERY) {
+		if (likely(--sample->countdown != 0))
+			return SPP_RET_OK;
+		sample->countdown = data->sample.rate;
+	} else {
+		/* xorshift64 */
+		x = sample->rand_state;
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		sample->rand_state = x;
+		if (likely(x % data->sample.rate != 0))
+			return SPP_RET_OK;
+	}
+
+	if (unlikely(rte_ring_full(sample->ring))) {
+		__atomic_fetch_add(&sample->stats->dropped, 1,
+				__ATOMIC_RELAXED);
+		return SPP_RET_OK;
+	}
+
+	/* Whole of packet is copied if snaplen is zero. */
+	if (snaplen == 0)
+		snaplen = UINT32_MAX;
+	out = sample_copy_packet(pkt, sample->pool, snaplen);
+	if (unlikely(out == NULL)) {
+		__atomic_fetch_add(&sample->stats->dropped, 1,
+				__ATOMIC_RELAXED);
+		return SPP_RET_OK;
+	}
+
+	if (unlikely(rte_ring_enqueue(sample->ring, out) != 0)) {
+		rte_pktmbuf_free(out);
+		__atomic_fetch_add(&sample->stats->dropped, 1,
+				__ATOMIC_RELAXED);
+		return SPP_RET_OK;
+	}
+
+	__atomic_fetch_add(&sample->stats->sampled, 1, __ATOMIC_RELAXED);
+	return SPP_RET_OK;
+}
+
+/**
+ * Apply function of port ability to each of packets.
+ *
+ * It is inlined into a burst function of each port ability, so that `op`
+ * is called directly in the loop. Passed packets keep their order.
+ */
+static __rte_always_inline uint16_t
+port_ability_apply(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data, void *ctx,
+		port_ability_pkt_func op)
+{
+	uint16_t cnt;
+	uint16_t ok_pkts = 0;
+	struct rte_mbuf *pkt = NULL;
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		pkt = pkts[cnt];
+		if (unlikely((*op)(pkt, data, ctx) < 0))
+			continue;
+
+		pkts[cnt] = pkts[ok_pkts];
+		pkts[ok_pkts++] = pkt;
+	}
+	return ok_pkts;
+}
+
+/* Define burst function `name`_burst() from function for a packet. */
+#define PORT_ABILITY_BURST_FUNC(name)					\
+static uint16_t								\
+name##_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,			\
+		const union spp_ability_data *data, void *ctx)		\
+{									\
+	return port_ability_apply(pkts, nb_pkts, data, ctx, name);	\
+}
+
+PORT_ABILITY_BURST_FUNC(add_qinq_packet)
+PORT_ABILITY_BURST_FUNC(del_qinq_packet)
+PORT_ABILITY_BURST_FUNC(add_vlantag_packet_offload)
+PORT_ABILITY_BURST_FUNC(del_vlantag_packet_offload)
+PORT_ABILITY_BURST_FUNC(set_src_mac_packet)
+PORT_ABILITY_BURST_FUNC(set_dst_mac_packet)
+PORT_ABILITY_BURST_FUNC(dec_ttl_packet)
+PORT_ABILITY_BURST_FUNC(set_dscp_packet)
+PORT_ABILITY_BURST_FUNC(sample_packet)
+
+/*
+ * Burst kernels of VLAN operation.
+ *
+ * Pushing or popping a VLAN tag is a shift of 12 bytes of MAC addresses
+ * and a write of 4 bytes, so first 16 bytes of a frame are handled with
+ * a vector register. A kernel processes a fixed number of packets, and
+ * returns SPP_RET_NG without touching any of them if one of packets
+ * cannot be handled in the fast path. Such packets are processed by
+ * functions of the chain instead.
+ */
+#ifdef RTE_ARCH_X86
+
+/* Check if VLAN tag can be added to packet in burst kernel. */
+static inline int
+add_vlantag_burst_check(struct rte_mbuf *pkt)
+{
+	const struct ether_hdr *ether =
+			rte_pktmbuf_mtod(pkt, const struct ether_hdr *);
+
+	return rte_pktmbuf_headroom(pkt) >= sizeof(struct vlan_hdr) &&
+			pkt->data_len >= SPP_VLAN_BURST_HDR_LEN &&
+			ether->ether_type != g_vlan_tpid;
+}
+
+/* Check if VLAN tag can be deleted from packet in burst kernel. */
+static inline int
+del_vlantag_burst_check(struct rte_mbuf *pkt)
+{
+	const struct ether_hdr *ether =
+			rte_pktmbuf_mtod(pkt, const struct ether_hdr *);
+
+	return pkt->data_len >= SPP_VLAN_BURST_HDR_LEN +
+			sizeof(struct vlan_hdr) &&
+			ether->ether_type == g_vlan_tpid;
+}
+
+/* Make TPID and TCI placed on 4 bytes from offset 12 of a frame. */
+static inline uint32_t
+vlan_burst_tag(uint16_t tci)
+{
+	/* Both of values are already in network order. */
+	return (uint32_t)g_vlan_tpid | ((uint32_t)tci << 16);
+}
+
+/* Update length of packet after its header is moved by `diff` bytes. */
+static inline void
+vlan_burst_adjust(struct rte_mbuf *pkt, int diff)
+{
+	pkt->data_off -= diff;
+	pkt->data_len += diff;
+	pkt->pkt_len  += diff;
+}
+
+/* Add VLAN tag to SPP_VLAN_BURST_SSE_NUM packets with SSE4.1. */
+static __attribute__ ((target("sse4.1"))) int
+add_vlantag_burst_sse(
+		struct rte_mbuf **pkts,
+		const union spp_ability_data *data)
+{
+	int cnt;
+	uint8_t *hdr;
+	__m128i val;
+	uint32_t tag = vlan_burst_tag(data->vlantag.tci);
+
+	for (cnt = 0; cnt < SPP_VLAN_BURST_SSE_NUM; cnt++) {
+		if (unlikely(!add_vlantag_burst_check(pkts[cnt])))
+			return SPP_RET_NG;
+	}
 
-/* Port ability port information */
-struct port_ability_port_mng_info {
-	/* Interface type (phy/vhost/ring) */
-	enum port_type iface_type;
+	for (cnt = 0; cnt < SPP_VLAN_BURST_SSE_NUM; cnt++) {
+		hdr = rte_pktmbuf_mtod(pkts[cnt], uint8_t *);
+		val = _mm_loadu_si128((const __m128i *)hdr);
+		val = _mm_insert_epi32(val, (int)tag, 3);
+		_mm_storeu_si128((__m128i *)(hdr - sizeof(struct vlan_hdr)),
+				val);
+		vlan_burst_adjust(pkts[cnt], sizeof(struct vlan_hdr));
+	}
+	return SPP_RET_OK;
+}
 
-	/* Interface number */
-	int            iface_no;
+/* Delete VLAN tag from SPP_VLAN_BURST_SSE_NUM packets with SSE4.1. */
+static __attribute__ ((target("sse4.1"))) int
+del_vlantag_burst_sse(
+		struct rte_mbuf **pkts,
+		const union spp_ability_data *data __attribute__ ((unused)))
+{
+	int cnt;
+	uint8_t *hdr;
+	__m128i mac, ether_type;
 
-	/* Management data of port ability for receiving */
-	struct port_ability_mng_info rx;
+	for (cnt = 0; cnt < SPP_VLAN_BURST_SSE_NUM; cnt++) {
+		if (unlikely(!del_vlantag_burst_check(pkts[cnt])))
+			return SPP_RET_NG;
+	}
 
-	/* Management data of port ability for sending */
-	struct port_ability_mng_info tx;
-};
+	for (cnt = 0; cnt < SPP_VLAN_BURST_SSE_NUM; cnt++) {
+		hdr = rte_pktmbuf_mtod(pkts[cnt], uint8_t *);
+		mac = _mm_loadu_si128((const __m128i *)hdr);
+		ether_type = _mm_loadu_si128((const __m128i *)
+				(hdr + sizeof(struct vlan_hdr)));
+		/* Keep inner ether type and following 2 bytes. */
+		mac = _mm_blend_epi16(mac, ether_type, 0xc0);
+		_mm_storeu_si128((__m128i *)(hdr + sizeof(struct vlan_hdr)),
+				mac);
+		vlan_burst_adjust(pkts[cnt], -(int)sizeof(struct vlan_hdr));
+	}
+	return SPP_RET_OK;
+}
 
-/* Information for VLAN tag management. */
-struct port_ability_port_mng_info g_port_mng_info[RTE_MAX_ETHPORTS];
+/* Add VLAN tag to SPP_VLAN_BURST_AVX2_NUM packets with AVX2. */
+static __attribute__ ((target("avx2"))) int
+add_vlantag_burst_avx2(
+		struct rte_mbuf **pkts,
+		const union spp_ability_data *data)
+{
+	int cnt;
+	uint8_t *hdr0, *hdr1;
+	__m256i val;
+	const __m256i tag = _mm256_set1_epi32(
+			(int)vlan_burst_tag(data->vlantag.tci));
 
-/* TPID of VLAN. */
-static uint16_t g_vlan_tpid;
+	for (cnt = 0; cnt < SPP_VLAN_BURST_AVX2_NUM; cnt++) {
+		if (unlikely(!add_vlantag_burst_check(pkts[cnt])))
+			return SPP_RET_NG;
+	}
 
-/* Initialize port ability. */
-void
-spp_port_ability_init(void)
+	/* Headers of two packets are handled with a register. */
+	for (cnt = 0; cnt < SPP_VLAN_BURST_AVX2_NUM; cnt += 2) {
+		hdr0 = rte_pktmbuf_mtod(pkts[cnt], uint8_t *);
+		hdr1 = rte_pktmbuf_mtod(pkts[cnt + 1], uint8_t *);
+		val = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128((const __m128i *)hdr0)),
+				_mm_loadu_si128((const __m128i *)hdr1), 1);
+		val = _mm256_blend_epi32(val, tag, 0x88);
+		_mm_storeu_si128((__m128i *)(hdr0 - sizeof(struct vlan_hdr)),
+				_mm256_castsi256_si128(val));
+		_mm_storeu_si128((__m128i *)(hdr1 - sizeof(struct vlan_hdr)),
+				_mm256_extracti128_si256(val, 1));
+		vlan_burst_adjust(pkts[cnt], sizeof(struct vlan_hdr));
+		vlan_burst_adjust(pkts[cnt + 1], sizeof(struct vlan_hdr));
+	}
+	return SPP_RET_OK;
+}
+
+/* Delete VLAN tag from SPP_VLAN_BURST_AVX2_NUM packets with AVX2. */
+static __attribute__ ((target("avx2"))) int
+del_vlantag_burst_avx2(
+		struct rte_mbuf **pkts,
+		const union spp_ability_data *data __attribute__ ((unused)))
 {
-	int cnt = 0;
-	g_vlan_tpid = rte_cpu_to_be_16(ETHER_TYPE_VLAN);
-	memset(g_port_mng_info, 0x00, sizeof(g_port_mng_info));
-	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		g_port_mng_info[cnt].rx.ref_index = 0;
-		g_port_mng_info[cnt].rx.upd_index = 1;
-		g_port_mng_info[cnt].tx.ref_index = 0;
-		g_port_mng_info[cnt].tx.upd_index = 1;
+	int cnt;
+	uint8_t *hdr0, *hdr1;
+	__m256i mac, ether_type;
+
+	for (cnt = 0; cnt < SPP_VLAN_BURST_AVX2_NUM; cnt++) {
+		if (unlikely(!del_vlantag_burst_check(pkts[cnt])))
+			return SPP_RET_NG;
+	}
+
+	/* Headers of two packets are handled with a register. */
+	for (cnt = 0; cnt < SPP_VLAN_BURST_AVX2_NUM; cnt += 2) {
+		hdr0 = rte_pktmbuf_mtod(pkts[cnt], uint8_t *);
+		hdr1 = rte_pktmbuf_mtod(pkts[cnt + 1], uint8_t *);
+		mac = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128((const __m128i *)hdr0)),
+				_mm_loadu_si128((const __m128i *)hdr1), 1);
+		ether_type = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128((const __m128i *)
+				(hdr0 + sizeof(struct vlan_hdr)))),
+				_mm_loadu_si128((const __m128i *)
+				(hdr1 + sizeof(struct vlan_hdr))), 1);
+		/* Keep inner ether type and following 2 bytes. */
+		mac = _mm256_blend_epi32(mac, ether_type, 0x88);
+		_mm_storeu_si128((__m128i *)(hdr0 + sizeof(struct vlan_hdr)),
+				_mm256_castsi256_si128(mac));
+		_mm_storeu_si128((__m128i *)(hdr1 + sizeof(struct vlan_hdr)),
+				_mm256_extracti128_si256(mac, 1));
+		vlan_burst_adjust(pkts[cnt], -(int)sizeof(struct vlan_hdr));
+		vlan_burst_adjust(pkts[cnt + 1],
+				-(int)sizeof(struct vlan_hdr));
 	}
+	return SPP_RET_OK;
 }
 
-/* Get information of port ability. */
-void
-spp_port_ability_get_info(
-		int port_id, enum spp_port_rxtx rxtx,
-		struct spp_port_ability **info)
+#endif /* RTE_ARCH_X86 */
+
+/* Select burst kernels of VLAN operation supported by the CPU. */
+static void
+port_ability_select_burst(void)
+{
+	g_add_vlantag_burst.func = NULL;
+	g_del_vlantag_burst.func = NULL;
+#ifdef RTE_ARCH_X86
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0) {
+		g_add_vlantag_burst.func = add_vlantag_burst_avx2;
+		g_add_vlantag_burst.num  = SPP_VLAN_BURST_AVX2_NUM;
+		g_del_vlantag_burst.func = del_vlantag_burst_avx2;
+		g_del_vlantag_burst.num  = SPP_VLAN_BURST_AVX2_NUM;
+		RTE_LOG(INFO, PORT, "VLAN burst kernel is AVX2.\n");
+		return;
+	}
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1) > 0) {
+		g_add_vlantag_burst.func = add_vlantag_burst_sse;
+		g_add_vlantag_burst.num  = SPP_VLAN_BURST_SSE_NUM;
+		g_del_vlantag_burst.func = del_vlantag_burst_sse;
+		g_del_vlantag_burst.num  = SPP_VLAN_BURST_SSE_NUM;
+		RTE_LOG(INFO, PORT, "VLAN burst kernel is SSE4.1.\n");
+		return;
+	}
+#endif /* RTE_ARCH_X86 */
+	RTE_LOG(INFO, PORT, "VLAN burst kernel is not used.\n");
+}
+
+/**
+ * Apply VLAN operation to each of packets with burst kernel.
+ *
+ * The kernel is tried for each group of packets first, and the group
+ * falls back to `op` one by one if it fails.
+ */
+static __rte_always_inline uint16_t
+port_ability_apply_kernel(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data, void *ctx,
+		const struct port_ability_burst *kernel,
+		port_ability_pkt_func op)
+{
+	int num;
+	uint16_t cnt, pre;
+	uint16_t ok_pkts = 0;
+	struct rte_mbuf *pkt = NULL;
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (kernel->func != NULL && cnt + kernel->num <= nb_pkts) {
+			for (pre = cnt + kernel->num;
+					pre < cnt + kernel->num * 2 &&
+					pre < nb_pkts; pre++)
+				rte_prefetch0(rte_pktmbuf_mtod(pkts[pre],
+						void *));
+
+			if (likely((*kernel->func)(&pkts[cnt], data) ==
+					SPP_RET_OK)) {
+				for (num = 0; num < kernel->num; num++) {
+					pkt = pkts[cnt + num];
+					pkts[cnt + num] = pkts[ok_pkts];
+					pkts[ok_pkts++] = pkt;
+				}
+				cnt += kernel->num - 1;
+				continue;
+			}
+		}
+
+		pkt = pkts[cnt];
+		if (unlikely((*op)(pkt, data, ctx) < 0))
+			continue;
+
+		pkts[cnt] = pkts[ok_pkts];
+		pkts[ok_pkts++] = pkt;
+	}
+	return ok_pkts;
+}
+
+/* Add VLAN tag to packets in software. */
+static uint16_t
+add_vlantag_packet_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data, void *ctx)
+{
+	return port_ability_apply_kernel(pkts, nb_pkts, data, ctx,
+			&g_add_vlantag_burst, add_vlantag_packet);
+}
+
+/* Delete VLAN tag from packets in software. */
+static uint16_t
+del_vlantag_packet_burst(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const union spp_ability_data *data, void *ctx)
+{
+	return port_ability_apply_kernel(pkts, nb_pkts, data, ctx,
+			&g_del_vlantag_burst, del_vlantag_packet);
+}
+
+/**
+ * List of functions per port ability.
+ * do it same as the order of enum spp_port_ability_ope (spp_proc.h)
+ */
+static port_ability_func port_ability_function_list[] = {
+	NULL,                          /* None */
+	add_vlantag_packet_burst,      /* Add VLAN tag */
+	del_vlantag_packet_burst,      /* Del VLAN tag */
+	add_qinq_packet_burst,         /* Add QinQ tag */
+	del_qinq_packet_burst,         /* Del QinQ tag */
+	set_src_mac_packet_burst,      /* Set source MAC address */
+	set_dst_mac_packet_burst,      /* Set destination MAC address */
+	dec_ttl_packet_burst,          /* Decrement TTL */
+	set_dscp_packet_burst,         /* Set DSCP */
+	police_srtcm_packet_burst,     /* Police with srTCM */
+	police_trtcm_packet_burst,     /* Police with trTCM */
+	police_tb_packet_burst,        /* Police with token bucket */
+	sample_packet_burst,           /* Send sampled packets to ring */
+	NULL                           /* Termination */
+};
+
+/* Check VLAN offloads enabled on the port. */
+static void
+port_ability_check_vlan_offload(
+		struct port_ability_port_mng_info *port_mng, int port_id)
+{
+	int vlan_offload = 0;
+	struct rte_eth_dev_info dev_info;
+	const struct rte_eth_conf *conf =
+			&rte_eth_devices[port_id].data->dev_conf;
+
+	rte_eth_dev_info_get(port_id, &dev_info);
+	port_mng->tx_vlan_insert =
+		(dev_info.tx_offload_capa & DEV_TX_OFFLOAD_VLAN_INSERT) &&
+		(conf->txmode.offloads & DEV_TX_OFFLOAD_VLAN_INSERT);
+
+	vlan_offload = rte_eth_dev_get_vlan_offload(port_id);
+	port_mng->rx_vlan_strip = (vlan_offload > 0) &&
+			(vlan_offload & ETH_VLAN_STRIP_OFFLOAD);
+}
+
+/* Configure meter of port ability limiting rate. */
+static int
+port_ability_config_meter(struct port_ability_meter *meter,
+		const struct spp_port_ability *ability)
 {
-	struct port_ability_mng_info *mng = NULL;
+	int ret = -1;
+	const struct spp_meter_info *info = &ability->data.meter;
+	struct rte_meter_srtcm_params srtcm;
+	struct rte_meter_trtcm_params trtcm;
 
-	switch (rxtx) {
-	case SPP_PORT_RXTX_RX:
-		mng = &g_port_mng_info[port_id].rx;
+	switch (ability->ope) {
+	case SPP_PORT_ABILITY_OPE_POLICE_SRTCM:
+	case SPP_PORT_ABILITY_OPE_POLICE_TB:
+		srtcm.cir = info->cir;
+		srtcm.cbs = info->cbs;
+		srtcm.ebs = info->ebs;
+		if (ability->ope == SPP_PORT_ABILITY_OPE_POLICE_TB) {
+			/* Token bucket is srTCM without excess burst. */
+			if (info->unit == SPP_METER_UNIT_BPS)
+				srtcm.cir = info->cir / 8;
+			srtcm.ebs = 0;
+		}
+		ret = rte_meter_srtcm_profile_config(&meter->profile.srtcm,
+				&srtcm);
+		if (ret == 0)
+			ret = rte_meter_srtcm_config(&meter->m.srtcm,
+					&meter->profile.srtcm);
 		break;
-	case SPP_PORT_RXTX_TX:
-		mng = &g_port_mng_info[port_id].tx;
+	case SPP_PORT_ABILITY_OPE_POLICE_TRTCM:
+		trtcm.cir = info->cir;
+		trtcm.pir = info->pir;
+		trtcm.cbs = info->cbs;
+		trtcm.pbs = info->pbs;
+		ret = rte_meter_trtcm_profile_config(&meter->profile.trtcm,
+				&trtcm);
+		if (ret == 0)
+			ret = rte_meter_trtcm_config(&meter->m.trtcm,
+					&meter->profile.trtcm);
 		break;
 	default:
 		/* Not used. */
 		break;
 	}
-	*info = mng->ability[mng->ref_index];
-}
 
-/* Calculation and Setting of FCS. */
-static inline void
-set_fcs_packet(struct rte_mbuf *pkt)
-{
-	uint32_t *fcs = NULL;
-	fcs = rte_pktmbuf_mtod_offset(pkt, uint32_t *, pkt->data_len);
-	*fcs = rte_net_crc_calc(rte_pktmbuf_mtod(pkt, void *),
-			pkt->data_len, RTE_NET_CRC32_ETH);
+	if (unlikely(ret != 0))
+		return SPP_RET_NG;
+	return SPP_RET_OK;
 }
 
-/* Add VLAN tag to packet. */
-static inline int
-add_vlantag_packet(
-		struct rte_mbuf *pkt,
-		const union spp_ability_data *data)
+/* Configure sampling port ability. */
+static int
+port_ability_config_sample(struct port_ability_sample *sample,
+		const struct spp_port_ability *ability)
 {
-	struct ether_hdr *old_ether = NULL;
-	struct ether_hdr *new_ether = NULL;
-	struct vlan_hdr  *vlan      = NULL;
-	const struct spp_vlantag_info *vlantag = &data->vlantag;
+	const struct spp_sample_info *info = &ability->data.sample;
 
-	old_ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
-	if (old_ether->ether_type == g_vlan_tpid) {
-		/* For packets with VLAN tags, only VLAN ID is updated */
-		new_ether = old_ether;
-		vlan = (struct vlan_hdr *)&new_ether[1];
-	} else {
-		/* For packets without VLAN tag, add VLAN tag. */
-		new_ether = (struct ether_hdr *)rte_pktmbuf_prepend(pkt,
-				sizeof(struct vlan_hdr));
-		if (unlikely(new_ether == NULL)) {
-			RTE_LOG(ERR, PORT, "Failed to "
-					"get additional header area.\n");
-			return SPP_RET_NG;
-		}
+	sample->ring = rte_ring_lookup(get_rx_queue_name(
+			info->ring.iface_no));
+	if (unlikely(sample->ring == NULL)) {
+		RTE_LOG(ERR, PORT, "Cannot find ring for sampling. "
+				"(ring = %d)\n", info->ring.iface_no);
+		return SPP_RET_NG;
+	}
 
-		rte_memcpy(new_ether, old_ether, sizeof(struct ether_hdr));
-		vlan = (struct vlan_hdr *)&new_ether[1];
-		vlan->eth_proto = new_ether->ether_type;
-		new_ether->ether_type = g_vlan_tpid;
+	/*
+	 * Sampled packet is always copied, because it can be modified or
+	 * released by the following abilities and the device.
+	 */
+	sample->pool = rte_mempool_lookup(PKTMBUF_POOL_NAME);
+	if (unlikely(sample->pool == NULL)) {
+		RTE_LOG(ERR, PORT, "Cannot find mempool for sampling. "
+				"(name = %s)\n", PKTMBUF_POOL_NAME);
+		return SPP_RET_NG;
 	}
 
-	vlan->vlan_tci = vlantag->tci;
-	set_fcs_packet(pkt);
+	sample->countdown = info->rate;
+	sample->rand_state = rte_rdtsc() | 1;
 	return SPP_RET_OK;
 }
 
-/* Add VLAN tag to all packets. */
+/* Check if parameters of meters are the same. */
 static inline int
-add_vlantag_all_packets(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union spp_ability_data *data)
+is_same_meter(const struct spp_meter_info *a, const struct spp_meter_info *b)
 {
-	int ret = SPP_RET_OK;
-	int cnt = 0;
-	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = add_vlantag_packet(pkts[cnt], data);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to add VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
-			break;
-		}
+	return a->unit == b->unit && a->cir == b->cir && a->pir == b->pir &&
+			a->cbs == b->cbs && a->ebs == b->ebs &&
+			a->pbs == b->pbs;
+}
+
+/*
+ * Find the meter of the same operation and parameters in the current
+ * table, or return NULL if it is newly added or changed.
+ */
+static const struct port_ability_meter *
+port_ability_find_cur_meter(const struct port_ability_mng_info *mng,
+		const struct spp_port_ability *ability)
+{
+	int cnt;
+	const struct port_ability_table *cur = mng->cur;
+
+	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		if (cur->ability[cnt].ope == ability->ope &&
+				is_same_meter(&cur->ability[cnt].data.meter,
+				&ability->data.meter))
+			return &cur->context[cnt].meter;
 	}
-	return cnt;
+	return NULL;
 }
 
-/* Delete VLAN tag to packet. */
+/* Check if parameters of sampling are the same. */
 static inline int
-del_vlantag_packet(
-		struct rte_mbuf *pkt,
-		const union spp_ability_data *data __attribute__ ((unused)))
+is_same_sample(const struct spp_sample_info *a,
+		const struct spp_sample_info *b)
 {
-	struct ether_hdr *old_ether = NULL;
-	struct ether_hdr *new_ether = NULL;
-	uint32_t *old, *new;
+	return a->ring.iface_no == b->ring.iface_no && a->mode == b->mode &&
+			a->rate == b->rate && a->snaplen == b->snaplen;
+}
 
-	old_ether = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
-	if (old_ether->ether_type == g_vlan_tpid) {
-		/* For packets without VLAN tag, delete VLAN tag. */
-		new_ether = (struct ether_hdr *)rte_pktmbuf_adj(pkt,
-				sizeof(struct vlan_hdr));
-		if (unlikely(new_ether == NULL)) {
-			RTE_LOG(ERR, PORT, "Failed to "
-					"delete unnecessary header area.\n");
-			return SPP_RET_NG;
-		}
+/*
+ * Find the sampling of the same parameters in the current table, or
+ * return NULL if it is newly added or changed.
+ */
+static const struct port_ability_sample *
+port_ability_find_cur_sample(const struct port_ability_mng_info *mng,
+		const struct spp_port_ability *ability)
+{
+	int cnt;
+	const struct port_ability_table *cur = mng->cur;
 
-		old = (uint32_t *)old_ether;
-		new = (uint32_t *)new_ether;
-		new[2] = old[2];
-		new[1] = old[1];
-		new[0] = old[0];
-		old[0] = 0;
-		set_fcs_packet(pkt);
+	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		if (cur->ability[cnt].ope == SPP_PORT_ABILITY_OPE_SAMPLE &&
+				is_same_sample(&cur->ability[cnt].data.sample,
+				&ability->data.sample))
+			return &cur->context[cnt].sample;
 	}
-	return SPP_RET_OK;
+	return NULL;
 }
 
-/* Delete VLAN tag to all packets. */
-static inline int
-del_vlantag_all_packets(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union spp_ability_data *data)
+/**
+ * Compile port abilities into a chain of functions.
+ *
+ * VLAN offloads are used only if no QinQ operation is in the abilities,
+ * because the device handles the tag in the innermost position. Run-time
+ * data of a meter which is not changed is taken over from the current
+ * table, so that its tokens are not refilled by updating other abilities.
+ * Countdown and random state of sampling are taken over as well.
+ * Return SPP_RET_NG if any of abilities cannot be configured.
+ */
+static int
+port_ability_compile_chain(
+		const struct port_ability_port_mng_info *port_mng,
+		struct port_ability_mng_info *mng,
+		struct port_ability_table *table,
+		enum spp_port_rxtx rxtx)
 {
-	int ret = SPP_RET_OK;
-	int cnt = 0;
-	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = del_vlantag_packet(pkts[cnt], data);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to del VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
+	int cnt;
+	int use_offload = 1;
+	const struct spp_port_ability *ability = table->ability;
+	struct port_ability_chain *chain = &table->chain;
+	struct port_ability_meter *meter = NULL;
+	const struct port_ability_meter *cur_meter = NULL;
+	struct port_ability_sample *sample = NULL;
+	const struct port_ability_sample *cur_sample = NULL;
+
+	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		if (ability[cnt].ope == SPP_PORT_ABILITY_OPE_ADD_QINQ ||
+				ability[cnt].ope ==
+				SPP_PORT_ABILITY_OPE_DEL_QINQ)
+			use_offload = 0;
+	}
+
+	memset(chain, 0x00, sizeof(struct port_ability_chain));
+	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		if (ability[cnt].ope == SPP_PORT_ABILITY_OPE_NONE)
 			break;
+
+		if (SPP_PORT_ABILITY_IS_METER(ability[cnt].ope)) {
+			meter = &table->context[cnt].meter;
+			meter->stats = &mng->meter_stats[ability[cnt].ope -
+					SPP_PORT_ABILITY_OPE_POLICE_SRTCM];
+			if (unlikely(port_ability_config_meter(meter,
+					&ability[cnt]) != SPP_RET_OK)) {
+				RTE_LOG(ERR, PORT, "Failed to configure "
+						"meter. (ope = %d)\n",
+						ability[cnt].ope);
+				return SPP_RET_NG;
+			}
+			cur_meter = port_ability_find_cur_meter(mng,
+					&ability[cnt]);
+			if (cur_meter != NULL)
+				memcpy(&meter->m, &cur_meter->m,
+						sizeof(meter->m));
+			chain->ctx[chain->num] = meter;
+		}
+		if (ability[cnt].ope == SPP_PORT_ABILITY_OPE_SAMPLE) {
+			sample = &table->context[cnt].sample;
+			sample->stats = &mng->sample_stats;
+			if (unlikely(port_ability_config_sample(sample,
+					&ability[cnt]) != SPP_RET_OK))
+				return SPP_RET_NG;
+			cur_sample = port_ability_find_cur_sample(mng,
+					&ability[cnt]);
+			if (cur_sample != NULL) {
+				sample->countdown = cur_sample->countdown;
+				sample->rand_state = cur_sample->rand_state;
+			}
+			chain->ctx[chain->num] = sample;
 		}
+
+		chain->func[chain->num] = port_ability_function_list[
+				ability[cnt].ope];
+		if (use_offload && rxtx == SPP_PORT_RXTX_TX &&
+				port_mng->tx_vlan_insert &&
+				ability[cnt].ope ==
+				SPP_PORT_ABILITY_OPE_ADD_VLANTAG)
+			chain->func[chain->num] =
+					add_vlantag_packet_offload_burst;
+		if (use_offload && rxtx == SPP_PORT_RXTX_RX &&
+				port_mng->rx_vlan_strip &&
+				ability[cnt].ope ==
+				SPP_PORT_ABILITY_OPE_DEL_VLANTAG)
+			chain->func[chain->num] =
+					del_vlantag_packet_offload_burst;
+
+		chain->data[chain->num] = &ability[cnt].data;
+		chain->num++;
 	}
-	return cnt;
+	return SPP_RET_OK;
 }
 
-/* Change index of management information. */
-void
-spp_port_ability_change_index(
-		enum port_ability_chg_index_type type,
-		int port_id, enum spp_port_rxtx rxtx)
+/* Reset counters of sampling if it is newly added or changed. */
+static void
+port_ability_reset_sample_stats(struct port_ability_mng_info *mng,
+		const struct spp_port_ability *ability)
 {
 	int cnt;
-	static int num_rx;
-	static int rx_list[RTE_MAX_ETHPORTS];
-	static int num_tx;
-	static int tx_list[RTE_MAX_ETHPORTS];
-	struct port_ability_mng_info *mng = NULL;
-
-	if (type == PORT_ABILITY_CHG_INDEX_UPD) {
-		switch (rxtx) {
-		case SPP_PORT_RXTX_RX:
-			mng = &g_port_mng_info[port_id].rx;
-			mng->upd_index = mng->ref_index;
-			rx_list[num_rx++] = port_id;
-			break;
-		case SPP_PORT_RXTX_TX:
-			mng = &g_port_mng_info[port_id].tx;
-			mng->upd_index = mng->ref_index;
-			tx_list[num_tx++] = port_id;
-			break;
-		default:
-			/* Not used. */
-			break;
-		}
-		return;
-	}
+	const struct spp_port_ability *cur = mng->cur->ability;
 
-	for (cnt = 0; cnt < num_rx; cnt++) {
-		mng = &g_port_mng_info[rx_list[cnt]].rx;
-		mng->ref_index = (mng->upd_index+1)%SPP_INFO_AREA_MAX;
-		rx_list[cnt] = 0;
-	}
-	for (cnt = 0; cnt < num_tx; cnt++) {
-		mng = &g_port_mng_info[tx_list[cnt]].tx;
-		mng->ref_index = (mng->upd_index+1)%SPP_INFO_AREA_MAX;
-		tx_list[cnt] = 0;
+	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		if (cur[cnt].ope != SPP_PORT_ABILITY_OPE_SAMPLE)
+			continue;
+
+		if (is_same_sample(&cur[cnt].data.sample,
+				&ability->data.sample))
+			return;
+		break;
 	}
 
-	num_rx = 0;
-	num_tx = 0;
+	memset(&mng->sample_stats, 0x00,
+			sizeof(struct spp_port_sample_stats));
 }
 
-/* Set ability data of port ability. */
+/*
+ * Reset counters of abilities which are newly added or changed, and keep
+ * others as it is.
+ */
 static void
+port_ability_reset_stats(struct port_ability_mng_info *mng,
+		const struct spp_port_ability *ability)
+{
+	int cnt, cur_cnt;
+	const struct spp_port_ability *cur = mng->cur->ability;
+
+	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
+		if (ability[cnt].ope == SPP_PORT_ABILITY_OPE_SAMPLE) {
+			port_ability_reset_sample_stats(mng, &ability[cnt]);
+			continue;
+		}
+		if (!SPP_PORT_ABILITY_IS_METER(ability[cnt].ope))
+			continue;
+
+		for (cur_cnt = 0; cur_cnt < SPP_PORT_ABILITY_MAX; cur_cnt++) {
+			if (cur[cur_cnt].ope == ability[cnt].ope)
+				break;
+		}
+		if (cur_cnt < SPP_PORT_ABILITY_MAX &&
+				is_same_meter(&cur[cur_cnt].data.meter,
+				&ability[cnt].data.meter))
+			continue;
+
+		memset(&mng->meter_stats[ability[cnt].ope -
+				SPP_PORT_ABILITY_OPE_POLICE_SRTCM], 0x00,
+				sizeof(struct spp_port_meter_stats));
+	}
+}
+
+/**
+ * Set ability data of port ability.
+ *
+ * The new table is not published if it cannot be compiled, and workers
+ * keep using the current one.
+ */
+static int
 port_ability_set_ability(
 		struct spp_port_info *port,
 		enum spp_port_rxtx rxtx)
@@ -255,26 +1581,22 @@ port_ability_set_ability(
 	struct port_ability_port_mng_info *port_mng =
 						&g_port_mng_info[port_id];
 	struct port_ability_mng_info *mng         = NULL;
+	struct port_ability_table    *next        = NULL;
 	struct spp_port_ability      *in_ability  = port->ability;
 	struct spp_port_ability      *out_ability = NULL;
 	struct spp_vlantag_info      *tag         = NULL;
 
 	port_mng->iface_type = port->iface_type;
 	port_mng->iface_no   = port->iface_no;
+	port_ability_check_vlan_offload(port_mng, port_id);
 
-	switch (rxtx) {
-	case SPP_PORT_RXTX_RX:
-		mng = &port_mng->rx;
-		break;
-	case SPP_PORT_RXTX_TX:
-		mng = &port_mng->tx;
-		break;
-	default:
-		/* Not used. */
-		break;
-	}
+	mng = port_ability_get_mng_info(port_id, rxtx);
+	if (mng->cur == &mng->table[0])
+		next = &mng->table[1];
+	else
+		next = &mng->table[0];
 
-	out_ability = mng->ability[mng->upd_index];
+	out_ability = next->ability;
 	memset(out_ability, 0x00, sizeof(struct spp_port_ability)
 			* SPP_PORT_ABILITY_MAX);
 	for (in_cnt = 0; in_cnt < SPP_PORT_ABILITY_MAX; in_cnt++) {
@@ -286,6 +1608,7 @@ port_ability_set_ability(
 
 		switch (out_ability[out_cnt].ope) {
 		case SPP_PORT_ABILITY_OPE_ADD_VLANTAG:
+		case SPP_PORT_ABILITY_OPE_ADD_QINQ:
 			tag = &out_ability[out_cnt].data.vlantag;
 			tag->tci = rte_cpu_to_be_16(SPP_VLANTAG_CALC_TCI(
 					tag->vid, tag->pcp));
@@ -299,79 +1622,92 @@ port_ability_set_ability(
 		out_cnt++;
 	}
 
-	spp_port_ability_change_index(PORT_ABILITY_CHG_INDEX_UPD,
-			port_id, rxtx);
+	if (unlikely(port_ability_compile_chain(port_mng, mng, next,
+			rxtx) != SPP_RET_OK))
+		return SPP_RET_NG;
+
+	port_ability_reset_stats(mng, out_ability);
+	next->generation = ++mng->generation;
+
+	/*
+	 * Publish the new table. The old one is reused for the next
+	 * generation after the caller waits for a grace period.
+	 */
+	__atomic_store_n(&mng->cur, next, __ATOMIC_RELEASE);
+	return SPP_RET_OK;
 }
 
 /* Update port capability. */
-void
+int
 spp_port_ability_update(const struct spp_component_info *component)
 {
+	int ret = SPP_RET_OK;
 	int cnt;
 	struct spp_port_info *port = NULL;
-	for (cnt = 0; cnt < component->num_rx_port; cnt++) {
+	for (cnt = 0; cnt < component->num_rx_port && ret == SPP_RET_OK;
+			cnt++) {
 		port = component->rx_ports[cnt];
-		port_ability_set_ability(port, SPP_PORT_RXTX_RX);
+		ret = port_ability_set_ability(port, SPP_PORT_RXTX_RX);
 	}
 
-	for (cnt = 0; cnt < component->num_tx_port; cnt++) {
+	for (cnt = 0; cnt < component->num_tx_port && ret == SPP_RET_OK;
+			cnt++) {
 		port = component->tx_ports[cnt];
-		port_ability_set_ability(port, SPP_PORT_RXTX_TX);
+		ret = port_ability_set_ability(port, SPP_PORT_RXTX_TX);
 	}
-}
 
-/* Definition of functions that operate port abilities. */
-typedef int (*port_ability_func)(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union spp_ability_data *data);
-
-/* List of functions per port ability. */
-port_ability_func port_ability_function_list[] = {
-	NULL,                    /* None */
-	add_vlantag_all_packets, /* Add VLAN tag */
-	del_vlantag_all_packets, /* Del VLAN tag */
-	NULL                     /* Termination */
-};
+	/*
+	 * Wait until no worker refers the old tables of all ports, including
+	 * the ports updated before a failure.
+	 */
+	if (component->num_rx_port > 0 || component->num_tx_port > 0)
+		port_ability_synchronize();
+	return ret;
+}
 
-/* Each packet operation of port capability. */
+/**
+ * Each packet operation of port capability.
+ *
+ * Each of burst functions of the chain is applied to all of packets
+ * passed the previous one, so that functions are called once per burst.
+ * Packets failed in any of functions are moved to the end of `pkts` and
+ * the number of succeeded packets is returned. Failed packets are
+ * released for receiving, and left to the caller for sending as same as
+ * the packets which cannot be sent.
+ */
 static inline int
 port_ability_each_operation(uint16_t port_id,
 		struct rte_mbuf **pkts, const uint16_t nb_pkts,
 		enum spp_port_rxtx rxtx)
 {
-	int cnt, buf;
-	int ok_pkts = nb_pkts;
-	struct spp_port_ability *info = NULL;
+	int cnt;
+	uint16_t ok_pkts = nb_pkts;
+	const struct port_ability_chain *chain = NULL;
 
-	spp_port_ability_get_info(port_id, rxtx, &info);
-	if (unlikely(info[0].ope == SPP_PORT_ABILITY_OPE_NONE))
+	chain = &port_ability_get_table(
+			port_ability_get_mng_info(port_id, rxtx))->chain;
+	if (likely(chain->num == 0))
 		return nb_pkts;
 
-	for (cnt = 0; cnt < SPP_PORT_ABILITY_MAX; cnt++) {
-		if (info[cnt].ope == SPP_PORT_ABILITY_OPE_NONE)
-			break;
-
-		ok_pkts = port_ability_function_list[info[cnt].ope](
-				pkts, ok_pkts, &info->data);
-	}
+	for (cnt = 0; cnt < chain->num && ok_pkts > 0; cnt++)
+		ok_pkts = (*chain->func[cnt])(pkts, ok_pkts,
+				chain->data[cnt], chain->ctx[cnt]);
 
-	/* Discard remained packets to release mbuf. */
-	if (unlikely(ok_pkts < nb_pkts)) {
-		for (buf = ok_pkts; buf < nb_pkts; buf++)
-			rte_pktmbuf_free(pkts[buf]);
+	if (rxtx == SPP_PORT_RXTX_RX) {
+		for (cnt = ok_pkts; cnt < nb_pkts; cnt++)
+			rte_pktmbuf_free(pkts[cnt]);
 	}
-
 	return ok_pkts;
 }
 
 /* Wrapper function for rte_eth_rx_burst(). */
 uint16_t
 spp_eth_rx_burst(
-		uint16_t port_id, uint16_t queue_id  __attribute__ ((unused)),
+		uint16_t port_id, uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
 {
 	uint16_t nb_rx = 0;
-	nb_rx = rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
+	nb_rx = rte_eth_rx_burst(port_id, queue_id, rx_pkts, nb_pkts);
 	if (unlikely(nb_rx == 0))
 		return SPP_RET_OK;
 
@@ -386,24 +1722,37 @@ spp_eth_rx_burst(
 			SPP_PORT_RXTX_RX);
 }
 
-/* Wrapper function for rte_eth_tx_burst(). */
+/* Apply port abilities for sending to packets. */
 uint16_t
-spp_eth_tx_burst(
-		uint16_t port_id, uint16_t queue_id  __attribute__ ((unused)),
+spp_eth_tx_prepare(uint16_t port_id,
 		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 {
 	uint16_t nb_tx = 0;
 	nb_tx = port_ability_each_operation(port_id, tx_pkts, nb_pkts,
 			SPP_PORT_RXTX_TX);
 	if (unlikely(nb_tx == 0))
-		return SPP_RET_OK;
+		return 0;
 
 #ifdef SPP_RINGLATENCYSTATS_ENABLE
 	if (g_port_mng_info[port_id].iface_type == RING)
 		spp_ringlatencystats_add_time_stamp(
 				g_port_mng_info[port_id].iface_no,
-				tx_pkts, nb_pkts);
+				tx_pkts, nb_tx);
 #endif /* SPP_RINGLATENCYSTATS_ENABLE */
 
+	return nb_tx;
+}
+
+/* Wrapper function for rte_eth_tx_burst(). */
+uint16_t
+spp_eth_tx_burst(
+		uint16_t port_id, uint16_t queue_id  __attribute__ ((unused)),
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	uint16_t nb_tx = 0;
+	nb_tx = spp_eth_tx_prepare(port_id, tx_pkts, nb_pkts);
+	if (unlikely(nb_tx == 0))
+		return SPP_RET_OK;
+
 	return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_tx);
 }
@@ -17,17 +17,56 @@
 /** Calculate TCI of VLAN tag. */
 #define SPP_VLANTAG_CALC_TCI(id, pcp) (((pcp & 0x07) << 13) | (id & 0x0fff))
 
-/** Type for changing index. */
-enum port_ability_chg_index_type {
-	/** Type for changing index to reference area. */
-	PORT_ABILITY_CHG_INDEX_REF,
+/** Counters of port ability limiting rate */
+struct spp_port_meter_stats {
+	uint64_t conform; /**< Packets within committed rate */
+	uint64_t exceed;  /**< Packets over committed rate and passed */
+	uint64_t violate; /**< Packets dropped */
+};
 
-	/** Type for changing index to update area. */
-	PORT_ABILITY_CHG_INDEX_UPD,
+/** Counters of sampling port ability */
+struct spp_port_sample_stats {
+	uint64_t sampled; /**< Packets sent to the ring */
+	uint64_t dropped; /**< Sampled packets not sent for ring full */
 };
 
-/** Initialize port ability. */
-void spp_port_ability_init(void);
+/**
+ * Initialize port ability.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed.
+ */
+int spp_port_ability_init(void);
+
+/**
+ * Register lcore as a reader of port ability.
+ *
+ * Worker lcores calling spp_eth_rx_burst() or spp_eth_tx_burst() must be
+ * registered before, and report quiescent state periodically with
+ * spp_port_ability_quiescent(), or updating port ability does not finish.
+ *
+ * @param lcore_id
+ *  The lcore ID of the worker.
+ */
+void spp_port_ability_register_lcore(unsigned int lcore_id);
+
+/**
+ * Unregister lcore from readers of port ability.
+ *
+ * @param lcore_id
+ *  The lcore ID of the worker.
+ */
+void spp_port_ability_unregister_lcore(unsigned int lcore_id);
+
+/**
+ * Report quiescent state of lcore.
+ *
+ * It must be called where the lcore is not processing any packets.
+ *
+ * @param lcore_id
+ *  The lcore ID of the worker.
+ */
+void spp_port_ability_quiescent(unsigned int lcore_id);
 
 /**
  * Get information of port ability.
@@ -44,18 +83,39 @@ void spp_port_ability_get_info(
 		struct spp_port_ability **info);
 
 /**
- * Change index of management information.
+ * Get counters of port ability limiting rate.
+ *
+ * Counters are reset if parameters of the ability are changed.
+ *
+ * @param port_id
+ *  The port identifier of the Ethernet device.
+ * @param rxtx
+ *  rx/tx identifier of port_id.
+ * @param ope
+ *  Operation of port ability, one of police_srtcm, police_trtcm or police_tb.
+ * @param stats
+ *  Counters of the port ability.
+ */
+void spp_port_ability_get_meter_stats(
+		int port_id, enum spp_port_rxtx rxtx,
+		enum spp_port_ability_ope ope,
+		struct spp_port_meter_stats *stats);
+
+/**
+ * Get counters of sampling port ability.
+ *
+ * Counters are reset if parameters of the ability are changed.
  *
  * @param port_id
  *  The port identifier of the Ethernet device.
  * @param rxtx
  *  rx/tx identifier of port_id.
- * @param type
- *  Type for changing index.
+ * @param stats
+ *  Counters of the port ability.
  */
-void spp_port_ability_change_index(
-		enum port_ability_chg_index_type type,
-		int port_id, enum spp_port_rxtx rxtx);
+void spp_port_ability_get_sample_stats(
+		int port_id, enum spp_port_rxtx rxtx,
+		struct spp_port_sample_stats *stats);
 
 /**
  * Update port capability.
@@ -63,8 +123,11 @@ void spp_port_ability_change_index(
  * @param component_info
  *  The pointer to struct spp_component_info.@n
  *  The data for updating the internal data of port ability.
+ *
+ * @retval SPP_RET_OK succeeded.
+ * @retval SPP_RET_NG failed to configure any of port abilities.
  */
-void spp_port_ability_update(const struct spp_component_info *component);
+int spp_port_ability_update(const struct spp_component_info *component);
 
 /**
  * Wrapper function for rte_eth_rx_burst().
@@ -73,7 +136,7 @@ void spp_port_ability_update(const struct spp_component_info *component);
  *  The port identifier of the Ethernet device.
  * @param queue_id
  *  The index of the receive queue from which to retrieve input packets.
- *  SPP is fixed at 0.
+ *  spp_vf and spp_mirror always use 0.
  * @param rx_pkts
  *  The address of an array of pointers to *rte_mbuf* structures that
  *  must be large enough to store *nb_pkts* pointers in it.
@@ -88,6 +151,30 @@ void spp_port_ability_update(const struct spp_component_info *component);
 uint16_t spp_eth_rx_burst(uint16_t port_id, uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
 
+/**
+ * Apply port abilities for sending to packets.
+ *
+ * It is for packets which might be sent with rte_eth_tx_burst() more than
+ * once, so that abilities are applied only once for each of packets.
+ * spp_eth_tx_burst() is the same as this function followed by
+ * rte_eth_tx_burst().
+ *
+ * @param port_id
+ *  The port identifier of the Ethernet device.
+ * @param tx_pkts
+ *  The address of an array of *nb_pkts* pointers to *rte_mbuf* structures
+ *  which contain the output packets.
+ * @param nb_pkts
+ *  The number of packets.
+ *
+ * @return
+ *  The number of packets passed all of abilities, which are kept at the
+ *  beginning of *tx_pkts*. Failed packets are moved to the end and left
+ *  to the caller.
+ */
+uint16_t spp_eth_tx_prepare(uint16_t port_id,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
+
 /**
  * Wrapper function for rte_eth_tx_burst().
  *
@@ -118,6 +118,7 @@ spp_vf_add_vhost_pmd(int index, int client)
 	struct rte_eth_conf port_conf = {
 		.rxmode = { .max_rx_pkt_len = ETHER_MAX_LEN }
 	};
+	struct rte_eth_dev_info dev_info;
 	struct rte_mempool *mp;
 	uint16_t vhost_port_id;
 	int nr_queues = 1;
@@ -148,6 +149,11 @@ spp_vf_add_vhost_pmd(int index, int client)
 		return ret;
 	}
 
+	/* Tag is added by PMD if VLAN_INSERT is supported. */
+	rte_eth_dev_info_get(vhost_port_id, &dev_info);
+	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_VLAN_INSERT)
+		port_conf.txmode.offloads |= DEV_TX_OFFLOAD_VLAN_INSERT;
+
 	ret = rte_eth_dev_configure(vhost_port_id, nr_queues, nr_queues,
 		&port_conf);
 	if (unlikely(ret < 0)) {
@@ -697,6 +703,38 @@ spp_check_used_port(
 	return SPP_RET_NG;
 }
 
+/* Check if ring is a destination of sampling port ability. */
+int
+spp_check_sample_ring(int ring_no, const struct spp_port_index *port,
+		enum spp_port_rxtx rxtx)
+{
+	int cnt, ab_cnt;
+	struct iface_info *iface_info = g_mng_data_addr.p_iface_info;
+	struct spp_port_info *ports[] = {
+		iface_info->nic, iface_info->vhost, iface_info->ring };
+	const struct spp_port_info *info = NULL;
+	const struct spp_port_ability *ability = NULL;
+	const struct spp_port_info *self = NULL;
+
+	if (port != NULL)
+		self = get_iface_info(port->iface_type, port->iface_no);
+
+	for (cnt = 0; cnt < (int)RTE_DIM(ports) * RTE_MAX_ETHPORTS; cnt++) {
+		info = &ports[cnt / RTE_MAX_ETHPORTS][cnt % RTE_MAX_ETHPORTS];
+		for (ab_cnt = 0; ab_cnt < SPP_PORT_ABILITY_MAX; ab_cnt++) {
+			ability = &info->ability[ab_cnt];
+			if (ability->ope != SPP_PORT_ABILITY_OPE_SAMPLE ||
+					ability->data.sample.ring.iface_no !=
+					ring_no)
+				continue;
+			if (info == self && ability->rxtx == rxtx)
+				continue;
+			return SPP_RET_OK;
+		}
+	}
+	return SPP_RET_NG;
+}
+
 /* Set component update flag for given port */
 void
 set_component_change_port(struct spp_port_info *port, enum spp_port_rxtx rxtx)
@@ -884,6 +922,57 @@ flush_core(void)
 	}
 }
 
+/*
+ * Release components moved to another core from the source cores. Each
+ * source core is switched to its current list without moved components
+ * and waited for, then the list staged by commands is restored to be
+ * published by flush_core().
+ */
+void
+flush_moved_component(void)
+{
+	int cnt, idx;
+	struct core_info *ref_core, *upd_core;
+	struct core_info staged_core, released_core;
+	struct spp_component_info *component = NULL;
+	struct core_mng_info *info = NULL;
+	struct core_mng_info *p_core_info = g_mng_data_addr.p_core_info;
+	int *p_change_core = g_mng_data_addr.p_change_core;
+	struct spp_component_info *p_component_info =
+					g_mng_data_addr.p_component_info;
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		if (*(p_change_core + cnt) == 0)
+			continue;
+
+		info = (p_core_info + cnt);
+		ref_core = &info->core[info->ref_index];
+		released_core.num = 0;
+		for (idx = 0; idx < ref_core->num; idx++) {
+			component = (p_component_info + ref_core->id[idx]);
+			if (component->name[0] != '\0' &&
+					component->lcore_id != (unsigned)cnt)
+				continue;
+
+			released_core.id[released_core.num++] =
+					ref_core->id[idx];
+		}
+		if (released_core.num == ref_core->num)
+			continue;
+
+		upd_core = &info->core[info->upd_index];
+		memcpy(&staged_core, upd_core, sizeof(struct core_info));
+		memcpy(upd_core, &released_core, sizeof(struct core_info));
+
+		info->upd_index = info->ref_index;
+		while (likely(info->ref_index == info->upd_index))
+			rte_delay_us_block(SPP_CHANGE_UPDATE_INTERVAL);
+
+		memcpy(&info->core[info->upd_index], &staged_core,
+				sizeof(struct core_info));
+	}
+}
+
 /* Flush change for forwarder or classifier_mac */
 int
 flush_component(void)
@@ -900,7 +989,14 @@ flush_component(void)
 			continue;
 
 		component_info = (p_component_info + cnt);
-		spp_port_ability_update(component_info);
+		ret = spp_port_ability_update(component_info);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, APP, "Flush error of port ability. "
+					"( component = %s, type = %d)\n",
+					component_info->name,
+					component_info->type);
+			return SPP_RET_NG;
+		}
 
 #ifdef SPP_VF_MODULE
 		if (component_info->type == SPP_COMPONENT_CLASSIFIER_MAC)
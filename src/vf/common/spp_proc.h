@@ -44,7 +44,7 @@
 #define SPP_NAME_STR_LEN  128
 
 /** Maximum number of port abilities available */
-#define SPP_PORT_ABILITY_MAX 4
+#define SPP_PORT_ABILITY_MAX 8
 
 /** Number of VLAN ID */
 #define SPP_NUM_VLAN_VID 4096
@@ -52,6 +52,15 @@
 /** Maximum VLAN PCP */
 #define SPP_VLAN_PCP_MAX 7
 
+/** Maximum number of mirror filters per component */
+#define SPP_MIRROR_FILTER_MAX 8
+
+/** Maximum number of mirror destinations other than original per component */
+#define SPP_MIRROR_DEST_MAX 8
+
+/** Maximum length of truncated packets of mirror */
+#define SPP_MIRROR_SNAPLEN_MAX 2048
+
 /* Max number of core status check */
 #define SPP_CORE_STATUS_CHECK_MAX 5
 
@@ -120,13 +129,61 @@ enum spp_port_rxtx {
 };
 
 /**
- * Port ability operation which indicates vlan tag operation on the port
+ * Port ability operation which indicates header operation on the port
  * (e.g. add vlan tag or delete vlan tag)
  */
 enum spp_port_ability_ope {
 	SPP_PORT_ABILITY_OPE_NONE,	  /**< none */
 	SPP_PORT_ABILITY_OPE_ADD_VLANTAG, /**< add VLAN tag */
 	SPP_PORT_ABILITY_OPE_DEL_VLANTAG, /**< delete VLAN tag */
+	SPP_PORT_ABILITY_OPE_ADD_QINQ,    /**< add outer VLAN tag (QinQ) */
+	SPP_PORT_ABILITY_OPE_DEL_QINQ,    /**< delete outer VLAN tag (QinQ) */
+	SPP_PORT_ABILITY_OPE_SET_SRC_MAC, /**< rewrite source MAC address */
+	SPP_PORT_ABILITY_OPE_SET_DST_MAC, /**< rewrite dest MAC address */
+	SPP_PORT_ABILITY_OPE_DEC_TTL,     /**< decrement TTL or hop limit */
+	SPP_PORT_ABILITY_OPE_SET_DSCP,    /**< remark DSCP */
+	SPP_PORT_ABILITY_OPE_POLICE_SRTCM, /**< police with srTCM */
+	SPP_PORT_ABILITY_OPE_POLICE_TRTCM, /**< police with trTCM */
+	SPP_PORT_ABILITY_OPE_POLICE_TB,   /**< police with token bucket */
+	SPP_PORT_ABILITY_OPE_SAMPLE,      /**< send sampled packets to ring */
+};
+
+/** Number of port abilities limiting rate */
+#define SPP_PORT_ABILITY_METER_NUM \
+	(SPP_PORT_ABILITY_OPE_POLICE_TB - SPP_PORT_ABILITY_OPE_POLICE_SRTCM + 1)
+
+/** Check if port ability limits rate */
+#define SPP_PORT_ABILITY_IS_METER(ope) \
+	((ope) >= SPP_PORT_ABILITY_OPE_POLICE_SRTCM && \
+	 (ope) <= SPP_PORT_ABILITY_OPE_POLICE_TB)
+
+/** Mode of sampling packets */
+enum spp_sample_mode {
+	SPP_SAMPLE_MODE_EVERY,  /**< every Nth packet */
+	SPP_SAMPLE_MODE_RANDOM, /**< each packet with probability of 1/N */
+};
+
+/** Copy mode of packets mirrored by component */
+enum spp_mirror_copy_mode {
+	SPP_MIRROR_COPY_SHALLOW, /**< share data with rte_pktmbuf_clone() */
+	SPP_MIRROR_COPY_DEEP,    /**< copy data into new mbufs */
+};
+
+/** Type of packet field matched by mirror filter */
+enum spp_mirror_filter_type {
+	SPP_MIRROR_FILTER_NONE,       /**< none */
+	SPP_MIRROR_FILTER_MAC,        /**< source or dest MAC address */
+	SPP_MIRROR_FILTER_VLAN,       /**< VLAN ID of outermost tag */
+	SPP_MIRROR_FILTER_ETHER_TYPE, /**< EtherType inside VLAN tags */
+	SPP_MIRROR_FILTER_IP,         /**< source or dest IP prefix */
+	SPP_MIRROR_FILTER_L4_PORT,    /**< source or dest TCP/UDP port */
+	SPP_MIRROR_FILTER_BPF,        /**< eBPF program in ELF file */
+};
+
+/** Unit of rate of token bucket */
+enum spp_meter_unit {
+	SPP_METER_UNIT_PPS, /**< packets per second */
+	SPP_METER_UNIT_BPS, /**< bits per second */
 };
 
 /* getopt_long return value for long option */
@@ -170,13 +227,65 @@ struct spp_vlantag_info {
 	int tci; /**< Tag Control Information */
 };
 
+/** MAC address information */
+struct spp_mac_info {
+	uint64_t addr;                     /**< MAC address (binary) */
+	char     addr_str[SPP_MIN_STR_LEN]; /**< MAC address (text) */
+};
+
+/** DSCP information */
+struct spp_dscp_info {
+	int dscp; /**< Differentiated Services Code Point */
+};
+
+/**
+ * Rate limit information
+ *
+ * Rates of srTCM and trTCM are in bytes per second and burst sizes are in
+ * bytes. Token bucket policer uses only `cir` as its rate and `cbs` as its
+ * burst size in the unit of `unit`, in which burst size of bps is in bytes.
+ */
+struct spp_meter_info {
+	enum spp_meter_unit unit; /**< Unit of rate of token bucket */
+	uint64_t cir;             /**< Committed information rate */
+	uint64_t pir;             /**< Peak information rate */
+	uint64_t cbs;             /**< Committed burst size */
+	uint64_t ebs;             /**< Excess burst size */
+	uint64_t pbs;             /**< Peak burst size */
+};
+
+/**
+ * Sampling information
+ *
+ * A copy of first `snaplen` bytes of sampled packet is sent to the ring,
+ * or the whole packet is copied if `snaplen` is zero.
+ */
+struct spp_sample_info {
+	struct spp_port_index ring; /**< Ring to send sampled packets */
+	enum spp_sample_mode mode;  /**< Mode of sampling */
+	uint32_t rate;              /**< One packet is sampled in `rate` */
+	uint32_t snaplen;           /**< Length of copy, or 0 for all */
+};
+
 /**
- * Data for each port ability which indicates vlantag related information
+ * Data for each port ability which indicates header related information
  * for the port
  */
 union spp_ability_data {
-	/** VLAN tag information */
+	/** VLAN tag information, also used for outer tag of QinQ */
 	struct spp_vlantag_info vlantag;
+
+	/** MAC address information */
+	struct spp_mac_info mac;
+
+	/** DSCP information */
+	struct spp_dscp_info dscp;
+
+	/** Rate limit information */
+	struct spp_meter_info meter;
+
+	/** Sampling information */
+	struct spp_sample_info sample;
 };
 
 /** Port ability information */
@@ -193,6 +302,32 @@ struct spp_port_class_identifier {
 	struct spp_vlantag_info vlantag;        /**< VLAN tag information */
 };
 
+/** IP prefix information, address is masked and in network byte order */
+struct spp_ip_prefix_info {
+	int family;       /**< AF_INET or AF_INET6 */
+	int prefix_len;   /**< Length of prefix in bits */
+	uint8_t addr[16]; /**< Address, only first 4 bytes used for IPv4 */
+};
+
+/**
+ * Mirror filter information
+ *
+ * Packets are mirrored only if they match any of filters of component,
+ * or all of packets are mirrored if component has no filter.
+ */
+struct spp_mirror_filter {
+	enum spp_mirror_filter_type type; /**< Type of filter */
+	union {
+		uint64_t mac;            /**< MAC address (binary) */
+		int vid;                 /**< VLAN ID */
+		uint16_t ether_type;     /**< EtherType */
+		struct spp_ip_prefix_info ip; /**< IP prefix */
+		uint16_t l4_port;        /**< TCP or UDP port */
+		char bpf_file[SPP_NAME_STR_LEN];
+					 /**< Path of eBPF ELF file */
+	} data;                           /**< Value to be matched */
+};
+
 /* Port info */
 struct spp_port_info {
 	enum port_type iface_type;      /**< Interface type (phy/vhost/ring) */
@@ -216,6 +351,13 @@ struct spp_component_info {
 					/**< Array of pointers to rx ports */
 	struct spp_port_info *tx_ports[RTE_MAX_ETHPORTS];
 					/**< Array of pointers to tx ports */
+	int num_filter;			/**< The number of mirror filters */
+	struct spp_mirror_filter filter[SPP_MIRROR_FILTER_MAX];
+					/**< Array of mirror filters */
+	uint32_t snaplen;		/**< Length of mirrored packets,
+					     or 0 for whole of packets */
+	enum spp_mirror_copy_mode copy_mode;
+					/**< Copy mode of mirror */
 };
 
 /* Manage given options as global variable */
@@ -515,6 +657,26 @@ struct core_info *get_core_info(unsigned int lcore_id);
  */
 int spp_check_core_update(unsigned int lcore_id);
 
+/**
+ * Check if ring is a destination of sampling port ability.
+ *
+ * Rings of SPP are single producer, so a ring can be the destination of
+ * only one sampling ability. Sampling of `port` in `rxtx` direction is
+ * not counted, because it is replaced by the new one.
+ *
+ * @param ring_no
+ *  Interface number of the ring.
+ * @param port
+ *  Port to which the new sampling ability is added.
+ * @param rxtx
+ *  Direction of the new sampling ability.
+ *
+ * @retval SPP_RET_OK the ring is used by another sampling ability.
+ * @retval SPP_RET_NG the ring is not used.
+ */
+int spp_check_sample_ring(int ring_no, const struct spp_port_index *port,
+		enum spp_port_rxtx rxtx);
+
 /**
  * Check if component is using port.
  *
@@ -629,6 +791,13 @@ int flush_port(void);
  */
 void flush_core(void);
 
+/**
+ *  Release components moved to another core from the source cores.
+ *  It must be called before flush_core() so that moved component is
+ *  not run on two cores at once.
+ */
+void flush_moved_component(void);
+
 /**
  *  Flush change for forwarder or classifier_mac.
  *
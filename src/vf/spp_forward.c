@@ -118,13 +118,8 @@ static inline void
 change_forward_index(int id)
 {
 	struct forward_info *info = &g_forward_info[id];
-	if (info->ref_index == info->upd_index) {
-		/* Change reference index of port ability. */
-		spp_port_ability_change_index(PORT_ABILITY_CHG_INDEX_REF,
-									0, 0);
-
+	if (info->ref_index == info->upd_index)
 		info->ref_index = (info->upd_index+1)%SPP_INFO_AREA_MAX;
-	}
 }
 /**
  * Forwarding packets as forwarder or merger
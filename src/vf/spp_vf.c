@@ -196,9 +196,12 @@ slave_main(void *arg __attribute__ ((unused)))
 
 	RTE_LOG(INFO, APP, "Core[%d] Start.\n", lcore_id);
 	set_core_status(lcore_id, SPP_CORE_IDLE);
+	spp_port_ability_register_lcore(lcore_id);
 
 	while ((status = spp_get_core_status(lcore_id)) !=
 			SPP_CORE_STOP_REQUEST) {
+		/* No port ability table is referred from here. */
+		spp_port_ability_quiescent(lcore_id);
 		if (status != SPP_CORE_FORWARD)
 			continue;
 
@@ -233,6 +236,7 @@ slave_main(void *arg __attribute__ ((unused)))
 		}
 	}
 
+	spp_port_ability_unregister_lcore(lcore_id);
 	set_core_status(lcore_id, SPP_CORE_STOP);
 	RTE_LOG(INFO, APP, "Core[%d] End.\n", lcore_id);
 	return ret;
@@ -299,7 +303,9 @@ main(int argc, char *argv[])
 			break;
 
 		spp_forward_init();
-		spp_port_ability_init();
+		int ret_ability_init = spp_port_ability_init();
+		if (unlikely(ret_ability_init != SPP_RET_OK))
+			break;
 
 		/* Setup connection for accepting commands from controller */
 		int ret_command_init = spp_command_proc_init(
@@ -0,0 +1,251 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+"""Extract packets in a range of time from capture file of spp_pcap.
+
+It refers to index file written by spp_pcap launched with '--index' and
+decompresses only chunks including the range. Compressed chunks are
+decompressed with 'lz4' or 'zstd' command.
+"""
+
+from __future__ import print_function
+import argparse
+import datetime
+import os
+import struct
+import subprocess
+import sys
+import time
+
+INDEX_MAGIC = 0x58444950
+INDEX_VERSION = 1
+INDEX_F_IDB = 0x1
+
+# Structs of index, which are the same as spp_pcap.c
+INDEX_HEADER = struct.Struct('<IHBBII')
+INDEX_ENTRY = struct.Struct('<QQQQII')
+
+FORMATS = ['pcap', 'pcapng']
+
+# Commands for decompression for each of codecs, or None if not compressed
+DECOMP_CMDS = [None, ['lz4', '-dc'], ['zstd', '-dcq']]
+
+PCAP_RECORD_HEADER = struct.Struct('<IIII')
+PCAPNG_BLOCK_HEADER = struct.Struct('<II')
+PCAPNG_EPB_TIME = struct.Struct('<II')
+PCAPNG_BLOCK_IDB = 0x00000001
+PCAPNG_BLOCK_EPB = 0x00000006
+
+NS_PER_S = 1000000000
+
+TIME_FORMATS = ['%Y-%m-%d %H:%M:%S.%f', '%Y-%m-%d %H:%M:%S',
+                '%Y%m%d%H%M%S']
+
+
+def read_index(path):
+    """Return header and a list of entries of index file as a tuple."""
+
+    with open(path, 'rb') as fd:
+        data = fd.read()
+
+    if len(data) < INDEX_HEADER.size:
+        raise ValueError('Too short index file "{}"'.format(path))
+    magic, version, fmt, codec, snaplen, _ = INDEX_HEADER.unpack_from(data)
+    if magic != INDEX_MAGIC or version != INDEX_VERSION:
+        raise ValueError('Invalid index file "{}"'.format(path))
+    if fmt >= len(FORMATS) or codec >= len(DECOMP_CMDS):
+        raise ValueError('Unknown format or codec in "{}"'.format(path))
+
+    header = {'format': FORMATS[fmt], 'codec': codec, 'snaplen': snaplen}
+    entries = []
+    for pos in range(INDEX_HEADER.size,
+                     len(data) - INDEX_ENTRY.size + 1, INDEX_ENTRY.size):
+        offset, length, first_ns, last_ns, packets, flags = \
+            INDEX_ENTRY.unpack_from(data, pos)
+        entries.append({'offset': offset, 'length': length,
+                        'first_ns': first_ns, 'last_ns': last_ns,
+                        'packets': packets, 'flags': flags})
+    return header, entries
+
+
+def decompress(data, codec):
+    """Decompress frames of codec with external command."""
+
+    if DECOMP_CMDS[codec] is None:
+        return data
+
+    proc = subprocess.Popen(DECOMP_CMDS[codec], stdin=subprocess.PIPE,
+                            stdout=subprocess.PIPE)
+    out, _ = proc.communicate(data)
+    if proc.returncode != 0:
+        raise RuntimeError('Failed to decompress with "{}"'.format(
+            ' '.join(DECOMP_CMDS[codec])))
+    return out
+
+
+def read_chunk(fd, offset, length, codec):
+    """Read a chunk of capture file and return decompressed data."""
+
+    fd.seek(offset)
+    return decompress(fd.read(length), codec)
+
+
+def pcap_records(data):
+    """Iterate timestamp in nsec and bytes of each of pcap records."""
+
+    pos = 0
+    while pos + PCAP_RECORD_HEADER.size <= len(data):
+        ts_sec, ts_nsec, caplen, _ = PCAP_RECORD_HEADER.unpack_from(
+            data, pos)
+        end = pos + PCAP_RECORD_HEADER.size + caplen
+        yield ts_sec * NS_PER_S + ts_nsec, data[pos:end]
+        pos = end
+
+
+def pcapng_blocks(data):
+    """Iterate type, timestamp in nsec of EPB or None and bytes of blocks."""
+
+    pos = 0
+    while pos + PCAPNG_BLOCK_HEADER.size <= len(data):
+        btype, blen = PCAPNG_BLOCK_HEADER.unpack_from(data, pos)
+        if blen < PCAPNG_BLOCK_HEADER.size:
+            break
+        time_ns = None
+        if btype == PCAPNG_BLOCK_EPB:
+            # resolution of timestamp is nsec in spp_pcap
+            ts_high, ts_low = PCAPNG_EPB_TIME.unpack_from(data, pos + 12)
+            time_ns = (ts_high << 32) | ts_low
+        yield btype, time_ns, data[pos:pos + blen]
+        pos += blen
+
+
+def extract(path, out, start_ns=0, end_ns=None):
+    """Write packets from start_ns to end_ns in capture file to out.
+
+    Output is in the same format as capture file, and not compressed.
+    Return the number of packets written.
+    """
+
+    header, entries = read_index(path + '.idx')
+    codec = header['codec']
+    if end_ns is None:
+        end_ns = (1 << 64) - 1
+
+    selected = [i for i, ent in enumerate(entries)
+                if ent['last_ns'] >= start_ns and ent['first_ns'] <= end_ns]
+    written = 0
+
+    with open(path, 'rb') as fd:
+        # file header is in the frame before the first chunk
+        if entries:
+            header_len = entries[0]['offset']
+        else:
+            header_len = os.path.getsize(path)
+        out.write(read_chunk(fd, 0, header_len, codec))
+        if not selected:
+            return written
+
+        # interfaces of pcapng are described before the first packet
+        if header['format'] == 'pcapng':
+            for ent in entries[:selected[-1] + 1]:
+                if not ent['flags'] & INDEX_F_IDB:
+                    continue
+                data = read_chunk(fd, ent['offset'], ent['length'], codec)
+                for btype, _, block in pcapng_blocks(data):
+                    if btype == PCAPNG_BLOCK_IDB:
+                        out.write(block)
+
+        for i in selected:
+            data = read_chunk(fd, entries[i]['offset'],
+                              entries[i]['length'], codec)
+            if header['format'] == 'pcapng':
+                records = [(t, b) for btype, t, b in pcapng_blocks(data)
+                           if btype == PCAPNG_BLOCK_EPB]
+            else:
+                records = pcap_records(data)
+            for time_ns, record in records:
+                if start_ns <= time_ns <= end_ns:
+                    out.write(record)
+                    written += 1
+
+    return written
+
+
+def parse_time(time_str):
+    """Return nsec from UNIX time in sec or local time such as
+    '2019-02-14 16:15:50.5'.
+    """
+
+    try:
+        return int(float(time_str) * NS_PER_S)
+    except ValueError:
+        pass
+
+    for fmt in TIME_FORMATS:
+        try:
+            dt = datetime.datetime.strptime(time_str, fmt)
+        except ValueError:
+            continue
+        return (int(time.mktime(dt.timetuple())) * NS_PER_S +
+                dt.microsecond * 1000)
+    raise argparse.ArgumentTypeError('Invalid time "{}"'.format(time_str))
+
+
+def format_time(time_ns):
+    dt = datetime.datetime.fromtimestamp(time_ns // NS_PER_S)
+    return '{}.{:09d}'.format(dt.strftime('%Y-%m-%d %H:%M:%S'),
+                              time_ns % NS_PER_S)
+
+
+def print_index(path):
+    header, entries = read_index(path + '.idx')
+    print('format: {}, codec: {}, snaplen: {}'.format(
+        header['format'],
+        DECOMP_CMDS[header['codec']][0] if header['codec'] else 'none',
+        header['snaplen']))
+    for ent in entries:
+        print('offset {:>12} length {:>10} packets {:>8} {} - {}'.format(
+            ent['offset'], ent['length'], ent['packets'],
+            format_time(ent['first_ns']), format_time(ent['last_ns'])))
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Extract packets from capture file of spp_pcap")
+
+    parser.add_argument(
+            "file", type=str,
+            help="Capture file with index of '.idx'")
+    parser.add_argument(
+            "-s", "--start", type=parse_time, default=0,
+            help="Start time in UNIX time or 'YYYY-mm-dd HH:MM:SS[.f]'")
+    parser.add_argument(
+            "-e", "--end", type=parse_time, default=None,
+            help="End time in UNIX time or 'YYYY-mm-dd HH:MM:SS[.f]'")
+    parser.add_argument(
+            "-o", "--output", type=str, default=None,
+            help="Output file, or stdout if omitted")
+    parser.add_argument(
+            "-l", "--list", action="store_true",
+            help="Print chunks of index instead of extracting")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+
+    if args.list is True:
+        print_index(args.file)
+        return
+
+    if args.output is None:
+        out = getattr(sys.stdout, 'buffer', sys.stdout)
+        extract(args.file, out, args.start, args.end)
+    else:
+        with open(args.output, 'wb') as out:
+            num = extract(args.file, out, args.start, args.end)
+        print('Extracted {} packets to {}'.format(num, args.output))
+
+
+if __name__ == '__main__':
+    main()